@@ -35,6 +35,13 @@
 #define CC_MINCUT_BIGDOUBLE   (1e30)
 #define CC_MINCUT_ONE_EPSILON (0.000001)
 
+#define CC_FLOW_HIGHEST_LABEL 0    /* push-relabel, highest label first  */
+#define CC_FLOW_FIFO          1    /* push-relabel, oldest active first  */
+#define CC_FLOW_PSEUDOFLOW    2    /* Hochbaum's pseudoflow              */
+#define CC_FLOW_BK            3    /* Boykov-Kolmogorov                  */
+
+typedef struct CCcut_flowctx CCcut_flowctx;
+
 
 int
     CCcut_mincut (int ncount, int ecount, int *elist, double *dlen,
@@ -49,7 +56,18 @@ int
         double *dlen, int scount, int *slist, double *cutval, int **cut,
         int *cutcount, int quickshrink, CCrandstate *rstate),
     CCcut_mincut_st (int ncount, int ecount, int *elist, double *ecap,
-        int s, int t, double *value, int **cut, int *cutcount),
+        int s, int t, double *value, int **cut, int *cutcount,
+        int flowalg),
+    CCcut_flowctx_create (CCcut_flowctx **F, int ncount, int ecount,
+        int *elist, double *ecap),
+    CCcut_flowctx_load (CCcut_flowctx *F, int ncount, int ecount,
+        int *elist, double *ecap),
+    CCcut_flowctx_solve (CCcut_flowctx *F, int s, int t, double *value,
+        int *cut, int *cutcount),
+    CCcut_flowctx_algorithm (CCcut_flowctx *F, int flowalg),
+    CCcut_flowctx_setcap (CCcut_flowctx *F, int e, double cap),
+    CCcut_scale_capacities (int ecount, double *ecap, double *icap,
+        int bits, double *scale),
     CCcut_linsub (int ncount, int ecount, int *endmark, int *elist, double *x,
         double maxval, void *u_data, int (*cut_callback) (double cut_val,
         int cut_start, int cut_end, void *u_data)),
@@ -60,6 +78,12 @@ int
     CCcut_connect_components (int ncount, int ecount, int *elist, double *x,
         int *ncomp, int **compscount, int **comps);
 
+void
+    CCcut_flowctx_warmstart (CCcut_flowctx *F, int on),
+    CCcut_flowctx_counts (CCcut_flowctx *F, long *pushes, long *relabels,
+        int *warm),
+    CCcut_flowctx_destroy (CCcut_flowctx **F);
+
 
 
 /****************************************************************************/
@@ -68,37 +92,58 @@ int
 /*                                                                          */
 /****************************************************************************/
 
-typedef struct CC_GHnode {
-    struct CC_GHnode *parent;
-    struct CC_GHnode *sibling;
-    struct CC_GHnode *child;
-    double            cutval;
-    int               ndescendants;
-    int               special;
-    int              *nlist;
-    int               listcount;
-    int               num;
-} CC_GHnode;
-
 typedef struct CC_GHtree {
-    struct CC_GHnode *root;
-    struct CC_GHnode *supply;
-    int              *listspace;
+    int     tcount;
+    int     ncount;
+    int    *parent;
+    int    *ndescendants;
+    int    *special;
+    int    *nodebeg;
+    int    *nodes;
+    double *cutval;
 } CC_GHtree;
 
 
 
 int
     CCcut_gomory_hu (CC_GHtree *T, int ncount, int ecount, int *elist,
-        double *ecap, int markcount, int *marks, CCrandstate *rstate);
+        double *ecap, int markcount, int *marks, CCrandstate *rstate,
+        int flowalg),
+    CCcut_gusfield_gomory_hu (CC_GHtree *T, int ncount, int ecount,
+        int *elist, double *ecap, int markcount, int *marks, int flowalg),
+    CCcut_gomory_hu_threaded (CC_GHtree *T, int ncount, int ecount,
+        int *elist, double *ecap, int markcount, int *marks,
+        CCrandstate *rstate, int nthreads, int flowalg),
+    CCcut_gomory_hu_update (CC_GHtree *T, int ncount, int ecount,
+        int *elist, double *ecap, int markcount, int *marks, int chcount,
+        int *chlist, double *oldcap, CCrandstate *rstate, int flowalg,
+        int *flowcount),
+    CCcut_GHtreewrite (CC_SFILE *f, CC_GHtree *T),
+    CCcut_GHtreeread (CC_SFILE *f, CC_GHtree *T);
 
 void
     CCcut_GHtreeinit (CC_GHtree *T),
     CCcut_GHtreefree (CC_GHtree *T),
+    CCcut_GHtreeunscale (CC_GHtree *T, double scale),
     CCcut_GHtreeprint (CC_GHtree *T);
 
 
 
+/****************************************************************************/
+/*                                                                          */
+/*                             oddcut.c                                     */
+/*                                                                          */
+/****************************************************************************/
+
+
+int
+    CCcut_odd_cuts (int ncount, int ecount, int *elist, double *ecap,
+        int tcount, int *tlist, double cutoff, int flowalg,
+        int (*doit_fn) (double, int, int *, void *), void *pass_param,
+        int *flowcount);
+
+
+
 
 /****************************************************************************/
 /*                                                                          */
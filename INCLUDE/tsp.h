@@ -575,6 +575,29 @@ int
 /*                                                                          */
 /****************************************************************************/
 
+#define CCtsp_BLOSSOM_PADBERG_RAO 0
+#define CCtsp_BLOSSOM_LRT         1
+
+#define CCtsp_BLOSSOM_GH_SHRINK   0
+#define CCtsp_BLOSSOM_GH_GUSFIELD 1
+#define CCtsp_BLOSSOM_GH_THREADED 2
+#define CCtsp_BLOSSOM_GH_ODDCUT   3
+
+typedef struct CCtsp_blossomparams {
+    int    engine;     /* CCtsp_BLOSSOM_PADBERG_RAO or CCtsp_BLOSSOM_LRT */
+    int    nthreads;   /* 0 ==> sequential code */
+    int    ghtree;     /* CCtsp_BLOSSOM_GH_SHRINK, _GUSFIELD, _THREADED or
+                          _ODDCUT */
+    int    flowalg;    /* CC_FLOW_HIGHEST_LABEL, _FIFO, _PSEUDOFLOW or _BK */
+    int    capbits;    /* 0 ==> double capacities, 32 or 64 ==> integers */
+} CCtsp_blossomparams;
+
+typedef struct CCtsp_blossom_workspace {
+    struct CCtsp_blospace *space;   /* buffers, grown as needed */
+    int    maxcuts;    /* keep only the maxcuts most violated; 0 ==> all */
+    double minviol;    /* drop cuts violated by less than minviol */
+} CCtsp_blossom_workspace;
+
 
 int
     CCtsp_fastblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
@@ -582,7 +605,43 @@ int
     CCtsp_ghfastblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
         int ecount, int *elist, double *x),
     CCtsp_exactblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
-        int ecount, int *elist, double *x, CCrandstate *rstate);
+        int ecount, int *elist, double *x, CCrandstate *rstate),
+    CCtsp_exactblossom_threaded (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x, CCrandstate *rstate,
+        int nthreads),
+    CCtsp_exactblossom_params (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x, CCrandstate *rstate,
+        CCtsp_blossomparams *params),
+    CCtsp_exactblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x, CCrandstate *rstate,
+        CCtsp_blossomparams *params, CCtsp_blossom_workspace *w),
+    CCtsp_exactblossom_update (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x, int chcount,
+        int *chlist, CCrandstate *rstate, CCtsp_blossomparams *params,
+        CCtsp_blossom_workspace *w),
+    CCtsp_fastblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x,
+        CCtsp_blossom_workspace *w),
+    CCtsp_ghfastblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x,
+        CCtsp_blossom_workspace *w),
+    CCtsp_heurblossom (CCtsp_lpcut_in **fastcuts, int *fastcount,
+        CCtsp_lpcut_in **ghcuts, int *ghcount, int ncount, int ecount,
+        int *elist, double *x, int epscount, double *eps),
+    CCtsp_heurblossom_work (CCtsp_lpcut_in **fastcuts, int *fastcount,
+        CCtsp_lpcut_in **ghcuts, int *ghcount, int ncount, int ecount,
+        int *elist, double *x, int epscount, double *eps,
+        CCtsp_blossom_workspace *w),
+    CCtsp_sweepblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
+        int ecount, int *elist, double *x),
+    CCtsp_sweepblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x,
+        CCtsp_blossom_workspace *w);
+
+void
+    CCtsp_init_blossomparams (CCtsp_blossomparams *p),
+    CCtsp_init_blossom_workspace (CCtsp_blossom_workspace *w),
+    CCtsp_free_blossom_workspace (CCtsp_blossom_workspace *w);
 
 
 
@@ -851,6 +910,20 @@ void
 #define CCtsp_POOL_SAVECUTS    'S'
 #define CCtsp_POOL_EXIT        'X'
 
+/* The support graph of an x-vector, for pricing cliques: the edges at */
+/* node i are adjto/adjx[adjbeg[i]] to [adjbeg[i+1]-1].                */
+
+typedef struct CCtsp_pricegraph {
+    int     ncount;
+    int     marker;
+    int     nspace;
+    int     aspace;
+    int    *adjbeg;
+    int    *adjto;
+    double *adjx;
+    int    *mark;
+} CCtsp_pricegraph;
+
 
 int
     CCtsp_init_cutpool (int *ncount, char *poolfilename, CCtsp_lpcuts **pool),
@@ -899,6 +972,11 @@ int
         double *x, double *cutval),
     CCtsp_price_cuts_threaded (CCtsp_lpcuts *pool, int ncount, int ecount,
         int *elist, double *x, double *cutval, int numthreads),
+    CCtsp_build_pricegraph (CCtsp_pricegraph *G, int ncount, int ecount,
+        int *elist, double *x),
+    CCtsp_cut_violations (CCtsp_lpcut_in *cuts, int ncount, int ecount,
+        int *elist, double *x, int nthreads, int *p_cutcount,
+        double **p_viol, double **p_lhs),
     CCtsp_register_cliques (CCtsp_lpcuts *cuts, CCtsp_lpcut_in *c,
         CCtsp_lpcut *new),
     CCtsp_register_dominos (CCtsp_lpcuts *cuts, CCtsp_lpcut_in *c,
@@ -906,6 +984,8 @@ int
     CCtsp_add_cut_to_cutlist (CCtsp_lpcuts *cuts, CCtsp_lpcut *c);
 
 void
+    CCtsp_init_pricegraph (CCtsp_pricegraph *G),
+    CCtsp_free_pricegraph (CCtsp_pricegraph *G),
     CCtsp_free_cutpool (CCtsp_lpcuts **pool),
     CCtsp_free_lpcut_in (CCtsp_lpcut_in *c),
     CCtsp_free_lpclique (CCtsp_lpclique *c),
@@ -914,6 +994,11 @@ void
     CCtsp_unregister_dominos (CCtsp_lpcuts *cuts, CCtsp_lpcut *c),
     CCtsp_delete_cut_from_cutlist (CCtsp_lpcuts *cuts, int ind);
 
+double
+    CCtsp_pricegraph_delta (CCtsp_pricegraph *G, CCtsp_lpclique *c),
+    CCtsp_cut_violation (CCtsp_pricegraph *G, CCtsp_lpcut_in *c,
+        double *lhs);
+
 
 /****************************************************************************/
 /*                                                                          */
@@ -957,6 +1042,23 @@ void
     CCtsp_free_bigdual (CCtsp_bigdual **d);
 
 
+/****************************************************************************/
+/*                                                                          */
+/*                             fracgen.c                                    */
+/*                                                                          */
+/****************************************************************************/
+
+#define CCtsp_FRACGEN_GEOMETRIC 0   /* a tour and its local 2-opt moves      */
+#define CCtsp_FRACGEN_BLOSSOMS  1   /* a tour with planted violated blossoms */
+#define CCtsp_FRACGEN_PATHS     2   /* a tour and long swapped stretches     */
+
+
+int
+    CCtsp_fractional_solution (int family, int ncount, double rate, int k,
+        CCrandstate *rstate, int *ecount, int **elist, double **x);
+
+
+
 /****************************************************************************/
 /*                                                                          */
 /*                             generate.c                                   */
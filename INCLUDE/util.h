@@ -1042,6 +1042,34 @@ void
 
 
 
+/****************************************************************************/
+/*                                                                          */
+/*                             xvector.c                                    */
+/*                                                                          */
+/****************************************************************************/
+
+typedef struct CCutil_xvector {
+    int     ncount;
+    int     ecount;
+    int    *elist;
+    double *x;
+    void   *map;      /* the file, if elist and x point into it */
+    size_t  maplen;
+} CCutil_xvector;
+
+
+int
+    CCutil_read_xvector (const char *fname, CCutil_xvector *X),
+    CCutil_write_xvector_binary (const char *fname, int ncount, int ecount,
+        int *elist, double *x);
+
+void
+    CCutil_init_xvector (CCutil_xvector *X),
+    CCutil_free_xvector (CCutil_xvector *X);
+
+
+
+
 /****************************************************************************/
 /*                                                                          */
 /*                             zeit.c                                       */
@@ -0,0 +1,777 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "machdefs.h"
+#include "util.h"
+#include "tsp.h"
+#include "macrorus.h"
+
+// Function Prototypes
+int run_engine(int engine, int ghtree, int flowalg, int nthreads, int maxcuts, double minviol, int ncount, int ecount, int *elist, double *x, int seed, double *seconds);
+int run_flowalgs(int engine, int ghtree, int nthreads, int maxcuts, double minviol, int ncount, int ecount, int *elist, double *x, int seed);
+int run_rounds(int engine, int ghtree, int flowalg, int nthreads, int rounds, int ncount, int ecount, int *elist, double *x, int seed);
+void free_cuts(CCtsp_lpcut_in **cuts);
+int count_violated(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *elist, double *x, int nthreads, double *maxviol);
+double max_blossom_violation(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *elist, double *x);
+int check_engines(void);
+int check_odd_terminals(void);
+int check_cut_weights(void);
+int check_paths(int ncount);
+int run_paths(int ncount);
+int run_path_separator(const char *name, int sep, int ncount);
+void generate_strip_solution(int ncount, int *ecount, int **elist, double **x);
+double check_maxviol(int engine, int ghtree, int flowalg, int capbits, int ncount, int ecount, int *elist, double *x);
+void generate_complete_solution(int ncount, int *ecount, int **elist, double **x);
+void generate_sparse_solution(int ncount, int *ecount, int **elist, double **x);
+void generate_family_solution(int family, int ncount, int seed, int *ecount, int **elist, double **x);
+void usage(char *name);
+const char *flow_name(int flowalg);
+
+
+
+
+/*********************************main function for executable********************************************* */
+// Runs the Padberg-Rao and the Letchford-Reinelt-Theis exact blossom engines
+// on the same fractional solution and reports time and cut counts for both.
+// maxcuts and minviol set the cut budget of the blossom workspace, and
+// ghtree picks the Gomory-Hu code (0 shrinking, 1 Gusfield, 2 threaded,
+// 3 no tree: the pruned odd-cut search),
+// and flowalg the max-flow code in the trees (0 highest-label push-relabel,
+// 1 FIFO push-relabel, 2 pseudoflow, 3 Boykov-Kolmogorov); flowalg -1 runs
+// each engine with all four and reports the fastest.  rounds > 0 then
+// perturbs x that many times and compares building the trees from scratch
+// with updating the trees of the previous round.  The updated trees give
+// other (usually fewer) cuts, so the cut counts and the largest blossom
+// violations are reported next to the times.  The perturbed x does not
+// keep x(delta(v)) = 2, so the largest violations can differ (see the
+// notes of CCtsp_exactblossom_update).
+// "check" instead of the arguments runs check_engines, and "paths [ncount]"
+// runs check_paths (the ctest targets).
+int main(int argc, char **argv) {
+    int ncount = 2000;
+    int sparse = 0;
+    int nthreads = 0;
+    int seed = 12345;
+    int maxcuts = 0;
+    double minviol = 0.0;
+    int ghtree = CCtsp_BLOSSOM_GH_SHRINK;
+    int flowalg = CC_FLOW_HIGHEST_LABEL;
+    int rounds = 0;
+    int ecount = 0;
+    int *elist = NULL;
+    double *x = NULL;
+
+    if (argc == 2 && strcmp(argv[1], "check") == 0) return check_engines();
+    if ((argc == 2 || argc == 3) && strcmp(argv[1], "paths") == 0) {
+        return check_paths(argc == 3 ? atoi(argv[2]) : 1000001);
+    }
+
+    if (argc > 1) ncount = atoi(argv[1]);
+    if (argc > 2) sparse = atoi(argv[2]);
+    if (argc > 3) nthreads = atoi(argv[3]);
+    if (argc > 4) seed = atoi(argv[4]);
+    if (argc > 5) maxcuts = atoi(argv[5]);
+    if (argc > 6) minviol = atof(argv[6]);
+    if (argc > 7) ghtree = atoi(argv[7]);
+    if (argc > 8) flowalg = atoi(argv[8]);
+    if (argc > 9) rounds = atoi(argv[9]);
+    if (argc > 10 || ncount < 6 || sparse < 0 || sparse > 2 + CCtsp_FRACGEN_PATHS || nthreads < 0 || maxcuts < 0 || rounds < 0 ||
+        (ghtree != CCtsp_BLOSSOM_GH_SHRINK && ghtree != CCtsp_BLOSSOM_GH_GUSFIELD &&
+         ghtree != CCtsp_BLOSSOM_GH_THREADED && ghtree != CCtsp_BLOSSOM_GH_ODDCUT) ||
+        flowalg < -1 || flowalg > CC_FLOW_BK) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    srand(seed);
+    if (sparse >= 2) {
+        generate_family_solution(sparse - 2, ncount, seed, &ecount, &elist, &x);
+    } else if (sparse) {
+        generate_sparse_solution(ncount, &ecount, &elist, &x);
+    } else {
+        generate_complete_solution(ncount, &ecount, &elist, &x);
+    }
+    if (!elist || !x) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(elist);
+        free(x);
+        return 1;
+    }
+
+    printf("Instance: %s, %d nodes, %d edges, %d threads, %s\n",
+           sparse == 2 + CCtsp_FRACGEN_GEOMETRIC ? "geometric 2-opt" :
+           sparse == 2 + CCtsp_FRACGEN_BLOSSOMS ? "planted blossoms" :
+           sparse == 2 + CCtsp_FRACGEN_PATHS ? "fractional paths" :
+           sparse ? "sparse blocks" : "complete graph", ncount, ecount, nthreads,
+           ghtree == CCtsp_BLOSSOM_GH_GUSFIELD ? "Gusfield Gomory-Hu trees" :
+           ghtree == CCtsp_BLOSSOM_GH_THREADED ? "threaded Gomory-Hu trees" :
+           ghtree == CCtsp_BLOSSOM_GH_ODDCUT ? "pruned odd-cut search" :
+           "shrinking Gomory-Hu trees");
+    if (maxcuts > 0 || minviol > 0.0) {
+        printf("Budget: %d cuts, violation at least %.4f\n", maxcuts, minviol);
+    }
+
+    int rval;
+    if (flowalg == -1) {
+        rval = run_flowalgs(CCtsp_BLOSSOM_PADBERG_RAO, ghtree, nthreads, maxcuts, minviol,
+                            ncount, ecount, elist, x, seed);
+        if (!rval) {
+            rval = run_flowalgs(CCtsp_BLOSSOM_LRT, ghtree, nthreads, maxcuts, minviol,
+                                ncount, ecount, elist, x, seed);
+        }
+    } else {
+        printf("Flow code: %s\n", flow_name(flowalg));
+        rval = run_engine(CCtsp_BLOSSOM_PADBERG_RAO, ghtree, flowalg, nthreads, maxcuts,
+                          minviol, ncount, ecount, elist, x, seed, NULL);
+        if (!rval) {
+            rval = run_engine(CCtsp_BLOSSOM_LRT, ghtree, flowalg, nthreads, maxcuts,
+                              minviol, ncount, ecount, elist, x, seed, NULL);
+        }
+    }
+    if (!rval && rounds > 0) {
+        rval = run_rounds(CCtsp_BLOSSOM_PADBERG_RAO, ghtree,
+                          flowalg == -1 ? CC_FLOW_HIGHEST_LABEL : flowalg,
+                          nthreads, rounds, ncount, ecount, elist, x, seed);
+        if (!rval) {
+            rval = run_rounds(CCtsp_BLOSSOM_LRT, ghtree,
+                              flowalg == -1 ? CC_FLOW_HIGHEST_LABEL : flowalg,
+                              nthreads, rounds, ncount, ecount, elist, x, seed);
+        }
+    }
+
+    free(elist);
+    free(x);
+    return rval;
+}
+/************************************************************************************************** */
+
+
+
+
+void usage(char *name) {
+    fprintf(stderr, "Usage: %s [ncount] [sparse (0-4)] [nthreads] [seed] [maxcuts] [minviol] [ghtree] [flowalg] [rounds]\n", name);
+    fprintf(stderr, "   ncount must be at least 6\n");
+    fprintf(stderr, "   sparse 0 is the complete graph, 1 disjoint blocks, and 2-4 the\n");
+    fprintf(stderr, "   geometric, planted-blossom and fractional-path LP-like supports\n");
+    fprintf(stderr, "   maxcuts 0 keeps every cut\n");
+    fprintf(stderr, "   ghtree 0 is the shrinking Gomory-Hu code, 1 is Gusfield's,\n");
+    fprintf(stderr, "   2 splits the tree across the threads, 3 searches odd cuts only\n");
+    fprintf(stderr, "   flowalg 0 is highest-label push-relabel, 1 FIFO push-relabel,\n");
+    fprintf(stderr, "   2 pseudoflow, 3 Boykov-Kolmogorov, -1 compares all four\n");
+    fprintf(stderr, "   rounds > 0 perturbs x that many times, comparing full and\n");
+    fprintf(stderr, "   incremental Gomory-Hu trees\n");
+    fprintf(stderr, "   %s check compares the engines on fixed instances\n", name);
+    fprintf(stderr, "   %s paths [ncount] runs the separators on a long fractional strip\n", name);
+}
+
+
+const char *flow_name(int flowalg) {
+    switch (flowalg) {
+    case CC_FLOW_FIFO:       return "FIFO push-relabel";
+    case CC_FLOW_PSEUDOFLOW: return "pseudoflow";
+    case CC_FLOW_BK:         return "Boykov-Kolmogorov";
+    default:                 return "highest-label push-relabel";
+    }
+}
+
+
+// Runs one engine with each of the max-flow codes and names the fastest.
+int run_flowalgs(int engine, int ghtree, int nthreads, int maxcuts, double minviol, int ncount, int ecount, int *elist, double *x, int seed) {
+    int best = -1;
+    double besttime = 0.0;
+
+    for (int flowalg = CC_FLOW_HIGHEST_LABEL; flowalg <= CC_FLOW_BK; flowalg++) {
+        double seconds;
+        printf("  %-27s ", flow_name(flowalg));
+        int rval = run_engine(engine, ghtree, flowalg, nthreads, maxcuts, minviol,
+                              ncount, ecount, elist, x, seed, &seconds);
+        if (rval) return rval;
+        if (best == -1 || seconds < besttime) {
+            best = flowalg;
+            besttime = seconds;
+        }
+    }
+    printf("Fastest flow code for %s %s (%.3f seconds)\n",
+           engine == CCtsp_BLOSSOM_LRT ? "Letchford-R-T:" : "Padberg-Rao:",
+           flow_name(best), besttime);
+    return 0;
+}
+
+
+int run_engine(int engine, int ghtree, int flowalg, int nthreads, int maxcuts, double minviol, int ncount, int ecount, int *elist, double *x, int seed, double *seconds) {
+    CCtsp_lpcut_in *cuts = NULL;
+    int cutcount = 0;
+    CCrandstate rstate;
+    CCtsp_blossomparams params;
+    CCtsp_blossom_workspace work;
+
+    CCutil_sprand(seed, &rstate);
+    CCtsp_init_blossomparams(&params);
+    params.engine = engine;
+    params.nthreads = nthreads;
+    params.ghtree = ghtree;
+    params.flowalg = flowalg;
+    CCtsp_init_blossom_workspace(&work);
+    work.maxcuts = maxcuts;
+    work.minviol = minviol;
+
+    double szeit = CCutil_real_zeit();
+    int rval = CCtsp_exactblossom_work(&cuts, &cutcount, ncount, ecount, elist, x,
+                                       &rstate, &params, &work);
+    double tzeit = CCutil_real_zeit() - szeit;
+    if (seconds) *seconds = tzeit;
+    CCtsp_free_blossom_workspace(&work);
+    if (rval) {
+        fprintf(stderr, "CCtsp_exactblossom_work failed for engine %d\n", engine);
+        return rval;
+    }
+
+    double maxviol = 0.0;
+    int violated = count_violated(cuts, ncount, ecount, elist, x, nthreads, &maxviol);
+
+    printf("%-18s %8.3f seconds  %6d cuts  %6d violated  max violation %.4f\n",
+           engine == CCtsp_BLOSSOM_LRT ? "Letchford-R-T:" : "Padberg-Rao:",
+           tzeit, cutcount, violated, maxviol);
+
+    free_cuts(&cuts);
+    return 0;
+}
+
+
+void free_cuts(CCtsp_lpcut_in **cuts) {
+    while (*cuts) {
+        CCtsp_lpcut_in *next = (*cuts)->next;
+        CCtsp_free_lpcut_in(*cuts);
+        CC_FREE(*cuts, CCtsp_lpcut_in);
+        *cuts = next;
+    }
+}
+
+
+// Moves about 2% of the fractional edges (staying fractional) in each round,
+// as between two LP solves, and runs the engine twice on every solution:
+// with CCtsp_exactblossom_work, which builds all trees again, and with
+// CCtsp_exactblossom_update, which updates the trees of the round before.
+int run_rounds(int engine, int ghtree, int flowalg, int nthreads, int rounds, int ncount, int ecount, int *elist, double *x, int seed) {
+    CCtsp_lpcut_in *cuts = NULL;
+    int fullcount = 0, updcount = 0, chcount = 0, rval = 0;
+    int fullcuts = 0, updcuts = 0, vdiff = 0;
+    double fulltime = 0.0, updtime = 0.0, fullviol, updviol;
+    CCrandstate rstate;
+    CCtsp_blossomparams params;
+    CCtsp_blossom_workspace fullwork, updwork;
+    double *y = malloc(ecount * sizeof(double));
+    int *chlist = malloc(ecount * sizeof(int));
+
+    CCtsp_init_blossom_workspace(&fullwork);
+    CCtsp_init_blossom_workspace(&updwork);
+    if (!y || !chlist) {
+        fprintf(stderr, "Memory allocation failed\n");
+        rval = 1; goto CLEANUP;
+    }
+    CCtsp_init_blossomparams(&params);
+    params.engine = engine;
+    params.nthreads = nthreads;
+    params.ghtree = ghtree;
+    params.flowalg = flowalg;
+    for (int i = 0; i < ecount; i++) y[i] = x[i];
+
+    printf("%s %d rounds, full trees against updated trees\n",
+           engine == CCtsp_BLOSSOM_LRT ? "Letchford-R-T:" : "Padberg-Rao:", rounds);
+    for (int r = 0; r <= rounds; r++) {
+        if (r > 0) {
+            chcount = 0;
+            for (int i = 0; i < ecount; i++) {
+                if (y[i] > 0.05 && y[i] < 0.95 && rand() % 50 == 0) {
+                    y[i] += ((double)rand() / RAND_MAX - 0.5) * 0.1;
+                    if (y[i] < 0.05) y[i] = 0.05;
+                    if (y[i] > 0.95) y[i] = 0.95;
+                    chlist[chcount++] = i;
+                }
+            }
+        }
+
+        CCutil_sprand(seed, &rstate);
+        double szeit = CCutil_real_zeit();
+        rval = CCtsp_exactblossom_work(&cuts, &fullcount, ncount, ecount, elist, y,
+                                       &rstate, &params, &fullwork);
+        double ftime = CCutil_real_zeit() - szeit;
+        fullviol = max_blossom_violation(cuts, ncount, ecount, elist, y);
+        free_cuts(&cuts);
+        if (rval) {
+            fprintf(stderr, "CCtsp_exactblossom_work failed\n");
+            goto CLEANUP;
+        }
+
+        CCutil_sprand(seed, &rstate);
+        szeit = CCutil_real_zeit();
+        rval = CCtsp_exactblossom_update(&cuts, &updcount, ncount, ecount, elist, y,
+                                         r > 0 ? chcount : -1, chlist, &rstate,
+                                         &params, &updwork);
+        double utime = CCutil_real_zeit() - szeit;
+        updviol = max_blossom_violation(cuts, ncount, ecount, elist, y);
+        free_cuts(&cuts);
+        if (rval) {
+            fprintf(stderr, "CCtsp_exactblossom_update failed\n");
+            goto CLEANUP;
+        }
+
+        printf("  round %3d  %6d changed  full %8.3f  update %8.3f seconds  %6d / %6d cuts"
+               "  max blossom violation %.4f / %.4f\n", r, r > 0 ? chcount : ecount, ftime, utime,
+               fullcount, updcount, fullviol, updviol);
+        if (r > 0) {
+            fulltime += ftime;
+            updtime += utime;
+            fullcuts += fullcount;
+            updcuts += updcount;
+            if (fabs(fullviol - updviol) > 1e-6) vdiff++;
+        }
+    }
+    printf("  after round 0: full %.3f, update %.3f seconds (%.1f%% saved),"
+           " %d / %d cuts (%+d)\n", fulltime, updtime,
+           fulltime > 0.0 ? 100.0 * (fulltime - updtime) / fulltime : 0.0,
+           fullcuts, updcuts, updcuts - fullcuts);
+    printf("  largest blossom violation %s in %d of %d rounds\n",
+           vdiff ? "differs" : "agrees", vdiff ? vdiff : rounds, rounds);
+
+CLEANUP:
+    CCtsp_free_blossom_workspace(&fullwork);
+    CCtsp_free_blossom_workspace(&updwork);
+    free(y);
+    free(chlist);
+    return rval;
+}
+
+
+// Half-integral solutions where the only violated blossom needs an x = 1/2
+// edge as a tooth to make the teeth odd (a zero-cost parity flip in LRT).
+// The first has the handle {3, 6, 11} with the teeth 6-7, 3-10 and 0-11,
+// violated by 0.5.
+static int check_elist0[] = {6, 11, 11, 3, 3, 6, 10, 9, 9, 5, 5, 10, 6, 7, 7, 0,
+                             0, 11, 3, 10, 9, 8, 8, 4, 4, 2, 2, 1, 1, 5, 2, 9,
+                             9, 4, 4, 0, 0, 5, 5, 8, 8, 7, 10, 1};
+static double check_x0[] = {0.75, 0.75, 0.25, 0.25, 0.25, 0.25, 1.0, 0.5, 0.5, 1.0, 0.5,
+                            0.5, 0.5, 1.0, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5};
+
+// Both engines are exact, so both must find the blossom violated by 0.5, with
+// every tree code, flow code and capacity mode.
+int check_engines(void) {
+    static const int capbits[3] = {0, 32, 64};
+    int ncount = 12, ecount = (int) (sizeof(check_x0) / sizeof(double));
+    int bad = 0, runs = 0;
+
+    for (int ghtree = CCtsp_BLOSSOM_GH_SHRINK; ghtree <= CCtsp_BLOSSOM_GH_ODDCUT; ghtree++) {
+        for (int flowalg = CC_FLOW_HIGHEST_LABEL; flowalg <= CC_FLOW_BK; flowalg++) {
+            for (int c = 0; c < 3; c++) {
+                double pr = check_maxviol(CCtsp_BLOSSOM_PADBERG_RAO, ghtree, flowalg,
+                                          capbits[c], ncount, ecount, check_elist0, check_x0);
+                double lrt = check_maxviol(CCtsp_BLOSSOM_LRT, ghtree, flowalg,
+                                           capbits[c], ncount, ecount, check_elist0, check_x0);
+                runs++;
+                if (fabs(pr - 0.5) > 1e-6 || fabs(lrt - 0.5) > 1e-6) {
+                    fprintf(stderr, "ghtree %d, %s, capbits %d: Padberg-Rao %.4f, LRT %.4f, want 0.5\n",
+                            ghtree, flow_name(flowalg), capbits[c], pr, lrt);
+                    bad++;
+                }
+            }
+        }
+    }
+    printf("check: %d of %d settings agree\n", runs - bad, runs);
+    if (check_odd_terminals()) bad++;
+    if (check_cut_weights()) bad++;
+    return bad ? 1 : 0;
+}
+
+static int record_min_cut(double val, int count, int *cut, void *pass_param) {
+    double *best = (double *) pass_param;
+    if (val < best[0]) {
+        best[0] = val;
+        best[1] = (count == 1) ? (double) cut[0] : -1.0;
+    }
+    return 0;
+}
+
+// On the path 0-1-2 with capacities 5 and 1, the minimum T-odd cut for
+// T = {0, 2} is {2}, of value 1.  With T = {0, 1, 2} every cut is T-odd,
+// and CCcut_odd_cuts must reject the odd T rather than report only the cut
+// of value 5 (the blossom code builds a Gomory-Hu tree for odd T instead).
+int check_odd_terminals(void) {
+    int elist[4] = {0, 1, 1, 2};
+    double ecap[2] = {5.0, 1.0};
+    int teven[2] = {0, 2}, todd[3] = {0, 1, 2};
+    int bad = 0;
+
+    for (int flowalg = CC_FLOW_HIGHEST_LABEL; flowalg <= CC_FLOW_BK; flowalg++) {
+        double best[2] = {CCtsp_LP_MAXDOUBLE, -1.0};
+        if (CCcut_odd_cuts(3, 2, elist, ecap, 2, teven, 10.0, flowalg,
+                           record_min_cut, best, NULL) ||
+            fabs(best[0] - 1.0) > 1e-9 || best[1] != 2.0) {
+            fprintf(stderr, "%s: minimum T-odd cut %.4f, want {2} of value 1\n",
+                    flow_name(flowalg), best[0]);
+            bad++;
+        }
+        if (CCcut_odd_cuts(3, 2, elist, ecap, 3, todd, 10.0, flowalg,
+                           record_min_cut, best, NULL) == 0) {
+            fprintf(stderr, "%s: odd T was not rejected\n", flow_name(flowalg));
+            bad++;
+        }
+    }
+    printf("check: odd-cut search %s on the 3-node path\n", bad ? "fails" : "passes");
+    return bad;
+}
+
+// The side of an s-t cut returned by CCcut_mincut_st must have the weight
+// of the flow.  On this graph the flows leave rounding residue (below
+// 1e-15) on saturated arcs; a residual test of > 0.0 crossed them, so the
+// push-relabel codes returned a side heavier than the flow value and the BK
+// code one that held s.
+static int cut_elist[] = {0, 1, 0, 2, 0, 3, 1, 2, 1, 3, 1, 4, 2, 4, 3, 4};
+static double cut_cap[] = {2.0 / 3.0, 0.3, 6.0 / 7.0, 0.8, 0.9, 0.3, 0.1 + 0.2, 1.0 / 3.0};
+
+int check_cut_weights(void) {
+    int ncount = 5, ecount = (int) (sizeof(cut_cap) / sizeof(double));
+    int bad = 0;
+
+    for (int flowalg = CC_FLOW_HIGHEST_LABEL; flowalg <= CC_FLOW_BK; flowalg++) {
+        char side[5] = {0};
+        int *cut = NULL, cutcount = 0;
+        double val, weight = 0.0;
+
+        if (CCcut_mincut_st(ncount, ecount, cut_elist, cut_cap, 0, ncount - 1, &val,
+                            &cut, &cutcount, flowalg)) {
+            fprintf(stderr, "%s: CCcut_mincut_st failed\n", flow_name(flowalg));
+            bad++;
+            continue;
+        }
+        for (int i = 0; i < cutcount; i++) side[cut[i]] = 1;
+        for (int e = 0; e < ecount; e++) {
+            if (side[cut_elist[2 * e]] != side[cut_elist[2 * e + 1]]) weight += cut_cap[e];
+        }
+        if (side[0] || !side[ncount - 1] || fabs(weight - val) > 1e-9) {
+            fprintf(stderr, "%s: cut side of weight %.6f, flow value %.6f\n",
+                    flow_name(flowalg), weight, val);
+            bad++;
+        }
+        CC_IFFREE(cut, int);
+    }
+    printf("check: s-t cut sides %s the flow value\n", bad ? "do not match" : "match");
+    return bad;
+}
+
+#define PATH_STACK  (32 * 1024)   // bytes of stack for check_paths
+#define PATH_EXACT  1001          // nodes of the strip for the exact separators
+
+#ifdef CC_POSIXTHREADS
+static void *paths_thread(void *arg) {
+    int *args = (int *) arg;
+    args[1] = run_paths(args[0]);
+    return NULL;
+}
+#endif
+
+// Runs the separators on the strip of generate_strip_solution, where every
+// depth-first search goes the length of the strip: fast and GH blossoms on
+// ncount nodes, and the Padberg-Rao and LRT engines on PATH_EXACT nodes
+// (each 0 < x < 1 edge is a marked node of their Gomory-Hu trees, so their
+// time grows faster than ncount).  With threads it runs on a PATH_STACK
+// stack, which a search recursing once per node would overflow; the exact
+// engines use Gusfield trees, since the shrinking tree code still recurses
+// on the depth of the tree.
+int check_paths(int ncount) {
+    if (ncount < 7) {
+        fprintf(stderr, "paths needs ncount at least 7\n");
+        return 1;
+    }
+    if (ncount % 2 == 0) ncount++;
+
+#ifdef CC_POSIXTHREADS
+    pthread_attr_t attr;
+    pthread_t thread;
+    int args[2] = {ncount, 1};
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, PATH_STACK);
+    if (pthread_create(&thread, &attr, paths_thread, args)) {
+        perror("pthread_create");
+        pthread_attr_destroy(&attr);
+        return 1;
+    }
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+    printf("paths: %s, %d KB stack\n", args[1] ? "failed" : "ok", PATH_STACK / 1024);
+    return args[1];
+#else
+    int rval = run_paths(ncount);
+    printf("paths: %s\n", rval ? "failed" : "ok");
+    return rval;
+#endif
+}
+
+int run_paths(int ncount) {
+    int rval;
+
+    rval = run_path_separator("fast blossoms", 0, ncount);
+    if (!rval) rval = run_path_separator("GH fast blossoms", 1, ncount);
+    if (!rval) rval = run_path_separator("Padberg-Rao exact", 2,
+                                         ncount < PATH_EXACT ? ncount : PATH_EXACT);
+    if (!rval) rval = run_path_separator("LRT exact", 3,
+                                         ncount < PATH_EXACT ? ncount : PATH_EXACT);
+    return rval;
+}
+
+// The strip is the mean of two tours, so a separator that returns a cut fails
+int run_path_separator(const char *name, int sep, int ncount) {
+    CCtsp_lpcut_in *cuts = NULL;
+    int cutcount = 0, ecount = 0, rval = 0;
+    int *elist = NULL;
+    double *x = NULL;
+    CCrandstate rstate;
+    CCtsp_blossomparams params;
+
+    generate_strip_solution(ncount, &ecount, &elist, &x);
+    if (!elist || !x) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(elist);
+        free(x);
+        return 1;
+    }
+
+    CCutil_sprand(1, &rstate);
+    CCtsp_init_blossomparams(&params);
+    params.engine = (sep == 3 ? CCtsp_BLOSSOM_LRT : CCtsp_BLOSSOM_PADBERG_RAO);
+    params.ghtree = CCtsp_BLOSSOM_GH_GUSFIELD;
+
+    double szeit = CCutil_real_zeit();
+    if (sep == 0) {
+        rval = CCtsp_fastblossom(&cuts, &cutcount, ncount, ecount, elist, x);
+    } else if (sep == 1) {
+        rval = CCtsp_ghfastblossom(&cuts, &cutcount, ncount, ecount, elist, x);
+    } else {
+        rval = CCtsp_exactblossom_params(&cuts, &cutcount, ncount, ecount, elist, x,
+                                         &rstate, &params);
+    }
+    printf("%-18s %8d nodes %8.3f seconds  %d cuts\n", name, ncount,
+           CCutil_real_zeit() - szeit, cutcount);
+    if (rval) {
+        fprintf(stderr, "%s failed\n", name);
+    } else if (cutcount > 0) {
+        fprintf(stderr, "%s found cuts on the strip\n", name);
+        rval = 1;
+    }
+
+    free_cuts(&cuts);
+    free(elist);
+    free(x);
+    return rval;
+}
+
+// The largest violation of the cuts of one engine, or -1.0 if it fails
+double check_maxviol(int engine, int ghtree, int flowalg, int capbits, int ncount, int ecount, int *elist, double *x) {
+    CCtsp_lpcut_in *cuts = NULL;
+    int cutcount = 0;
+    CCrandstate rstate;
+    CCtsp_blossomparams params;
+    double maxviol = 0.0;
+
+    CCutil_sprand(1, &rstate);
+    CCtsp_init_blossomparams(&params);
+    params.engine = engine;
+    params.ghtree = ghtree;
+    params.nthreads = (ghtree == CCtsp_BLOSSOM_GH_THREADED ? 2 : 0);
+    params.flowalg = flowalg;
+    params.capbits = capbits;
+    if (CCtsp_exactblossom_params(&cuts, &cutcount, ncount, ecount, elist, x, &rstate,
+                                  &params)) {
+        fprintf(stderr, "CCtsp_exactblossom_params failed for engine %d\n", engine);
+        return -1.0;
+    }
+    if (cutcount > 0) count_violated(cuts, ncount, ecount, elist, x, 1, &maxviol);
+    free_cuts(&cuts);
+    return maxviol;
+}
+
+// The largest 1 - x(delta(H) - F) - sum over F of (1 - x_e) of the blossoms in
+// cuts (handle cliques[0], teeth the edges F of the 2-node cliques), the value
+// the exact separators maximize.  The comb form of count_violated only agrees
+// with it if x(delta(v)) = 2 at every node, which the rounds of run_rounds
+// do not keep.
+double max_blossom_violation(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *elist, double *x) {
+    int *inh = calloc(ncount, sizeof(int));
+    int *mate = malloc(ncount * sizeof(int));
+    double maxviol = 0.0;
+    int i, tmp;
+
+    if (!inh || !mate) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(inh);
+        free(mate);
+        return 0.0;
+    }
+    for (i = 0; i < ncount; i++) mate[i] = -1;
+
+    for (CCtsp_lpcut_in *c = cuts; c; c = c->next) {
+        double val = 1.0;
+        int a, b;
+
+        CC_FOREACH_NODE_IN_CLIQUE (i, c->cliques[0], tmp) inh[i] = 1;
+        for (int t = 1; t < c->cliquecount; t++) {
+            a = b = -1;
+            CC_FOREACH_NODE_IN_CLIQUE (i, c->cliques[t], tmp) {
+                if (a == -1) a = i; else b = i;
+            }
+            if (b != -1) { mate[a] = b; mate[b] = a; }
+        }
+        for (int e = 0; e < ecount; e++) {
+            a = elist[2 * e];
+            b = elist[2 * e + 1];
+            if (inh[a] == inh[b]) continue;
+            val -= (mate[a] == b ? 1.0 - x[e] : x[e]);
+        }
+        if (val > maxviol) maxviol = val;
+
+        CC_FOREACH_NODE_IN_CLIQUE (i, c->cliques[0], tmp) inh[i] = 0;
+        for (int t = 1; t < c->cliquecount; t++) {
+            CC_FOREACH_NODE_IN_CLIQUE (i, c->cliques[t], tmp) mate[i] = -1;
+        }
+    }
+
+    free(inh);
+    free(mate);
+    return maxviol;
+}
+
+// Returns the number of cuts in the list whose left-hand side is below the
+// right-hand side; maxviol is set to the largest violation.
+int count_violated(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *elist, double *x, int nthreads, double *maxviol) {
+    int violated = 0, cutcount = 0;
+    double *viol = NULL;
+
+    *maxviol = 0.0;
+    if (CCtsp_cut_violations(cuts, ncount, ecount, elist, x, nthreads,
+                             &cutcount, &viol, NULL)) {
+        fprintf(stderr, "CCtsp_cut_violations failed\n");
+        return 0;
+    }
+
+    for (int k = 0; k < cutcount; k++) {
+        if (viol[k] > CC_MINCUT_ONE_EPSILON) {
+            violated++;
+            if (viol[k] > *maxviol) *maxviol = viol[k];
+        }
+    }
+
+    CC_IFFREE(viol, double);
+    return violated;
+}
+
+
+// Same construction as blossom_detector: every pair of nodes is an edge and
+// x is filled greedily so that no node has degree above 2.
+void generate_complete_solution(int ncount, int *ecount, int **elist, double **x) {
+    *ecount = ncount * (ncount - 1) / 2;
+    *elist = malloc(2 * (*ecount) * sizeof(int));
+    *x = malloc((*ecount) * sizeof(double));
+    double *vertex_sum = calloc(ncount, sizeof(double));
+    if (!*elist || !*x || !vertex_sum) {
+        free(vertex_sum);
+        return;
+    }
+
+    int edge_index = 0;
+    for (int i = 0; i < ncount; i++) {
+        for (int j = i + 1; j < ncount; j++) {
+            (*elist)[2 * edge_index] = i;
+            (*elist)[2 * edge_index + 1] = j;
+            edge_index++;
+        }
+    }
+    for (int i = 0; i < *ecount; i++) {
+        int u = (*elist)[2 * i];
+        int v = (*elist)[2 * i + 1];
+        double remaining_u = 2.0 - vertex_sum[u];
+        double remaining_v = 2.0 - vertex_sum[v];
+        double max_assignable = (remaining_u < remaining_v) ? remaining_u : remaining_v;
+        max_assignable = (max_assignable > 1.0) ? 1.0 : max_assignable;
+
+        (*x)[i] = ((double)rand() / RAND_MAX) * max_assignable;
+        vertex_sum[u] += (*x)[i];
+        vertex_sum[v] += (*x)[i];
+    }
+
+    free(vertex_sum);
+}
+
+
+// A sparse support graph made of disjoint blocks: half-integral triangles
+// with three pendant 1-edges (each a violated blossom) and fractional cycles.
+void generate_sparse_solution(int ncount, int *ecount, int **elist, double **x) {
+    int i = 0, m = 0;
+    *elist = malloc(6 * ncount * sizeof(int));
+    *x = malloc(3 * ncount * sizeof(double));
+    if (!*elist || !*x) return;
+
+#define ADD_EDGE(a, b, val) {                                             \
+    (*elist)[2 * m] = (a); (*elist)[2 * m + 1] = (b); (*x)[m++] = (val); \
+}
+
+    while (i + 6 <= ncount) {
+        if (rand() % 3 == 0) {
+            ADD_EDGE(i, i + 1, 0.5);
+            ADD_EDGE(i + 1, i + 2, 0.5);
+            ADD_EDGE(i, i + 2, 0.5);
+            ADD_EDGE(i, i + 3, 1.0);
+            ADD_EDGE(i + 1, i + 4, 1.0);
+            ADD_EDGE(i + 2, i + 5, 1.0);
+            i += 6;
+        } else {
+            int k = 4 + rand() % 8;
+            if (i + k > ncount) break;
+            for (int j = 0; j < k; j++) {
+                ADD_EDGE(i + j, i + (j + 1) % k, (double)(rand() % 100) / 100.0 + 0.005);
+            }
+            i += k;
+        }
+    }
+
+#undef ADD_EDGE
+
+    *ecount = m;
+}
+
+
+// LP-like supports from CCtsp_fractional_solution: about 1.6n and 1.35n
+// edges for the geometric and path families (both satisfy every blossom, so
+// they time searches that find nothing), and two violated blossoms planted
+// every ~60 nodes for the blossom family.
+void generate_family_solution(int family, int ncount, int seed, int *ecount, int **elist, double **x) {
+    CCrandstate rstate;
+    double rate = (family == CCtsp_FRACGEN_GEOMETRIC ? 0.4 :
+                   family == CCtsp_FRACGEN_PATHS ? 0.05 : 0.02);
+
+    CCutil_sprand(seed, &rstate);
+    if (CCtsp_fractional_solution(family, ncount, rate, 8, &rstate, ecount, elist, x)) {
+        fprintf(stderr, "CCtsp_fractional_solution failed\n");
+        *elist = NULL;
+        *x = NULL;
+    }
+}
+
+
+// A fractional strip: x = 1/2 on the edges (i, i+1) and (i, i+2), mod an
+// odd ncount, the mean of two tours.  All edges are fractional and form one
+// component of degree 4, so depth-first searches of it go ncount deep.
+void generate_strip_solution(int ncount, int *ecount, int **elist, double **x) {
+    *ecount = 2 * ncount;
+    *elist = malloc(2 * (size_t) *ecount * sizeof(int));
+    *x = malloc((size_t) *ecount * sizeof(double));
+    if (!*elist || !*x) return;
+
+    for (int i = 0; i < ncount; i++) {
+        (*elist)[4 * i] = i;
+        (*elist)[4 * i + 1] = (i + 1) % ncount;
+        (*elist)[4 * i + 2] = i;
+        (*elist)[4 * i + 3] = (i + 2) % ncount;
+        (*x)[2 * i] = 0.5;
+        (*x)[2 * i + 1] = 0.5;
+    }
+}
@@ -1,64 +1,337 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "machdefs.h"
 #include "util.h"
 #include "tsp.h"
 #include "macrorus.h"
 
+#define SEP_FAST  1
+#define SEP_GH    2
+#define SEP_EXACT 4
+#define SEP_ALL   (SEP_FAST | SEP_GH | SEP_EXACT)
+
+#define FAMILY_COMPLETE -1   // the greedy complete graph of generate_fractional_solution
+
+// The options of one run; detector_init_opts gives the old fixed settings
+typedef struct detector_opts {
+    const char *input;       // x-vector file, or NULL to generate one
+    const char *binary_out;  // write the x-vector here in the binary format and stop
+    int ncount;              // nodes of a generated solution
+    int family;              // FAMILY_COMPLETE or a CCtsp_FRACGEN_* family
+    double rate;             // fractional rate of the family (0 for its default)
+    int separators;          // SEP_* mask
+    int nthreads;            // 0 runs exact serially and checks the cuts with 4 threads
+    int rounds;
+    int max_cuts;            // stop after a round that adds more than this many cuts
+    int seed;
+    int seed_set;            // without --seed the complete graph keeps rand()'s default sequence
+    int quiet;               // no comb listing
+    int json;                // one JSON object on stdout and nothing else
+} detector_opts;
+
+// Wall and CPU (user, all threads) seconds of one phase, summed over the rounds
+typedef struct detector_phase {
+    double wall;
+    double cpu;
+} detector_phase;
+
+typedef struct detector_stats {
+    detector_phase load, heur, exact, verify;
+    int rounds;
+    int cuts[3];             // fast, gh, exact
+    int violated[3];
+} detector_stats;
+
 // Function Prototypes
-int blossom_loop(int ncount, int ecount, int *elist, double *x, int silent, CCrandstate *rstate);
-void verify_and_print_comb(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *elist, double *x);
+int blossom_loop(int ncount, int ecount, int *elist, double *x, detector_opts *opts,
+                 CCrandstate *rstate, detector_stats *stats);
+int verify_and_print_comb(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *elist, double *x,
+                          int nthreads, int quiet);
 void free_cuts(CCtsp_lpcut_in *cuts);
 void generate_fractional_solution(int ncount, int ecount, int *elist, double *x);
+void detector_init_opts(detector_opts *opts);
+int parse_args(int argc, char **argv, detector_opts *opts);
+void usage(char *name);
+void print_summary(detector_opts *opts, int ncount, int ecount, detector_stats *stats);
+void print_json(detector_opts *opts, int ncount, int ecount, detector_stats *stats);
 
 
 
 
 /*********************************main function for executable********************************************* */
+// Runs the blossom separators on an x-vector file (concorde text "ncount
+// ecount / u v x", or the binary format of CCutil_write_xvector_binary, which
+// is mapped instead of read) or on a generated solution, and reports the wall
+// and CPU time and the cuts of each phase; see usage() for the options.  With
+// no options it runs all three separators once on the 2000-node complete graph.
 int main(int argc, char **argv) {
-    int ncount = 2000;
-    int ecount = ncount * (ncount - 1) / 2; 
-    int *elist = malloc(2 * ecount * sizeof(int));
-    double *x = malloc(ecount * sizeof(double));
-    if (!elist || !x) {
-        fprintf(stderr, "Memory allocation failed\n");
+    detector_opts opts;
+    detector_stats stats;
+    int ncount = 0;
+    int ecount = 0;
+    int *elist = NULL;
+    double *x = NULL;
+    CCutil_xvector X;
+    double szeit, sczeit;
+
+    CCutil_init_xvector(&X);
+    detector_init_opts(&opts);
+    memset(&stats, 0, sizeof(stats));
+    if (parse_args(argc, argv, &opts)) {
+        usage(argv[0]);
         return 1;
     }
 
-   
-    generate_fractional_solution(ncount, ecount, elist, x);
+    szeit = CCutil_real_zeit();
+    sczeit = CCutil_zeit();
+    if (opts.input) {
+        if (CCutil_read_xvector(opts.input, &X)) {
+            fprintf(stderr, "Could not read %s\n", opts.input);
+            return 1;
+        }
+        ncount = X.ncount;
+        ecount = X.ecount;
+        elist = X.elist;
+        x = X.x;
+    } else if (opts.family == FAMILY_COMPLETE) {
+        ncount = opts.ncount;
+        ecount = ncount * (ncount - 1) / 2;
+        elist = malloc(2 * (size_t) ecount * sizeof(int));
+        x = malloc((size_t) ecount * sizeof(double));
+        if (!elist || !x) {
+            fprintf(stderr, "Memory allocation failed\n");
+            free(elist);
+            free(x);
+            return 1;
+        }
+        if (opts.seed_set) srand(opts.seed);
+        generate_fractional_solution(ncount, ecount, elist, x);
+    } else {
+        CCrandstate gstate;
+        double rate = opts.rate > 0.0 ? opts.rate :
+                      opts.family == CCtsp_FRACGEN_GEOMETRIC ? 0.4 :
+                      opts.family == CCtsp_FRACGEN_PATHS ? 0.05 : 0.02;
+
+        ncount = opts.ncount;
+        CCutil_sprand(opts.seed, &gstate);
+        if (CCtsp_fractional_solution(opts.family, ncount, rate, 8, &gstate,
+                                      &ecount, &elist, &x)) {
+            fprintf(stderr, "CCtsp_fractional_solution failed\n");
+            return 1;
+        }
+    }
+    stats.load.wall = CCutil_real_zeit() - szeit;
+    stats.load.cpu = CCutil_zeit() - sczeit;
 
+    if (!opts.json) {
+        if (opts.input) {
+            printf("Read %s: %d nodes, %d edges in %.3f seconds%s\n", opts.input,
+                   ncount, ecount, stats.load.wall, X.map ? " (mapped)" : "");
+        } else {
+            printf("Generated %d nodes, %d edges in %.3f seconds\n", ncount, ecount,
+                   stats.load.wall);
+        }
+    }
 
+    int rval = 0;
+    if (opts.binary_out) {
+        rval = CCutil_write_xvector_binary(opts.binary_out, ncount, ecount, elist, x);
+        if (!rval && !opts.json) printf("Wrote %s\n", opts.binary_out);
+        goto CLEANUP;
+    }
 
-    printf("\nRunning revised blossom loop...\n");
-    int silent = 0;
+    if (!opts.json) printf("\nRunning revised blossom loop...\n");
     CCrandstate rstate;
-    CCutil_sprand(12345, &rstate);
+    CCutil_sprand(opts.seed, &rstate);
 
-    int rval = blossom_loop(ncount, ecount, elist, x, silent, &rstate);
+    rval = blossom_loop(ncount, ecount, elist, x, &opts, &rstate, &stats);
     if (rval) {
         fprintf(stderr, "Blossom loop failed\n");
+    } else if (opts.json) {
+        print_json(&opts, ncount, ecount, &stats);
+    } else {
+        printf("Blossom loop completed successfully.\n");
+        print_summary(&opts, ncount, ecount, &stats);
+    }
+
+CLEANUP:
+    if (opts.input) {
+        CCutil_free_xvector(&X);
+    } else {
         free(elist);
         free(x);
-        return 1;
     }
-    printf("Blossom loop completed successfully.\n");
-
-    free(elist);
-    free(x);
-    return 0;
+    return rval ? 1 : 0;
 }
 /************************************************************************************************** */
 
 
 
+void detector_init_opts(detector_opts *opts) {
+    opts->input = NULL;
+    opts->binary_out = NULL;
+    opts->ncount = 2000;
+    opts->family = FAMILY_COMPLETE;
+    opts->rate = 0.0;
+    opts->separators = SEP_ALL;
+    opts->nthreads = 0;
+    opts->rounds = 1;
+    opts->max_cuts = 10;
+    opts->seed = 12345;
+    opts->seed_set = 0;
+    opts->quiet = 0;
+    opts->json = 0;
+}
 
 
+// Options are "--name value" or "--name=value"; a bare argument is the input file
+int parse_args(int argc, char **argv, detector_opts *opts) {
+    for (int i = 1; i < argc; i++) {
+        char *arg = argv[i];
+        char *val = NULL;
+        char *end;
+        size_t len;
 
+        if (strncmp(arg, "--", 2) != 0) {
+            if (opts->input) {
+                fprintf(stderr, "More than one input file: %s\n", arg);
+                return 1;
+            }
+            opts->input = arg;
+            continue;
+        }
+        arg += 2;
+        len = strcspn(arg, "=");
+        if (arg[len] == '=') val = arg + len + 1;
+
+#define OPT_IS(name) (strlen(name) == len && strncmp(arg, name, len) == 0)
+#define NEED_VALUE                                                      \
+        if (!val) {                                                     \
+            if (i + 1 >= argc) {                                        \
+                fprintf(stderr, "Option --%.*s needs a value\n", (int) len, arg); \
+                return 1;                                               \
+            }                                                           \
+            val = argv[++i];                                            \
+        }
+#define INT_VALUE(dst, lo)                                              \
+        NEED_VALUE;                                                     \
+        dst = (int) strtol(val, &end, 10);                              \
+        if (*val == '\0' || *end != '\0' || dst < (lo)) {               \
+            fprintf(stderr, "Bad value for --%.*s: %s\n", (int) len, arg, val); \
+            return 1;                                                   \
+        }
 
+        if (OPT_IS("quiet") || OPT_IS("json") || OPT_IS("help")) {
+            if (val) {
+                fprintf(stderr, "Option --%.*s takes no value\n", (int) len, arg);
+                return 1;
+            }
+            if (OPT_IS("help")) return 1;
+            if (OPT_IS("json")) opts->json = 1;
+            opts->quiet = 1;
+        } else if (OPT_IS("input")) {
+            NEED_VALUE;
+            opts->input = val;
+        } else if (OPT_IS("write-binary")) {
+            NEED_VALUE;
+            opts->binary_out = val;
+        } else if (OPT_IS("nodes")) {
+            INT_VALUE(opts->ncount, 6);
+        } else if (OPT_IS("family")) {
+            NEED_VALUE;
+            if (strcmp(val, "complete") == 0) {
+                opts->family = FAMILY_COMPLETE;
+            } else if (strcmp(val, "geometric") == 0) {
+                opts->family = CCtsp_FRACGEN_GEOMETRIC;
+            } else if (strcmp(val, "blossoms") == 0) {
+                opts->family = CCtsp_FRACGEN_BLOSSOMS;
+            } else if (strcmp(val, "paths") == 0) {
+                opts->family = CCtsp_FRACGEN_PATHS;
+            } else {
+                fprintf(stderr, "Unknown family: %s\n", val);
+                return 1;
+            }
+        } else if (OPT_IS("rate")) {
+            NEED_VALUE;
+            opts->rate = strtod(val, &end);
+            if (*val == '\0' || *end != '\0' || opts->rate <= 0.0 || opts->rate > 1.0) {
+                fprintf(stderr, "Bad value for --rate: %s\n", val);
+                return 1;
+            }
+        } else if (OPT_IS("separators")) {
+            NEED_VALUE;
+            opts->separators = 0;
+            for (char *s = val; *s; ) {
+                size_t n = strcspn(s, ",");
+                if (n == 4 && strncmp(s, "fast", 4) == 0) {
+                    opts->separators |= SEP_FAST;
+                } else if (n == 2 && strncmp(s, "gh", 2) == 0) {
+                    opts->separators |= SEP_GH;
+                } else if (n == 5 && strncmp(s, "exact", 5) == 0) {
+                    opts->separators |= SEP_EXACT;
+                } else if (n == 3 && strncmp(s, "all", 3) == 0) {
+                    opts->separators |= SEP_ALL;
+                } else {
+                    fprintf(stderr, "Unknown separator: %.*s\n", (int) n, s);
+                    return 1;
+                }
+                s += n;
+                if (*s == ',') s++;
+            }
+            if (!opts->separators) {
+                fprintf(stderr, "No separators selected\n");
+                return 1;
+            }
+        } else if (OPT_IS("threads")) {
+            INT_VALUE(opts->nthreads, 0);
+        } else if (OPT_IS("rounds")) {
+            INT_VALUE(opts->rounds, 1);
+        } else if (OPT_IS("max-cuts")) {
+            INT_VALUE(opts->max_cuts, 0);
+        } else if (OPT_IS("seed")) {
+            INT_VALUE(opts->seed, 0);
+            opts->seed_set = 1;
+        } else {
+            fprintf(stderr, "Unknown option: --%.*s\n", (int) len, arg);
+            return 1;
+        }
+#undef INT_VALUE
+#undef NEED_VALUE
+#undef OPT_IS
+    }
 
+    if (opts->input && (opts->family != FAMILY_COMPLETE || opts->rate > 0.0)) {
+        fprintf(stderr, "--family and --rate do not apply to an input file\n");
+        return 1;
+    }
+    if (opts->rate > 0.0 && opts->family == FAMILY_COMPLETE) {
+        fprintf(stderr, "--rate needs --family geometric, blossoms or paths\n");
+        return 1;
+    }
+    return 0;
+}
 
 
+void usage(char *name) {
+    fprintf(stderr, "Usage: %s [options] [xfile]\n", name);
+    fprintf(stderr, "   --input FILE         x-vector file, text or binary (same as xfile)\n");
+    fprintf(stderr, "   --write-binary FILE  write the x-vector in the binary format and stop\n");
+    fprintf(stderr, "   --nodes N            nodes of a generated solution (default 2000)\n");
+    fprintf(stderr, "   --family F           complete (default), geometric, blossoms or paths\n");
+    fprintf(stderr, "   --rate R             fractional rate of the family (default 0.4,\n");
+    fprintf(stderr, "                        0.02 and 0.05)\n");
+    fprintf(stderr, "   --separators LIST    comma list of fast, gh, exact (default all)\n");
+    fprintf(stderr, "   --threads N          threads for exact blossoms and for checking the\n");
+    fprintf(stderr, "                        cuts (default 0: serial exact, 4 checking)\n");
+    fprintf(stderr, "   --rounds N           separation rounds (default 1)\n");
+    fprintf(stderr, "   --max-cuts N         stop after a round adding more than N cuts\n");
+    fprintf(stderr, "                        (default 10)\n");
+    fprintf(stderr, "   --seed N             random seed (default 12345)\n");
+    fprintf(stderr, "   --quiet              no comb listing, only the summary\n");
+    fprintf(stderr, "   --json               print the summary as one JSON object\n");
+    fprintf(stderr, "   Options also take the form --name=value.\n");
+}
 
 
 void blossom_separation(int ncount, int ecount, int *elist, double *x) {
@@ -68,11 +341,14 @@ void blossom_separation(int ncount, int ecount, int *elist, double *x) {
     }
 
     printf("\nRunning Blossom Separation...\n");
-    int silent = 0;
+    detector_opts opts;
+    detector_stats stats;
     CCrandstate rstate;
-    CCutil_sprand(12345, &rstate);
+    detector_init_opts(&opts);
+    memset(&stats, 0, sizeof(stats));
+    CCutil_sprand(opts.seed, &rstate);
 
-    int rval = blossom_loop(ncount, ecount, elist, x, silent, &rstate);
+    int rval = blossom_loop(ncount, ecount, elist, x, &opts, &rstate, &stats);
     if (rval) {
         fprintf(stderr, "Blossom loop failed\n");
         return;
@@ -114,72 +390,143 @@ void generate_fractional_solution(int ncount, int ecount, int *elist, double *x)
 }
 
 
-int blossom_loop(int ncount, int ecount, int *elist, double *x, int silent, CCrandstate *rstate) {
-    int max_cutcout =10;
+// Reports and frees the cuts of one separator, adding its counts to slot s of stats
+static void report_cuts(CCtsp_lpcut_in *cuts, int count, int s, const char *none,
+                        int ncount, int ecount, int *elist, double *x, detector_opts *opts,
+                        detector_stats *stats) {
+    int vthreads = opts->nthreads > 0 ? opts->nthreads : 4;
+
+    if (count > 0) {
+        double szeit = CCutil_real_zeit(), sczeit = CCutil_zeit();
+        stats->cuts[s] += count;
+        stats->violated[s] += verify_and_print_comb(cuts, ncount, ecount, elist, x,
+                                                    vthreads, opts->quiet);
+        free_cuts(cuts);
+        stats->verify.wall += CCutil_real_zeit() - szeit;
+        stats->verify.cpu += CCutil_zeit() - sczeit;
+        if (!opts->quiet) printf("Freeing cuts completed\n");
+    } else if (!opts->json) {
+        printf("%s\n", none);
+    }
+}
+
+
+int blossom_loop(int ncount, int ecount, int *elist, double *x, detector_opts *opts,
+                 CCrandstate *rstate, detector_stats *stats) {
     int cutcount = 0, cut_added = 0;
-    int outside = 0, num_loop = 1;
-    CCtsp_lpcut_in *cuts = NULL;
+    int ghcount = 0;
+    int rval = 0;
+    double szeit, sczeit;
+    CCtsp_lpcut_in *cuts = NULL, *ghcuts = NULL;
 
     do {
         cut_added = 0;  // Reset cut_added for this outer loop iteration
+        cutcount = ghcount = 0;
+        stats->rounds++;
+
+        // Both fast heuristics share one build of the support graph
+        szeit = CCutil_real_zeit();
+        sczeit = CCutil_zeit();
+        if ((opts->separators & SEP_FAST) && (opts->separators & SEP_GH)) {
+            rval = CCtsp_heurblossom(&cuts, &cutcount, &ghcuts, &ghcount, ncount, ecount,
+                                     elist, x, 0, NULL);
+        } else if (opts->separators & SEP_FAST) {
+            rval = CCtsp_fastblossom(&cuts, &cutcount, ncount, ecount, elist, x);
+        } else if (opts->separators & SEP_GH) {
+            rval = CCtsp_ghfastblossom(&ghcuts, &ghcount, ncount, ecount, elist, x);
+        }
+        stats->heur.wall += CCutil_real_zeit() - szeit;
+        stats->heur.cpu += CCutil_zeit() - sczeit;
+        if (rval) {
+            fprintf(stderr, "fast blossom heuristics failed\n");
+            goto CLEANUP;
+        }
 
         // Fast Blossoms
-        printf("\nRunning Fast Blossoms...\n");
-        CCtsp_fastblossom(&cuts, &cutcount, ncount, ecount, elist, x);
-        if (cutcount > 0) {
+        if (opts->separators & SEP_FAST) {
+            if (!opts->json) printf("\nRunning Fast Blossoms...\n");
             cut_added += cutcount;
-            verify_and_print_comb(cuts, ncount, ecount, elist, x);
-            free_cuts(cuts);
+            report_cuts(cuts, cutcount, 0, "Fast Blossoms found no cuts.",
+                        ncount, ecount, elist, x, opts, stats);
             cuts = NULL;
-        } else {
-            printf("Fast Blossoms found no cuts.\n");
         }
 
         // Groetschel-Holland Fast Blossoms
-        printf("\nRunning Groetschel-Holland Fast Blossoms...\n");
-        CCtsp_ghfastblossom(&cuts, &cutcount, ncount, ecount, elist, x);
-        if (cutcount > 0) {
-            cut_added += cutcount;
-            verify_and_print_comb(cuts, ncount, ecount, elist, x);
-            free_cuts(cuts);
-            cuts = NULL;
-        } else {
-            printf("GH Fast Blossoms found no cuts.\n");
+        if (opts->separators & SEP_GH) {
+            if (!opts->json) printf("\nRunning Groetschel-Holland Fast Blossoms...\n");
+            cut_added += ghcount;
+            report_cuts(ghcuts, ghcount, 1, "GH Fast Blossoms found no cuts.",
+                        ncount, ecount, elist, x, opts, stats);
+            ghcuts = NULL;
         }
 
         // Exact Blossoms
-        printf("\nRunning Exact Blossoms...\n");
-        CCtsp_exactblossom(&cuts, &cutcount, ncount, ecount, elist, x, rstate);
-        if (cutcount > 0) {
+        if (opts->separators & SEP_EXACT) {
+            if (!opts->json) printf("\nRunning Exact Blossoms...\n");
+            cutcount = 0;
+            szeit = CCutil_real_zeit();
+            sczeit = CCutil_zeit();
+            if (opts->nthreads > 0) {
+                rval = CCtsp_exactblossom_threaded(&cuts, &cutcount, ncount, ecount, elist,
+                                                   x, rstate, opts->nthreads);
+            } else {
+                rval = CCtsp_exactblossom(&cuts, &cutcount, ncount, ecount, elist, x, rstate);
+            }
+            stats->exact.wall += CCutil_real_zeit() - szeit;
+            stats->exact.cpu += CCutil_zeit() - sczeit;
+            if (rval) {
+                fprintf(stderr, "exact blossoms failed\n");
+                goto CLEANUP;
+            }
             cut_added += cutcount;
-            verify_and_print_comb(cuts, ncount, ecount, elist, x);
-            free_cuts(cuts);
+            report_cuts(cuts, cutcount, 2, "Exact Blossoms found no cuts.",
+                        ncount, ecount, elist, x, opts, stats);
             cuts = NULL;
-        } else {
-            printf("Exact Blossoms found no cuts.\n");
         }
 
-    } while (cut_added > 0 && ++outside < num_loop && cut_added <= max_cutcout);  // Continue if cuts were added
+    } while (cut_added > 0 && stats->rounds < opts->rounds &&
+             cut_added <= opts->max_cuts);  // Continue if cuts were added
 
+CLEANUP:
     if (cuts) free_cuts(cuts);
-    return 0;  // Return 0 explicitly since rval is no longer tracked
+    if (ghcuts) free_cuts(ghcuts);
+    return rval;
 }
 
 
-// Verify and Print Comb Details
-void verify_and_print_comb(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *elist, double *x) {
+// Verify and Print Comb Details; returns the number of violated combs
+int verify_and_print_comb(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *elist, double *x,
+                          int nthreads, int quiet) {
     CCtsp_lpcut_in *current_cut = cuts;
     int comb_index = 0;
+    int cutcount = 0;
+    int violated = 0;
+    double *viol = NULL, *lhs = NULL;
+
+    // x(delta(C)) summed over the handle and the teeth, for all the combs at once
+    if (CCtsp_cut_violations(cuts, ncount, ecount, elist, x, nthreads,
+                             &cutcount, &viol, &lhs)) {
+        fprintf(stderr, "CCtsp_cut_violations failed\n");
+        return 0;
+    }
+
+    if (quiet) {
+        for (int i = 0; i < cutcount; i++) {
+            if (viol[i] > 0.0) violated++;
+        }
+        CC_IFFREE(viol, double);
+        CC_IFFREE(lhs, double);
+        return violated;
+    }
 
     while (current_cut) {
         printf("\nInspecting Comb %d:\n", ++comb_index);
 
         if (!current_cut->cliques || current_cut->cliquecount <= 0) {
             fprintf(stderr, "Invalid clique structure in comb %d\n", comb_index);
-            return;
+            break;
         }
 
-        double delta_H = 0.0, delta_T_sum = 0.0;
         int num_teeth = current_cut->cliquecount - 1;
 
         // Print the handle
@@ -187,7 +534,7 @@ void verify_and_print_comb(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *el
         CCtsp_lpclique *handle = &(current_cut->cliques[0]);
         if (!handle || handle->segcount <= 0) {
             fprintf(stderr, "Invalid handle in comb %d\n", comb_index);
-            return;
+            break;
         }
         for (int s = 0; s < handle->segcount; s++) {
             if (handle->nodes[s].lo < 0 || handle->nodes[s].hi < 0) continue; // Validate nodes
@@ -207,42 +554,20 @@ void verify_and_print_comb(CCtsp_lpcut_in *cuts, int ncount, int ecount, int *el
             printf("\n");
         }
 
-        // Calculate delta_H and delta_T_sum
-        for (int i = 0; i < ecount; i++) {
-            int u = elist[2 * i];
-            int v = elist[2 * i + 1];
-
-            if (u < 0 || u >= ncount || v < 0 || v >= ncount) {
-                fprintf(stderr, "Invalid edge indices (%d, %d) in comb %d\n", u, v, comb_index);
-                continue;
-            }
-
-            for (int t = 0; t < current_cut->cliquecount; t++) {
-                CCtsp_lpclique *clique = &(current_cut->cliques[t]);
-                if (!clique || clique->segcount <= 0) continue;
-
-                int in_handle = 0, in_teeth = 0;
-                for (int s = 0; s < clique->segcount; s++) {
-                    if (clique->nodes[s].lo <= u && u <= clique->nodes[s].hi) in_handle++;
-                    if (clique->nodes[s].lo <= v && v <= clique->nodes[s].hi) in_teeth++;
-                }
-
-                if ((in_handle && !in_teeth) || (!in_handle && in_teeth)) {
-                    if (t == 0) delta_H += x[i];
-                    else delta_T_sum += x[i];
-                }
-            }
-        }
-
-        printf("LHS = %.4f, RHS = %d\n", delta_H + delta_T_sum, 3 * num_teeth + 1);
-        if (delta_H + delta_T_sum < 3 * num_teeth + 1) {
+        printf("LHS = %.4f, RHS = %d\n", lhs[comb_index - 1], CCtsp_COMBRHS(current_cut));
+        if (lhs[comb_index - 1] < CCtsp_COMBRHS(current_cut)) {
             printf("  Comb inequality is violated.\n");
+            violated++;
         } else {
             printf("  Comb inequality is satisfied.\n");
         }
 
         current_cut = current_cut->next;
     }
+
+    CC_IFFREE(viol, double);
+    CC_IFFREE(lhs, double);
+    return violated;
 }
 
 
@@ -252,7 +577,83 @@ void free_cuts(CCtsp_lpcut_in *cuts) {
     while (cuts) {
         CCtsp_lpcut_in *next = cuts->next;
         CCtsp_free_lpcut_in(cuts);
+        CC_FREE(cuts, CCtsp_lpcut_in);
         cuts = next;
     }
-    printf("Freeing cuts completed\n");
+}
+
+
+// Per-phase table after the run
+void print_summary(detector_opts *opts, int ncount, int ecount, detector_stats *stats) {
+    static const char *names[3] = {"fast", "gh", "exact"};
+    static const int bits[3] = {SEP_FAST, SEP_GH, SEP_EXACT};
+
+    printf("\nSummary: %d nodes, %d edges, %d threads, %d round%s\n", ncount, ecount,
+           opts->nthreads, stats->rounds, stats->rounds == 1 ? "" : "s");
+    printf("  %-8s %10s %10s\n", "phase", "wall", "cpu");
+    printf("  %-8s %10.4f %10.4f\n", "load", stats->load.wall, stats->load.cpu);
+    printf("  %-8s %10.4f %10.4f\n", "heur", stats->heur.wall, stats->heur.cpu);
+    printf("  %-8s %10.4f %10.4f\n", "exact", stats->exact.wall, stats->exact.cpu);
+    printf("  %-8s %10.4f %10.4f\n", "verify", stats->verify.wall, stats->verify.cpu);
+    for (int s = 0; s < 3; s++) {
+        if (opts->separators & bits[s]) {
+            printf("  %-6s %d cuts, %d violated\n", names[s], stats->cuts[s],
+                   stats->violated[s]);
+        }
+    }
+}
+
+
+static void print_json_string(const char *s) {
+    putchar('"');
+    for (; *s; s++) {
+        unsigned char c = (unsigned char) *s;
+        if (c == '"' || c == '\\') {
+            printf("\\%c", c);
+        } else if (c < 0x20) {
+            printf("\\u%04x", c);
+        } else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+
+static void print_json_phase(const char *name, detector_phase *p, int last) {
+    printf("    \"%s\": {\"wall\": %.6f, \"cpu\": %.6f}%s\n", name, p->wall, p->cpu,
+           last ? "" : ",");
+}
+
+
+void print_json(detector_opts *opts, int ncount, int ecount, detector_stats *stats) {
+    static const char *names[3] = {"fast", "gh", "exact"};
+    static const int bits[3] = {SEP_FAST, SEP_GH, SEP_EXACT};
+    static const char *families[3] = {"geometric", "blossoms", "paths"};
+    int first = 1;
+
+    printf("{\n  \"input\": ");
+    if (opts->input) {
+        print_json_string(opts->input);
+    } else {
+        print_json_string(opts->family == FAMILY_COMPLETE ? "complete" :
+                          families[opts->family]);
+    }
+    printf(",\n  \"ncount\": %d,\n  \"ecount\": %d,\n", ncount, ecount);
+    printf("  \"threads\": %d,\n  \"seed\": %d,\n  \"rounds\": %d,\n", opts->nthreads,
+           opts->seed, stats->rounds);
+    printf("  \"phases\": {\n");
+    print_json_phase("load", &stats->load, 0);
+    print_json_phase("heur", &stats->heur, 0);
+    print_json_phase("exact", &stats->exact, 0);
+    print_json_phase("verify", &stats->verify, 1);
+    printf("  },\n  \"separators\": {");
+    for (int s = 0; s < 3; s++) {
+        if (opts->separators & bits[s]) {
+            printf("%s\n    \"%s\": {\"cuts\": %d, \"violated\": %d}", first ? "" : ",",
+                   names[s], stats->cuts[s], stats->violated[s]);
+            first = 0;
+        }
+    }
+    printf("\n  }\n}\n");
 }
@@ -36,11 +36,58 @@
 /*        -elist is the edge list in node node format                       */
 /*        -x is an lp solution vector                                       */
 /*    NOTES:                                                                */
-/*      The exactblossom  code was written very early in our TSP project.   */
-/*      In January 1999 it was updated to fit into the current concorde,    */
-/*      but the guts of the code are still written in our old sloppy        */
-/*      style.  This is a good candidate for a rewrite (big speedups are    */
-/*      probably possible without too much effort).                         */
+/*      The exactblossom code was written very early in our TSP project.    */
+/*      The support graph and the Padberg-Rao split graph are now kept in   */
+/*      index arrays (a CSR adjacency of the 0 < x < 1 edges, and the       */
+/*      split edges in creation order) rather than in linked lists of       */
+/*      edge and node objects.  The split graph is broken into its          */
+/*      connected components and each component gets its own Gomory-Hu      */
+/*      tree, built with a seed drawn from rstate in component order.       */
+/*                                                                          */
+/*  int CCtsp_exactblossom_threaded (CCtsp_lpcut_in **cuts,                 */
+/*      int *cutcount, int ncount, int ecount, int *elist, double *x,       */
+/*      CCrandstate *rstate, int nthreads)                                  */
+/*    SAME as CCtsp_exactblossom, but the components of the split graph     */
+/*     are handed out to nthreads threads.                                  */
+/*     -nthreads is the number of threads to use.  0 ==> sequential code    */
+/*      threads are only used if CC_POSIXTHREADS is defined                 */
+/*    NOTES:                                                                */
+/*      The cuts (and their order) do not depend on nthreads.               */
+/*                                                                          */
+/*  void CCtsp_init_blossomparams (CCtsp_blossomparams *p)                  */
+/*    SETS p to the defaults (Padberg-Rao, no threads, highest-label        */
+/*     push-relabel).                                                       */
+/*                                                                          */
+/*  int CCtsp_exactblossom_params (CCtsp_lpcut_in **cuts,                   */
+/*      int *cutcount, int ncount, int ecount, int *elist, double *x,       */
+/*      CCrandstate *rstate, CCtsp_blossomparams *params)                   */
+/*    SAME as CCtsp_exactblossom, with the options in params.               */
+/*     -params->engine selects the exact method, CCtsp_BLOSSOM_PADBERG_RAO  */
+/*      (Gomory-Hu tree of the split graph over its odd nodes) or           */
+/*      CCtsp_BLOSSOM_LRT (Letchford, Reinelt and Theis: Gomory-Hu tree     */
+/*      of the support graph with capacities min(x, 1-x), and the best odd  */
+/*      set of teeth for each tree cut)                                     */
+/*     -params->nthreads is as in CCtsp_exactblossom_threaded               */
+/*     -params->ghtree selects the Gomory-Hu code, CCtsp_BLOSSOM_GH_SHRINK  */
+/*      (CCcut_gomory_hu) or CCtsp_BLOSSOM_GH_GUSFIELD                      */
+/*      (CCcut_gusfield_gomory_hu, no contraction, but a flow from every    */
+/*      node of the component) or CCtsp_BLOSSOM_GH_THREADED                 */
+/*      (CCcut_gomory_hu_threaded: the components with at least             */
+/*      BLO_GHTASKMIN nodes are taken one at a time, largest first, and     */
+/*      the splits of each tree are shared by nthreads threads; the rest    */
+/*      of the components are handed out to the threads as usual).  The     */
+/*      trees, and so the cuts, do not depend on nthreads.                  */
+/*      CCtsp_BLOSSOM_GH_ODDCUT builds no tree: the Padberg-Rao engine     */
+/*      checks the odd cuts of value less than 1 - BLOTOLERANCE found by    */
+/*      CCcut_odd_cuts, which skips the flows that cannot give one, and     */
+/*      the LRT engine (whose cuts need not be odd) uses CCcut_gomory_hu    */
+/*     -params->flowalg selects the max-flow code used in the Gomory-Hu     */
+/*      trees (see CCcut_mincut_st); the codes can find different minimum   */
+/*      cuts, and so different trees and cuts                               */
+/*     -params->capbits is 0 to run the flows on the capacities as they     */
+/*      are, or 32 or 64 to round them once to integers (see                */
+/*      CCcut_scale_capacities) so that every flow is exact; the tree       */
+/*      values are divided back before they are compared with 1             */
 /*                                                                          */
 /*  int CCtsp_fastblossom (CCtsp_lpcut_in **cuts, int *cutcount,            */
 /*      int ncount, int ecount, int *elist, double *x)                      */
@@ -53,6 +100,97 @@
 /*     Holland. It works with the 0 < x < 1-EPS (with EPS = .3) graph,      */
 /*     builds components, and picks a greedy set of teeth.                  */
 /*                                                                          */
+/*  int CCtsp_heurblossom (CCtsp_lpcut_in **fastcuts, int *fastcount,       */
+/*      CCtsp_lpcut_in **ghcuts, int *ghcount, int ncount, int ecount,      */
+/*      int *elist, double *x, int epscount, double *eps)                   */
+/*    RUNS CCtsp_fastblossom and CCtsp_ghfastblossom on a single copy of    */
+/*     the support graph.                                                   */
+/*     -fastcuts/fastcount get the cuts of the fast heuristic (fastcuts     */
+/*      can be NULL to skip it)                                             */
+/*     -ghcuts/ghcount get the cuts of the Groetschel-Holland heuristic     */
+/*      (ghcuts can be NULL to skip it)                                     */
+/*     -eps is an array of epscount values of EPS, each giving one          */
+/*      Groetschel-Holland pass; if eps is NULL, only EPS = .3 is used      */
+/*    NOTES:                                                                */
+/*      A value of EPS that leaves the 0 < x < 1-EPS graph the same as an   */
+/*      earlier value is skipped, since it would give the same cuts.        */
+/*                                                                          */
+/*  int CCtsp_sweepblossom (CCtsp_lpcut_in **cuts, int *cutcount,           */
+/*      int ncount, int ecount, int *elist, double *x)                      */
+/*    FINDS blossoms like CCtsp_ghfastblossom, but for every value of EPS   */
+/*     at once: the 0 < x < 1 edges are merged in increasing order of x     */
+/*     with a union-find, and each component that comes up (with at least   */
+/*     3 nodes) is tried as a handle, with the best odd set of the edges    */
+/*     leaving it as teeth.                                                 */
+/*    NOTES:                                                                */
+/*      Runs in O(ecount log ecount) time, plus the time to write out the   */
+/*      handles that pass a quick test on the teeth.                        */
+/*                                                                          */
+/*  void CCtsp_init_blossom_workspace (CCtsp_blossom_workspace *w)          */
+/*    INITIALIZES an empty workspace (nothing is allocated).                */
+/*                                                                          */
+/*  void CCtsp_free_blossom_workspace (CCtsp_blossom_workspace *w)          */
+/*    FREES the buffers held by w.                                          */
+/*                                                                          */
+/*  int CCtsp_exactblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,      */
+/*      int ncount, int ecount, int *elist, double *x,                      */
+/*      CCrandstate *rstate, CCtsp_blossomparams *params,                   */
+/*      CCtsp_blossom_workspace *w)                                         */
+/*  int CCtsp_fastblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,       */
+/*      int ncount, int ecount, int *elist, double *x,                      */
+/*      CCtsp_blossom_workspace *w)                                         */
+/*  int CCtsp_ghfastblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,     */
+/*      int ncount, int ecount, int *elist, double *x,                      */
+/*      CCtsp_blossom_workspace *w)                                         */
+/*  int CCtsp_heurblossom_work (CCtsp_lpcut_in **fastcuts, int *fastcount,  */
+/*      CCtsp_lpcut_in **ghcuts, int *ghcount, int ncount, int ecount,      */
+/*      int *elist, double *x, int epscount, double *eps,                   */
+/*      CCtsp_blossom_workspace *w)                                         */
+/*  int CCtsp_sweepblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,      */
+/*      int ncount, int ecount, int *elist, double *x,                      */
+/*      CCtsp_blossom_workspace *w)                                         */
+/*    SAME as CCtsp_exactblossom_params, CCtsp_fastblossom,                 */
+/*     CCtsp_ghfastblossom, CCtsp_heurblossom and CCtsp_sweepblossom, but   */
+/*     the scratch space is taken from w, which can be passed to any        */
+/*     number of calls (one at a time).                                     */
+/*    NOTES:                                                                */
+/*      Every separator starts by copying the edges with x >= ZEROPLUS      */
+/*      into w (keeping their order), and only looks at that copy, so the   */
+/*      work and the size of w follow the support graph, not ecount.        */
+/*      The buffers in w only grow, to fit the largest ncount, number of    */
+/*      support edges and nthreads seen so far, so calls that fit do no     */
+/*      allocation beyond the cuts themselves (and the Gomory-Hu trees of   */
+/*      the exact search).                                                  */
+/*      w->maxcuts and w->minviol (both 0 after init, meaning no limit)     */
+/*      put a budget on every separator run with w: only cuts violated by   */
+/*      at least minviol (in the comb form, 3t+1 - lhs) are returned, and   */
+/*      with maxcuts > 0 only the maxcuts most violated of them, most       */
+/*      violated first.  A violation is measured before the cut is built,   */
+/*      so cuts that cannot make the list cost little.  If both are set,    */
+/*      the search stops as soon as it holds maxcuts cuts (the cuts then    */
+/*      depend on nthreads; otherwise they do not).                         */
+/*                                                                          */
+/*  int CCtsp_exactblossom_update (CCtsp_lpcut_in **cuts, int *cutcount,    */
+/*      int ncount, int ecount, int *elist, double *x, int chcount,         */
+/*      int *chlist, CCrandstate *rstate, CCtsp_blossomparams *params,      */
+/*      CCtsp_blossom_workspace *w)                                         */
+/*    SAME as CCtsp_exactblossom_work, but the Gomory-Hu trees are kept     */
+/*     in w, and the next call with the same ncount, ecount, elist and      */
+/*     params updates them rather than building them again.                 */
+/*     -chcount, chlist are the edges whose x changed since the last call   */
+/*      to CCtsp_exactblossom_update with w (chcount < 0 means unknown)     */
+/*    NOTES:                                                                */
+/*      The trees are only updated if no listed edge moved across ZEROPLUS  */
+/*      or ONEMINUS (which changes the split graph); otherwise, and with    */
+/*      params->capbits or CCtsp_BLOSSOM_GH_ODDCUT, they are built again.   */
+/*      An updated tree is a Gomory-Hu tree of the new x, but not always    */
+/*      the tree that CCtsp_exactblossom_work would build, so the cuts are  */
+/*      not the same (there are often fewer of them).  The search stays     */
+/*      exact: if x(delta(v)) = 2 at every node, a most violated blossom    */
+/*      is found with either tree.  Otherwise the most violated blossom     */
+/*      can have a handle of 1 or 2 nodes, which is skipped, and the best   */
+/*      cut found depends on the tree, as it does between the ghtree codes. */
+/*                                                                          */
 /****************************************************************************/
 
 /****************************************************************************/
@@ -65,6 +203,7 @@
 
 #include "machdefs.h"
 #include "util.h"
+#include "macrorus.h"
 #include "cut.h"
 #include "tsp.h"
 
@@ -72,13 +211,167 @@
 #define BLOTOLERANCE .01
 #define OTHEREND(e,n) ((e)->ends[0] == (n) ? (e)->ends[1] \
                                            : (e)->ends[0])
+#define BLO_OTHEREND(B,e,n) ((B)->ends[2*(e)] == (n) ? (B)->ends[2*(e)+1] \
+                                                     : (B)->ends[2*(e)])
+#define LRT_FLIPCOST(x) ((x) > 0.5 ? 2.0 * (x) - 1.0 : 1.0 - 2.0 * (x))
+#define BLO_INSIDE(B,W,n,l,h) ((B)->comp[(n)] == (W)->comp &&              \
+                               (B)->pos[(n)] >= (l) && (B)->pos[(n)] < (h))
+#define BLO_STOPPED(W) ((W)->budget && (W)->budget->stop)
+
+#ifdef CC_POSIXTHREADS
+#define BUDGET_LOCK(K)   { if ((K)->lock) pthread_mutex_lock ((K)->lock); }
+#define BUDGET_UNLOCK(K) { if ((K)->lock) pthread_mutex_unlock ((K)->lock); }
+#else
+#define BUDGET_LOCK(K)
+#define BUDGET_UNLOCK(K)
+#endif
+
+/* The graph used by the exact separation.  Nodes 0 to ncount - 1 are the */
+/* nodes of the support graph, the pseudonodes created by splitedge are   */
+/* numbered ncount, ncount + 1, ...; the split edges of pseudonode        */
+/* ncount + k are 2k and 2k + 1 in pends/px.                              */
+/*                                                                        */
+/* comp gives the component of each split node (-1 for support nodes not  */
+/* in the split graph).  The nodes of component c are compnode[compbeg[c] */
+/* to compbeg[c+1]-1], and its edges, numbered locally in that order, are */
+/* ecompbeg[c] to ecompbeg[c+1]-1 in gelist/gecap.  Once the Gomory-Hu    */
+/* tree of c is built, pos gives the place of each of its nodes in the    */
+/* tree's node array.                                                     */
+/*                                                                        */
+/* If trees is not NULL (CCtsp_exactblossom_update), the tree of c is     */
+/* built in trees[c] and kept; with update set, trees[c] holds the tree   */
+/* of the previous call, for the capacities oldcap (in gecap order), and  */
+/* is brought up to date from the edges that changed (listed in chg,      */
+/* also in gecap order).  cur[c] is set once trees[c] fits gecap.         */
+
+typedef struct blograph {
+    int             ncount;
+    int             ecount;
+    int            *ends;
+    double         *x;
+    int             engine;
+    int             ghtree;
+    int             flowalg;
+    double          capscale;
+    int            *adjbeg;
+    int            *adjlist;
+    int            *splitter;
+    int             pcount;
+    int             pspace;
+    int            *oddnode;
+    int            *pends;
+    double         *px;
+    int            *mark;
+    int            *label;
+    int             magicnum;
+    int             ccount;
+    int             maxcomp;
+    int            *comp;
+    int            *compbeg;
+    int            *compnode;
+    int            *ecompbeg;
+    int            *gelist;
+    double         *gecap;
+    int            *pos;
+    int            *stack;
+    CC_GHtree      *trees;
+    double         *oldcap;
+    int            *chg;
+    int            *cur;
+    int             update;
+} blograph;
+
+/* The cut budget of a call (see CCtsp_blossom_workspace).  With maxcuts  */
+/* set, the cuts are kept in a heap of at most maxcuts entries, worst at  */
+/* the top, ordered by violation and then by (comp, seq), the order in    */
+/* which a sequential search meets them, so that ties do not depend on    */
+/* the threads.  B is the support graph used to measure the violations.   */
+
+typedef struct blobudget {
+    int              maxcuts;
+    double           minviol;
+    int              kspace;
+    int              count;
+    volatile int     stop;
+    CCtsp_lpcut_in **cut;
+    double          *viol;
+    int             *comp;
+    int             *seq;
+    blograph        *B;
+#ifdef CC_POSIXTHREADS
+    pthread_mutex_t *lock;
+#endif
+} blobudget;
+
+/* The state CCtsp_exactblossom_update keeps between calls: the x of the  */
+/* last call (ecount entries), the capacities of its split graph (capcount */
+/* entries, in gecap order), and the Gomory-Hu trees of its ccount        */
+/* components.  valid is 0 until a call has finished with it.  The arrays */
+/* are sized on their own, apart from the rest of the workspace.          */
+
+typedef struct blokeep {
+    int              valid;
+    int              ncount;
+    int              ecount;
+    int              engine;
+    int              ghtree;
+    int              flowalg;
+    int              ccount;
+    int              capcount;
+    int              xspace;
+    int              cspace;
+    int              tspace;
+    double          *x;
+    double          *cap;
+    int             *chg;
+    int             *cur;
+    CC_GHtree       *trees;
+} blokeep;
+
+/* The work space for searching the cut tree of one component (each      */
+/* thread has its own).  lnode is the inverse of pos; the node array is  */
+/* in DFS order, so the nodes below tree node k are lo[k] <= pos < hi[k]. */
+/* origpre and isopre are prefix sums over the node array of the support  */
+/* nodes and of their 1-edges to nodes outside of the component.  budget  */
+/* is NULL unless the call has a cut budget; seq numbers the blossoms of  */
+/* the current component for it, and hmark (all 0 between uses) marks a   */
+/* handle while its violation is measured.  ghthreads is the number of    */
+/* threads CCcut_gomory_hu_threaded may use for the current component.    */
+
+typedef struct blowork {
+    int             comp;
+    int             gncount;
+    int            *marks;
+    int            *lnode;
+    int            *lo;
+    int            *hi;
+    int            *origpre;
+    int            *isopre;
+    int            *hlist;
+    int            *tedge;
+    int            *work;
+    int            *hbuf;
+    struct toothobj *tlist;
+    struct toothobj *tbuf;
+    struct blobudget *budget;
+    int             seq;
+    int            *hmark;
+    int             ghthreads;
+} blowork;
+
+/* The pass_param of oddcut_blossom: the component being searched.        */
+
+typedef struct blooddcut {
+    blograph        *B;
+    blowork         *W;
+    int             *names;
+    CCtsp_lpcut_in **cuts;
+    int             *cutcount;
+} blooddcut;
 
 typedef struct edge {
     struct node    *ends[2];
-    struct node    *splitter;
     double          x;
-    int             magiclabel;
-    struct edge    *next;
 } edge;
 
 typedef struct edgeptr {
@@ -89,11 +382,7 @@ typedef struct edgeptr {
 typedef struct node {
     edgeptr        *adj;
     int             magiclabel;
-    struct node    *next, *prev;
-    struct node    *oddnode;
-    edge           *pe;
     int             mark;
-    int             num;
     int             name;
 } node;
 
@@ -107,14 +396,14 @@ typedef struct graph {
     node           *nodelist;
     int             ecount;
     edge           *edgelist;
-    node           *pseudonodelist;
-    edge           *pseudoedgelist;
     int             magicnum;
-    node            pseudonodedummy;
-    edge            pseudoedgedummy;
-    CCptrworld      edge_world;
+    node          **stack;
+    edgeptr       **scan;
+    struct edge   **tlist;
+    double         *xtlist;
+    int            *tperm;
+    blowork        *W;
     CCptrworld      edgeptr_world;
-    CCptrworld      node_world;
     CCptrworld      nodeptr_world;
 } graph;
 
@@ -123,73 +412,285 @@ typedef struct toothobj {
     int  out;
 } toothobj;
 
-CC_PTRWORLD_ROUTINES (edge, edgealloc, edge_bulkalloc, edgefree)
-CC_PTRWORLD_LEAKS_ROUTINE (edge, edge_check_leaks, x, double)
+#ifdef CC_POSIXTHREADS
+typedef struct blosearch_args {
+    blograph        *B;
+    blowork         *W;
+    CCrandstate     *crstate;
+    CCtsp_lpcut_in **compcuts;
+    int             *compcount;
+    int             *order;
+    int             *next;
+    pthread_mutex_t *lock;
+    int              rval;
+} blosearch_args;
+#endif
+
+/* The scratch space of the threshold sweep.  Slots 2e and 2e+1 stand    */
+/* for the two ends of support edge e.  Each union-find root c keeps the  */
+/* slots of its nodes in the list sfirst[c], snext[...] (slen[c] entries, */
+/* ending at slast[c]) and its nodes in nfirst[c], nnext[...]; size, z    */
+/* (the x-weight of the edges inside), and hc/hs (the number and x-sum of */
+/* the x > 0.5 edges leaving) describe the component.  An edge gets its   */
+/* inside flag once both of its ends are in one component.                */
+
+typedef struct blosweep {
+    int             *perm;
+    int             *inside;
+    int             *snext;
+    int             *sfirst;
+    int             *slast;
+    int             *slen;
+    int             *nfirst;
+    int             *nnext;
+    int             *nlast;
+    int             *parent;
+    int             *size;
+    int             *hc;
+    double          *hs;
+    double          *z;
+} blosweep;
+
+/* The buffers of a CCtsp_blossom_workspace.  They fit nspace nodes,      */
+/* aspace edges with x >= ZEROPLUS, and wcount threads.  selist/sx hold   */
+/* the secount support edges of the current call (see load_support); W   */
+/* holds one blowork per thread (W[0] is also used by the heuristics, in  */
+/* G).  The other arrays are the scratch space of the build routines and  */
+/* the per-component results of the exact search (there are at most      */
+/* nspace components).                                                    */
+
+typedef struct CCtsp_blospace {
+    int              nspace;
+    int              aspace;
+    int              wcount;
+    int              secount;
+    int             *selist;
+    double          *sx;
+    blograph         B;
+    int             *num;
+    int             *names;
+    int             *beg;
+    int             *tends;
+    double          *tcap;
+    int             *parent;
+    int             *lnum;
+    CCtsp_lpcut_in **compcuts;
+    int             *compcount;
+    CCrandstate     *crstate;
+    int             *order;
+    int             *csize;
+    blowork         *W;
+#ifdef CC_POSIXTHREADS
+    blosearch_args  *args;
+    pthread_t       *thread_id;
+#endif
+    graph            G;
+    blosweep         P;
+    blobudget        K;
+    blokeep          Q;
+} blospace;
 
 CC_PTRWORLD_LIST_ROUTINES (edgeptr, edge *, edgeptralloc, edgeptr_bulkalloc,
         edgeptrfree, edgeptr_listadd, edgeptr_listfree)
 CC_PTRWORLD_LEAKS_ROUTINE (edgeptr, edgeptr_check_leaks, this, edge *)
 
-CC_PTRWORLD_ROUTINES (node, nodealloc, node_bulkalloc, nodefree)
-CC_PTRWORLD_LEAKS_ROUTINE (node, node_check_leaks, name, int)
-
 CC_PTRWORLD_LIST_ROUTINES (nodeptr, node *, nodeptralloc, nodeptr_bulkalloc,
         nodeptrfree, nodeptr_listadd, nodeptr_listfree)
 CC_PTRWORLD_LEAKS_ROUTINE (nodeptr, nodeptr_check_leaks, this, node *)
 
 
 static void
+#ifdef CC_POSIXTHREADS
+   *search_components_thread (void *args),
+#endif
     blolink_init (graph *G),
     blolink_free (graph *G),
-    removedegreezero (graph *G),
-    splitem (graph *G, node *n),
-    splitedge (graph *G, edge *e, node *n),
-    destroysplitgraph (graph *G),
-    free_adj (graph *G),
-    freesplitedges (graph *G),
-    freesplitters (graph *G),
-    markcuttree_cut (CC_GHnode *n, int v, node **names),
+    splitem (blograph *B, int n),
+    splitedge (blograph *B, int e, int n),
+    init_blograph (blograph *B),
+    free_blograph (blograph *B),
+    init_blowork (blowork *W),
+    free_blowork (blowork *W),
+    init_blospace (blospace *S),
+    free_blospace (blospace *S),
+    init_blosweep (blosweep *P),
+    free_blosweep (blosweep *P),
+    sweep_merge (blosweep *P, int *elist, double *x, int a, int b),
+    init_blobudget (blobudget *K),
+    init_blokeep (blokeep *Q),
+    free_blokeep (blokeep *Q),
+    drop_trees (blokeep *Q),
+    keep_trees (blokeep *Q, blograph *B, int ncount, int ecount, double *x,
+        CCtsp_blossomparams *params),
+    free_blobudget (blobudget *K),
+    budget_swap (blobudget *K, int i, int j),
+    budget_siftdown (blobudget *K, int i),
+    start_budget (blospace *S, CCtsp_blossom_workspace *w),
+    finish_budget (blospace *S, CCtsp_lpcut_in **cuts, int *cutcount),
+    budget_support (blospace *S, int ncount),
+    budget_insert (blobudget *K, CCtsp_lpcut_in *lc, double viol, int comp,
+        int seq),
+    load_support (blospace *S, int ecount, int *elist, double *x),
+    build_blograph (blograph *B, int ncount, int ecount, int *elist,
+        double *x),
+    build_splitgraph (blospace *S),
+    build_lrtgraph (blospace *S),
+    build_components (blospace *S, int k, int gecount),
+    label_cuttree (blograph *B, blowork *W, CC_GHtree *T, int *names),
+    label_oddcut (blograph *B, blowork *W, int *names, int count, int *cut),
+    label_prefix (blograph *B, blowork *W),
+    free_cutlist (CCtsp_lpcut_in *c),
     initgraph (graph *G),
-    freegraph (graph *G);
+    cleargraph (graph *G),
+    sort_components (blospace *S);
 
 static int
-    buildadj_from_pseudoedgelist (graph *G),
-    searchtree (graph *G, CC_GHnode *n, node **names, CCtsp_lpcut_in **cuts,
-        int *cutcount),
-    loadcuttree_blossom (graph *G, int v, CCtsp_lpcut_in **cuts,
+#ifdef CC_POSIXTHREADS
+    search_components_threaded (blospace *S, int nthreads, int first),
+#endif
+    exact_work (CCtsp_lpcut_in **cuts, int *cutcount, int ncount, int ecount,
+        int *elist, double *x, CCrandstate *rstate,
+        CCtsp_blossomparams *params, CCtsp_blossom_workspace *w, int keep,
+        int chcount, int *chlist),
+    blo_class (double x),
+    size_blokeep (blokeep *Q, int ecount, int capcount, int ccount),
+    update_cuttree (blograph *B, int c, CC_GHtree *T, int markcount,
+        int *marks, CCrandstate *rstate),
+    size_blospace (CCtsp_blossom_workspace *w, int ncount, int ecount,
+        double *x, int wcount),
+    alloc_blospace (blospace *S, int nspace, int aspace, int wcount),
+    blo_find (int *parent, int i),
+    alloc_blowork (blowork *W, int nspace, int aspace),
+    search_components (blospace *S, int nthreads),
+    search_component (blograph *B, blowork *W, int c, CCrandstate *rstate,
+        CCtsp_lpcut_in **cuts, int *cutcount),
+    padberg_rao_component (blograph *B, blowork *W, int c,
+        CCrandstate *rstate, CCtsp_lpcut_in **cuts, int *cutcount),
+    lrt_component (blograph *B, blowork *W, int c, CCrandstate *rstate,
+        CCtsp_lpcut_in **cuts, int *cutcount),
+    build_cuttree (blograph *B, blowork *W, int c, CC_GHtree *T,
+        int markcount, int *marks, CCrandstate *rstate),
+    lrt_blossom (blograph *B, blowork *W, int lo, int hi, double cutval,
+        CCtsp_lpcut_in **cuts, int *cutcount),
+    searchtree (blograph *B, blowork *W, CC_GHtree *T, CCtsp_lpcut_in **cuts,
         int *cutcount),
-    work_blossom (graph *G, nodeptr *handle, int tcount, edgeptr *teeth,
+    search_oddcuts (blograph *B, blowork *W, int c, int markcount,
+        int *names, CCtsp_lpcut_in **cuts, int *cutcount),
+    oddcut_blossom (double cutval, int count, int *cut, void *pass_param),
+    loadcuttree_blossom (blograph *B, blowork *W, int lo, int hi,
+        CCtsp_lpcut_in **cuts, int *cutcount),
+    count_teeth (blograph *B, blowork *W, int lo, int hi, int *teeth),
+    work_blossom (int ncount, int hcount, int *handle, int tcount,
+        toothobj *t, blowork *W, CCtsp_lpcut_in **cuts, int *cutcount),
+    work_blossom_lists (graph *G, nodeptr *handle, int tcount, edgeptr *teeth,
         CCtsp_lpcut_in **cuts, int *cutcount),
-    add_blossom (graph *G, int hcount, int *handle, int tcount,
+    add_blossom (int ncount, int hcount, int *handle, int tcount,
         toothobj *teeth, CCtsp_lpcut_in **cuts, int *cutcount),
-    cuttree_tooth (edge *e, int v),
-    oneend (edge *e, int v),
+    cuttree_tooth (blograph *B, blowork *W, int e, int lo, int hi),
     buildgraph (graph *G, int ncount, int ecount, int *elist, double *x),
     grab_component (graph *G, node *n, int label, nodeptr **comp, double lbd,
         double ubd),
     grow_teeth (graph *G, nodeptr *handle, CCtsp_lpcut_in **cuts, int *cutcount),
-    grow_ghteeth (graph *G, nodeptr *handle, CCtsp_lpcut_in **cuts,
-        int *cutcount);
+    grow_ghteeth (graph *G, nodeptr *handle, double ubd,
+        CCtsp_lpcut_in **cuts, int *cutcount),
+    heur_pass (graph *G, double ubd, int gh, CCtsp_lpcut_in **cuts,
+        int *cutcount),
+    same_ghgraph (graph *G, double *eps, int i),
+    alloc_blosweep (blosweep *P, int nspace, int aspace),
+    sweep_test (blosweep *P, blowork *W, int ncount, int *elist, double *x,
+        int c, CCtsp_lpcut_in **cuts, int *cutcount),
+    size_blobudget (blobudget *K, int maxcuts),
+    budget_beats (blobudget *K, double viol, int comp, int seq, int pos),
+    budget_blossom (int ncount, int hcount, int *handle, int tcount,
+        toothobj *teeth, blowork *W, CCtsp_lpcut_in **cuts, int *cutcount);
+
+static double
+    blossom_violation (blograph *B, blowork *W, int hcount, int *handle,
+        int tcount, toothobj *teeth);
 
 
 #define ONEMINUS 0.999999
 #define ZEROPLUS 0.000001
 
+#define BLO_GHTASKMIN 256     /* smallest component for a threaded GH tree */
+
+
+void CCtsp_init_blossomparams (CCtsp_blossomparams *p)
+{
+    p->engine   = CCtsp_BLOSSOM_PADBERG_RAO;
+    p->nthreads = 0;
+    p->ghtree   = CCtsp_BLOSSOM_GH_SHRINK;
+    p->flowalg  = CC_FLOW_HIGHEST_LABEL;
+    p->capbits  = 0;
+}
 
 int CCtsp_exactblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
         int ecount, int *elist, double *x, CCrandstate *rstate)
 {
-    int i, k;
-    node *n;
-    edge *e;
-    edgeptr *ep;
-    CC_GHtree T;
-    int gncount, gecount, markcount;
-    int    *marks  = (int *) NULL;
-    int    *gelist = (int *) NULL;
-    node **names  = (node **) NULL;
-    double *gecap  = (double *) NULL;
-    graph G;
+    CCtsp_blossomparams params;
+
+    CCtsp_init_blossomparams (&params);
+    return CCtsp_exactblossom_params (cuts, cutcount, ncount, ecount, elist,
+                                      x, rstate, &params);
+}
+
+int CCtsp_exactblossom_threaded (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x, CCrandstate *rstate,
+        int nthreads)
+{
+    CCtsp_blossomparams params;
+
+    CCtsp_init_blossomparams (&params);
+    params.nthreads = nthreads;
+    return CCtsp_exactblossom_params (cuts, cutcount, ncount, ecount, elist,
+                                      x, rstate, &params);
+}
+
+int CCtsp_exactblossom_params (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x, CCrandstate *rstate,
+        CCtsp_blossomparams *params)
+{
+    CCtsp_blossom_workspace w;
+    int rval;
+
+    CCtsp_init_blossom_workspace (&w);
+    rval = CCtsp_exactblossom_work (cuts, cutcount, ncount, ecount, elist, x,
+                                    rstate, params, &w);
+    CCtsp_free_blossom_workspace (&w);
+    return rval;
+}
+
+int CCtsp_exactblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x, CCrandstate *rstate,
+        CCtsp_blossomparams *params, CCtsp_blossom_workspace *w)
+{
+    return exact_work (cuts, cutcount, ncount, ecount, elist, x, rstate,
+                       params, w, 0, 0, (int *) NULL);
+}
+
+int CCtsp_exactblossom_update (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x, int chcount,
+        int *chlist, CCrandstate *rstate, CCtsp_blossomparams *params,
+        CCtsp_blossom_workspace *w)
+{
+    return exact_work (cuts, cutcount, ncount, ecount, elist, x, rstate,
+                       params, w, 1, chcount, chlist);
+}
+
+/* exact_work is CCtsp_exactblossom_work, and with keep set it is         */
+/* CCtsp_exactblossom_update: the trees are kept in S->Q and, if nothing  */
+/* but the capacities changed since the last call, updated.               */
+
+static int exact_work (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
+        int ecount, int *elist, double *x, CCrandstate *rstate,
+        CCtsp_blossomparams *params, CCtsp_blossom_workspace *w, int keep,
+        int chcount, int *chlist)
+{
+    int i, e, c, ccount = 0, capcount, reuse = 0;
+    blospace *S = (blospace *) NULL;
+    blograph *B;
+    blokeep *Q = (blokeep *) NULL;
+    CCtsp_lpcut_in *lc;
     int rval = 0;
 
 /*
@@ -198,449 +699,1708 @@ int CCtsp_exactblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
 */
 
     *cutcount = 0;
-    CCcut_GHtreeinit (&T);
-    initgraph (&G);
-    blolink_init (&G);
 
-    rval = buildgraph (&G, ncount, ecount, elist, x);
-    if (rval) {
-        fprintf (stderr, "buildgraph failed\n"); goto CLEANUP;
+    if (params->engine != CCtsp_BLOSSOM_PADBERG_RAO &&
+        params->engine != CCtsp_BLOSSOM_LRT) {
+        fprintf (stderr, "unknown blossom engine %d\n", params->engine);
+        rval = 1; goto CLEANUP;
+    }
+    if (params->ghtree != CCtsp_BLOSSOM_GH_SHRINK &&
+        params->ghtree != CCtsp_BLOSSOM_GH_GUSFIELD &&
+        params->ghtree != CCtsp_BLOSSOM_GH_THREADED &&
+        params->ghtree != CCtsp_BLOSSOM_GH_ODDCUT) {
+        fprintf (stderr, "unknown Gomory-Hu code %d\n", params->ghtree);
+        rval = 1; goto CLEANUP;
+    }
+    if (params->flowalg != CC_FLOW_HIGHEST_LABEL &&
+        params->flowalg != CC_FLOW_FIFO &&
+        params->flowalg != CC_FLOW_PSEUDOFLOW &&
+        params->flowalg != CC_FLOW_BK) {
+        fprintf (stderr, "unknown flow code %d\n", params->flowalg);
+        rval = 1; goto CLEANUP;
+    }
+    if (params->capbits != 0 && params->capbits != 32 &&
+        params->capbits != 64) {
+        fprintf (stderr, "bad capacity size %d\n", params->capbits);
+        rval = 1; goto CLEANUP;
     }
 
-    for (i = G.ecount, e = G.edgelist; i; i--, e++) {
-        if (e->x > ONEMINUS) {
-            e->splitter = G.nodelist;     /* just to kill the edge */
-            e->ends[0]->mark = 1 - e->ends[0]->mark;
-            e->ends[1]->mark = 1 - e->ends[1]->mark;
-        } else if (e->x < ZEROPLUS) {
-            e->splitter = G.nodelist;
-        } else {
-            e->splitter = (node *) NULL;
-        }
+    rval = size_blospace (w, ncount, ecount, x, params->nthreads);
+    if (rval) {
+        fprintf (stderr, "size_blospace failed\n"); goto CLEANUP;
     }
+    S = w->space;
+    B = &S->B;
 
-    G.pseudoedgelist = &G.pseudoedgedummy;
-    G.pseudoedgelist->next = (edge *) NULL;
+    /* the split graph only depends on which edges are 0, 1 or between, */
+    /* so the trees can be updated if none of the changed edges moved    */
 
-    G.magicnum++;
-    for (n = G.pseudonodelist->next; n; n = n->next) {
-        if (n->magiclabel != G.magicnum) {
-            splitem (&G, n);
+    if (keep) {
+        Q = &S->Q;
+        if (params->capbits || params->ghtree == CCtsp_BLOSSOM_GH_ODDCUT) {
+            keep = 0;
+        }
+        reuse = (keep && Q->valid && chcount >= 0 && Q->ncount == ncount &&
+                 Q->ecount == ecount && Q->engine == params->engine &&
+                 Q->ghtree == params->ghtree &&
+                 Q->flowalg == params->flowalg);
+        for (i = 0; reuse && i < chcount; i++) {
+            e = chlist[i];
+            if (blo_class (Q->x[e]) != blo_class (x[e])) reuse = 0;
+        }
+        Q->valid = 0;
+    } else {
+        S->Q.valid = 0;
+    }
+
+    load_support (S, ecount, elist, x);
+    build_blograph (B, ncount, S->secount, S->selist, S->sx);
+    B->engine = params->engine;
+    B->ghtree = params->ghtree;
+    B->flowalg = params->flowalg;
+    B->capscale = 0.0;
+    B->trees  = (CC_GHtree *) NULL;
+    B->oldcap = (double *) NULL;
+    B->chg    = (int *) NULL;
+    B->cur    = (int *) NULL;
+    B->update = 0;
+
+    if (B->engine == CCtsp_BLOSSOM_LRT) {
+        build_lrtgraph (S);
+    } else {
+        for (e = 0; e < B->ecount; e++) {
+            if (B->x[e] > ONEMINUS) {
+                B->mark[B->ends[2*e]]   = 1 - B->mark[B->ends[2*e]];
+                B->mark[B->ends[2*e+1]] = 1 - B->mark[B->ends[2*e+1]];
+            }
         }
-    }
-
-    free_adj (&G);
-    rval = buildadj_from_pseudoedgelist (&G);
-    if (rval) goto CLEANUP;
-    
-    removedegreezero (&G);
 
-    gncount = 0;
-    gecount = 0;
-    markcount = 0;
-    for (n = G.pseudonodelist->next; n; n = n->next) {
-        for (ep = n->adj; ep; ep = ep->next) {
-            ep->this->magiclabel = 0;
-            gecount++;
+        B->magicnum++;
+        for (i = 0; i < ncount; i++) {
+            if (B->label[i] != B->magicnum) {
+                splitem (B, i);
+            }
         }
-        n->num = gncount++;
-        if (n->mark) markcount++;
-    }
-    gecount /= 2;
 
-    if (gecount == 0) {
-        /* printf ("No edges in blossom graph\n");  fflush (stdout); */
-        rval = 0; goto CLEANUP; 
+        build_splitgraph (S);
     }
 
-    names  = CC_SAFE_MALLOC (gncount, node *);
-    gelist = CC_SAFE_MALLOC (2*gecount, int);
-    gecap  = CC_SAFE_MALLOC (gecount, double);
-    if (!names || !gelist || !gecap) {
-        fprintf (stderr, "out of memory in Xblossom\n");
-        rval = 1; goto CLEANUP;
-    }
-    if (markcount) {
-        marks = CC_SAFE_MALLOC (markcount, int);
-        if (!marks) {
-            fprintf (stderr, "out of memory in Xblossom\n");
-            rval = 1; goto CLEANUP;
+    if (Q) {
+        capcount = (B->ccount ? B->ecompbeg[B->ccount] : 0);
+        if (B->ccount != Q->ccount || capcount != Q->capcount) reuse = 0;
+        if (!reuse) drop_trees (Q);
+        if (keep) {
+            rval = size_blokeep (Q, ecount, capcount, B->ccount);
+            if (rval) {
+                fprintf (stderr, "size_blokeep failed\n"); goto CLEANUP;
+            }
+            for (c = 0; c < B->ccount; c++) Q->cur[c] = 0;
+            B->trees  = Q->trees;
+            B->oldcap = Q->cap;
+            B->chg    = Q->chg;
+            B->cur    = Q->cur;
+            B->update = reuse;
         }
     }
 
-    k = 0;
-    markcount = 0;
-    for (i = 0, n = G.pseudonodelist->next; n; n = n->next, i++) {
-        names[i] = n;
-        for (ep = n->adj; ep; ep = ep->next) {
-            if (ep->this->magiclabel == 0) {
-                gelist[2*k]     = ep->this->ends[0]->num;
-                gelist[2*k + 1] = ep->this->ends[1]->num;
-                gecap[k]        = ep->this->x;
-                k++;
-                ep->this->magiclabel = 1;
-            }
-        }
-        if (n->mark) marks[markcount++] = n->num;
+    if (B->ccount == 0) {
+        /* printf ("No edges in blossom graph\n");  fflush (stdout); */
+        if (B->trees) keep_trees (Q, B, ncount, ecount, x, params);
+        rval = 0; goto CLEANUP;
     }
 
-    if (markcount > 0) {
-        rval = CCcut_gomory_hu (&T, gncount, gecount, gelist, gecap, 
-                                markcount, marks, rstate);
+    if (params->capbits) {
+        rval = CCcut_scale_capacities (B->ecompbeg[B->ccount], B->gecap,
+                                       B->gecap, params->capbits,
+                                       &B->capscale);
         if (rval) {
-            fprintf (stderr, "CCcut_gomory_hu failed\n"); goto CLEANUP;
+            fprintf (stderr, "CCcut_scale_capacities failed\n"); goto CLEANUP;
         }
     }
 
-    CC_IFFREE (marks, int);
-    CC_IFFREE (gelist, int);
-    CC_IFFREE (gecap, double);
+    /* the seeds are drawn in component order, whatever nthreads is */
 
-    if (T.root) {
-        rval = searchtree (&G, T.root, names, cuts, cutcount);
-        if (rval) {
-            fprintf (stderr, "searchtree failed\n"); goto CLEANUP;
+    ccount = B->ccount;
+    for (c = 0; c < ccount; c++) {
+        S->compcuts[c]  = (CCtsp_lpcut_in *) NULL;
+        S->compcount[c] = 0;
+        CCutil_sprand (CCutil_lprand (rstate), &S->crstate[c]);
+    }
+
+    start_budget (S, w);
+    rval = search_components (S, params->nthreads);
+    if (rval) {
+        fprintf (stderr, "search_components failed\n"); goto CLEANUP;
+    }
+    finish_budget (S, cuts, cutcount);
+
+    for (c = 0; c < ccount; c++) {
+        if (S->compcuts[c]) {
+            for (lc = S->compcuts[c]; lc->next; lc = lc->next);
+            lc->next = *cuts;
+            *cuts = S->compcuts[c];
+            S->compcuts[c] = (CCtsp_lpcut_in *) NULL;
+            *cutcount += S->compcount[c];
         }
     }
 
+    if (B->trees) keep_trees (Q, B, ncount, ecount, x, params);
+
 CLEANUP:
 
-    CCcut_GHtreefree (&T);
-    destroysplitgraph (&G);
-    freegraph (&G);
-    blolink_free (&G);
+    for (c = 0; c < ccount; c++) {
+        free_cutlist (S->compcuts[c]);
+        S->compcuts[c] = (CCtsp_lpcut_in *) NULL;
+    }
+    if (rval && S) finish_budget (S, (CCtsp_lpcut_in **) NULL, (int *) NULL);
+    return rval;
+}
 
-    CC_IFFREE (marks, int);
-    CC_IFFREE (gelist, int);
-    CC_IFFREE (gecap, double);
-    CC_IFFREE (names, node *);
+void CCtsp_init_blossom_workspace (CCtsp_blossom_workspace *w)
+{
+    w->space   = (blospace *) NULL;
+    w->maxcuts = 0;
+    w->minviol = 0.0;
+}
 
-    return rval;
+void CCtsp_free_blossom_workspace (CCtsp_blossom_workspace *w)
+{
+    if (w->space) {
+        free_blospace (w->space);
+        free_blobudget (&w->space->K);
+        free_blokeep (&w->space->Q);
+        blolink_free (&w->space->G);
+        CC_FREE (w->space, blospace);
+    }
 }
 
-static void blolink_init (graph *G)
+static int blo_class (double x)
 {
-    CCptrworld_init (&G->edge_world);
-    CCptrworld_init (&G->edgeptr_world);
-    CCptrworld_init (&G->node_world);
-    CCptrworld_init (&G->nodeptr_world);
+    return (x < ZEROPLUS ? 0 : (x > ONEMINUS ? 2 : 1));
 }
 
-static void blolink_free (graph *G)
+static void init_blokeep (blokeep *Q)
 {
-    int total, onlist;
+    Q->valid    = 0;
+    Q->ncount   = 0;
+    Q->ecount   = 0;
+    Q->engine   = 0;
+    Q->ghtree   = 0;
+    Q->flowalg  = 0;
+    Q->ccount   = 0;
+    Q->capcount = 0;
+    Q->xspace   = 0;
+    Q->cspace   = 0;
+    Q->tspace   = 0;
+    Q->x        = (double *) NULL;
+    Q->cap      = (double *) NULL;
+    Q->chg      = (int *) NULL;
+    Q->cur      = (int *) NULL;
+    Q->trees    = (CC_GHtree *) NULL;
+}
 
-    if (edge_check_leaks (&G->edge_world, &total, &onlist)) {
-        fprintf (stderr, "WARNING: %d outstanding BLOSSOM-edges\n",
-                 total - onlist);
-    }
-    CCptrworld_delete (&G->edge_world);
+static void free_blokeep (blokeep *Q)
+{
+    drop_trees (Q);
+    CC_IFFREE (Q->x, double);
+    CC_IFFREE (Q->cap, double);
+    CC_IFFREE (Q->chg, int);
+    CC_IFFREE (Q->cur, int);
+    CC_IFFREE (Q->trees, CC_GHtree);
+    init_blokeep (Q);
+}
 
-    if (edgeptr_check_leaks (&G->edgeptr_world, &total, &onlist)) {
-        fprintf (stderr, "WARNING: %d outstanding BLOSSOM-edgeptrs\n",
-                 total - onlist);
-    }
-    CCptrworld_delete (&G->edgeptr_world);
+/* drop_trees frees the kept trees (leaving the space for them).         */
 
-    if (node_check_leaks (&G->node_world, &total, &onlist)) {
-        fprintf (stderr, "WARNING: %d outstanding BLOSSOM-nodes\n",
-                 total - onlist);
-    }
-    CCptrworld_delete (&G->node_world);
+static void drop_trees (blokeep *Q)
+{
+    int c;
 
-    if (nodeptr_check_leaks (&G->nodeptr_world, &total, &onlist)) {
-        fprintf (stderr, "WARNING: %d outstanding BLOSSOM-nodeptrs\n",
-                 total - onlist);
+    for (c = 0; c < Q->tspace; c++) {
+        CCcut_GHtreefree (&Q->trees[c]);
+        CCcut_GHtreeinit (&Q->trees[c]);
     }
-    CCptrworld_delete (&G->nodeptr_world);
+    Q->valid    = 0;
+    Q->ccount   = 0;
+    Q->capcount = 0;
 }
 
-static int buildadj_from_pseudoedgelist (graph *G)
-{
-    edge *e;
-    int rval;
+/* size_blokeep makes room for ecount values of x, capcount capacities   */
+/* and ccount trees.  The trees are only moved when none are held.       */
 
-    for (e = G->pseudoedgelist->next; e; e = e->next) {
-        rval = edgeptr_listadd (&(e->ends[0]->adj), e, &G->edgeptr_world);
-        if (rval) return rval;
-        rval = edgeptr_listadd (&(e->ends[1]->adj), e, &G->edgeptr_world);
-        if (rval) return rval;
+static int size_blokeep (blokeep *Q, int ecount, int capcount, int ccount)
+{
+    int c;
+
+    if (ecount > Q->xspace) {
+        CC_IFFREE (Q->x, double);
+        Q->xspace = 0;
+        Q->x = CC_SAFE_MALLOC (ecount, double);
+        if (!Q->x) {
+            fprintf (stderr, "out of memory in size_blokeep\n");
+            return 1;
+        }
+        Q->xspace = ecount;
+    }
+    if (capcount > Q->cspace) {
+        CC_IFFREE (Q->cap, double);
+        CC_IFFREE (Q->chg, int);
+        Q->cspace = 0;
+        Q->cap = CC_SAFE_MALLOC (capcount, double);
+        Q->chg = CC_SAFE_MALLOC (capcount, int);
+        if (!Q->cap || !Q->chg) {
+            fprintf (stderr, "out of memory in size_blokeep\n");
+            return 1;
+        }
+        Q->cspace = capcount;
+    }
+    if (ccount > Q->tspace) {
+        drop_trees (Q);
+        CC_IFFREE (Q->trees, CC_GHtree);
+        CC_IFFREE (Q->cur, int);
+        Q->tspace = 0;
+        Q->trees = CC_SAFE_MALLOC (ccount, CC_GHtree);
+        Q->cur   = CC_SAFE_MALLOC (ccount, int);
+        if (!Q->trees || !Q->cur) {
+            fprintf (stderr, "out of memory in size_blokeep\n");
+            return 1;
+        }
+        for (c = 0; c < ccount; c++) CCcut_GHtreeinit (&Q->trees[c]);
+        Q->tspace = ccount;
     }
     return 0;
 }
 
-static void removedegreezero (graph *G)
-{
-    node *n;
+/* keep_trees records the call in Q.  A tree that was not brought up to  */
+/* date (the search stopped early) is dropped, to be built again.        */
 
-    for (n = G->pseudonodelist->next; n; n = n->next) {
-        if (n->adj == (edgeptr *) NULL) {
-            if (n->next != (node *) NULL) {
-                n->next->prev = n->prev;
-                n->prev->next = n->next;
-            } else {
-                n->prev->next = (node *) NULL;
-            }
+static void keep_trees (blokeep *Q, blograph *B, int ncount, int ecount,
+        double *x, CCtsp_blossomparams *params)
+{
+    int c, e;
+
+    Q->ccount   = B->ccount;
+    Q->capcount = (B->ccount ? B->ecompbeg[B->ccount] : 0);
+    for (c = 0; c < Q->ccount; c++) {
+        if (!Q->cur[c]) {
+            CCcut_GHtreefree (&Q->trees[c]);
+            CCcut_GHtreeinit (&Q->trees[c]);
         }
     }
+    for (e = 0; e < Q->capcount; e++) Q->cap[e] = B->gecap[e];
+    for (e = 0; e < ecount; e++) Q->x[e] = x[e];
+    Q->ncount  = ncount;
+    Q->ecount  = ecount;
+    Q->engine  = params->engine;
+    Q->ghtree  = params->ghtree;
+    Q->flowalg = params->flowalg;
+    Q->valid   = 1;
 }
 
-static void splitem (graph *G, node *n)
+static void init_blospace (blospace *S)
 {
-    edgeptr *ep;
-    edge *e, *last;
-    node *child;
+    S->nspace    = 0;
+    S->aspace    = 0;
+    S->wcount    = 0;
+    S->secount   = 0;
+    S->selist    = (int *) NULL;
+    S->sx        = (double *) NULL;
+    init_blograph (&S->B);
+    S->num       = (int *) NULL;
+    S->names     = (int *) NULL;
+    S->beg       = (int *) NULL;
+    S->tends     = (int *) NULL;
+    S->tcap      = (double *) NULL;
+    S->parent    = (int *) NULL;
+    S->lnum      = (int *) NULL;
+    S->compcuts  = (CCtsp_lpcut_in **) NULL;
+    S->compcount = (int *) NULL;
+    S->crstate   = (CCrandstate *) NULL;
+    S->order     = (int *) NULL;
+    S->csize     = (int *) NULL;
+    S->W         = (blowork *) NULL;
+#ifdef CC_POSIXTHREADS
+    S->args      = (blosearch_args *) NULL;
+    S->thread_id = (pthread_t *) NULL;
+#endif
+    initgraph (&S->G);
+    blolink_init (&S->G);
+    init_blosweep (&S->P);
+    init_blobudget (&S->K);
+    init_blokeep (&S->Q);
+}
 
-    n->magiclabel = G->magicnum;
-    for (ep = n->adj; ep; ep = ep->next) {
-        e = ep->this;
-        if (!e->splitter) {
-            child = OTHEREND (e, n);
-            if (child->magiclabel != G->magicnum)
-                splitem (G, child);
-        }
-    }
-    for (ep = n->adj, last = (edge *) NULL; ep; ep = ep->next) {
-        e = ep->this;
-        if (!e->splitter) {
-            if (last)
-                splitedge (G, last, n);
-            last = e;
-        }
-    }
+/* free_blospace frees the buffers but not the pointer worlds of S->G,    */
+/* which keep their free lists from one call to the next, or the heap of  */
+/* S->K, which is sized on its own.                                       */
 
-    if (last) {
-        if (n->mark)
-            splitedge (G, last, n);
-        else
-            splitedge (G, last, OTHEREND (last, n));
-    }
+static void free_blospace (blospace *S)
+{
+    int i;
+
+    CC_IFFREE (S->selist, int);
+    CC_IFFREE (S->sx, double);
+    free_blograph (&S->B);
+    CC_IFFREE (S->num, int);
+    CC_IFFREE (S->names, int);
+    CC_IFFREE (S->beg, int);
+    CC_IFFREE (S->tends, int);
+    CC_IFFREE (S->tcap, double);
+    CC_IFFREE (S->parent, int);
+    CC_IFFREE (S->lnum, int);
+    CC_IFFREE (S->compcuts, CCtsp_lpcut_in *);
+    CC_IFFREE (S->compcount, int);
+    CC_IFFREE (S->crstate, CCrandstate);
+    CC_IFFREE (S->order, int);
+    CC_IFFREE (S->csize, int);
+    if (S->W) {
+        for (i = 0; i < S->wcount; i++) free_blowork (&S->W[i]);
+        CC_FREE (S->W, blowork);
+    }
+#ifdef CC_POSIXTHREADS
+    CC_IFFREE (S->args, blosearch_args);
+    CC_IFFREE (S->thread_id, pthread_t);
+#endif
+    CC_IFFREE (S->G.nodelist, node);
+    CC_IFFREE (S->G.edgelist, edge);
+    CC_IFFREE (S->G.stack, node *);
+    CC_IFFREE (S->G.scan, edgeptr *);
+    CC_IFFREE (S->G.tlist, edge *);
+    CC_IFFREE (S->G.xtlist, double);
+    CC_IFFREE (S->G.tperm, int);
+    S->G.W = (blowork *) NULL;
+    free_blosweep (&S->P);
+
+    S->nspace  = 0;
+    S->aspace  = 0;
+    S->wcount  = 0;
+    S->secount = 0;
 }
 
-static void splitedge (graph *G, edge *e, node *n)
+/* size_blospace makes sure that w fits a problem with ncount nodes and   */
+/* the edges with x >= ZEROPLUS among the ecount entries of x, using      */
+/* wcount threads.  If it does not, all of the buffers are freed and      */
+/* allocated again, large enough for this problem and for every earlier  */
+/* one.                                                                   */
+
+static int size_blospace (CCtsp_blossom_workspace *w, int ncount, int ecount,
+        double *x, int wcount)
 {
-    node *n1;
-    edge *e1;
+    blospace *S = w->space;
+    int e, acount = 0;
+    int rval = 0;
+
+#ifdef CC_POSIXTHREADS
+    if (wcount < 1) wcount = 1;
+#else
+    wcount = 1;
+#endif
 
-    n->mark = 1 - n->mark;
+    for (e = 0; e < ecount; e++) {
+        if (x[e] >= ZEROPLUS) acount++;
+    }
 
-    n1 = nodealloc (&G->node_world);
-    n1->magiclabel = 0;
-    e->splitter = n1;
-    n1->pe = e;
-    n1->oddnode = n;  
-    n1->mark = 1;
-    n1->adj = (edgeptr *) NULL;
+    if (!S) {
+        S = CC_SAFE_MALLOC (1, blospace);
+        CCcheck_NULL (S, "out of memory in size_blospace");
+        init_blospace (S);
+        w->space = S;
+    }
 
-    n1->next = G->pseudonodelist->next;
-    n1->prev = G->pseudonodelist;
-    G->pseudonodelist->next->prev = n1;
-    G->pseudonodelist->next = n1;
+    rval = size_blobudget (&S->K, w->maxcuts);
+    CCcheck_rval (rval, "size_blobudget failed");
 
+    if (ncount <= S->nspace && acount <= S->aspace && wcount <= S->wcount) {
+        goto CLEANUP;
+    }
 
-    e1 = edgealloc (&G->edge_world);
-    e1->ends[0] = n;
-    e1->ends[1] = n1;
-    e1->x = 1.0 - e->x;
-    e1->next = G->pseudoedgelist->next;
-    G->pseudoedgelist->next = e1;
+    if (ncount < S->nspace) ncount = S->nspace;
+    if (acount < S->aspace) acount = S->aspace;
+    if (wcount < S->wcount) wcount = S->wcount;
 
+    free_blospace (S);
+    rval = alloc_blospace (S, ncount, acount, wcount);
+    CCcheck_rval (rval, "alloc_blospace failed");
 
-    e1 = edgealloc (&G->edge_world);
-    e1->ends[0] = OTHEREND (e, n);
-    e1->ends[1] = n1;
-    e1->x = e->x;
-    e1->next = G->pseudoedgelist->next;
-    G->pseudoedgelist->next = e1;
-}
+CLEANUP:
 
-static void destroysplitgraph (graph *G)
-{
-    free_adj (G);
-    freesplitedges (G);
-    freesplitters (G);
+    return rval;
 }
 
-static void free_adj (graph *G)
+/* load_support copies the edges with x >= ZEROPLUS, in their original    */
+/* order, into S->selist and S->sx (S must have been sized for this x).   */
+/* The nodes keep their names, so the cuts need no translation.           */
+
+static void load_support (blospace *S, int ecount, int *elist, double *x)
 {
-    node *n;
+    int e, k = 0;
 
-    for (n = G->pseudonodelist->next; n; n = n->next) {
-        edgeptr_listfree (&G->edgeptr_world, n->adj);
-        n->adj = (edgeptr *) NULL;
+    for (e = 0; e < ecount; e++) {
+        if (x[e] >= ZEROPLUS) {
+            S->selist[2*k]   = elist[2*e];
+            S->selist[2*k+1] = elist[2*e+1];
+            S->sx[k++] = x[e];
+        }
     }
+    S->secount = k;
 }
 
-static void freesplitedges (graph *G)
+/* The sizes follow from the shape of the graphs: the split graph has at  */
+/* most nspace + aspace nodes and 2*aspace edges, and each component has  */
+/* at least one support node.                                             */
+
+static int alloc_blospace (blospace *S, int nspace, int aspace, int wcount)
 {
-    edge *e, *enext;
+    blograph *B = &S->B;
+    graph *G = &S->G;
+    int i, gspace = nspace + aspace;
+    int rval = 0;
 
-    for (e = G->pseudoedgelist->next; e; e = enext) {
-        enext = e->next;
-        edgefree (&G->edge_world, e);
+    S->selist = CC_SAFE_MALLOC (2*aspace + 1, int);
+    S->sx     = CC_SAFE_MALLOC (aspace + 1, double);
+    if (!S->selist || !S->sx) {
+        fprintf (stderr, "out of memory in alloc_blospace\n");
+        rval = 1; goto CLEANUP;
     }
-}
 
-static void freesplitters (graph *G)
-{
-    node *n, *nnext, *prev;
+    B->adjbeg   = CC_SAFE_MALLOC (nspace + 1, int);
+    B->adjlist  = CC_SAFE_MALLOC (2*aspace + 1, int);
+    B->splitter = CC_SAFE_MALLOC (aspace + 1, int);
+    B->oddnode  = CC_SAFE_MALLOC (aspace + 1, int);
+    B->pends    = CC_SAFE_MALLOC (4*aspace + 1, int);
+    B->px       = CC_SAFE_MALLOC (2*aspace + 1, double);
+    B->mark     = CC_SAFE_MALLOC (gspace + 1, int);
+    B->label    = CC_SAFE_MALLOC (gspace + 1, int);
+    B->comp     = CC_SAFE_MALLOC (gspace + 1, int);
+    B->pos      = CC_SAFE_MALLOC (gspace + 1, int);
+    B->stack    = CC_SAFE_MALLOC (2*nspace + 1, int);
+    B->compbeg  = CC_SAFE_MALLOC (nspace + 1, int);
+    B->compnode = CC_SAFE_MALLOC (gspace + 1, int);
+    B->ecompbeg = CC_SAFE_MALLOC (nspace + 1, int);
+    B->gelist   = CC_SAFE_MALLOC (4*aspace + 1, int);
+    B->gecap    = CC_SAFE_MALLOC (2*aspace + 1, double);
+    if (!B->adjbeg || !B->adjlist || !B->splitter || !B->oddnode ||
+        !B->pends || !B->px || !B->mark || !B->label || !B->comp ||
+        !B->pos || !B->stack || !B->compbeg || !B->compnode ||
+        !B->ecompbeg || !B->gelist || !B->gecap) {
+        fprintf (stderr, "out of memory in alloc_blospace\n");
+        rval = 1; goto CLEANUP;
+    }
 
-    for (n = G->pseudonodelist->next, prev = G->pseudonodelist; n; n = nnext) {
-        nnext = n->next;
-        if (n->pe) {
-            prev->next = nnext;
-            if (nnext) nnext->prev = prev;
-            nodefree (&G->node_world, n);
-        } else {
-            prev = n;
-        }
+    S->num       = CC_SAFE_MALLOC (gspace + 1, int);
+    S->names     = CC_SAFE_MALLOC (gspace + 1, int);
+    S->beg       = CC_SAFE_MALLOC (gspace + 1, int);
+    S->tends     = CC_SAFE_MALLOC (4*aspace + 1, int);
+    S->tcap      = CC_SAFE_MALLOC (2*aspace + 1, double);
+    S->parent    = CC_SAFE_MALLOC (gspace + 1, int);
+    S->lnum      = CC_SAFE_MALLOC (gspace + 1, int);
+    S->compcuts  = CC_SAFE_MALLOC (nspace + 1, CCtsp_lpcut_in *);
+    S->compcount = CC_SAFE_MALLOC (nspace + 1, int);
+    S->crstate   = CC_SAFE_MALLOC (nspace + 1, CCrandstate);
+    S->order     = CC_SAFE_MALLOC (nspace + 1, int);
+    S->csize     = CC_SAFE_MALLOC (nspace + 1, int);
+    if (!S->num || !S->names || !S->beg || !S->tends || !S->tcap ||
+        !S->parent || !S->lnum || !S->compcuts || !S->compcount ||
+        !S->crstate || !S->order || !S->csize) {
+        fprintf (stderr, "out of memory in alloc_blospace\n");
+        rval = 1; goto CLEANUP;
     }
-}
 
-static int searchtree (graph *G, CC_GHnode *n, node **names,
-        CCtsp_lpcut_in **cuts, int *cutcount)
-{
-    CC_GHnode *c;
-    int rval = 0;
+    S->W = CC_SAFE_MALLOC (wcount, blowork);
+    CCcheck_NULL (S->W, "out of memory in alloc_blospace");
+    for (i = 0; i < wcount; i++) init_blowork (&S->W[i]);
+    S->wcount = wcount;
+    for (i = 0; i < wcount; i++) {
+        rval = alloc_blowork (&S->W[i], nspace, aspace);
+        CCcheck_rval (rval, "alloc_blowork failed");
+    }
 
-    if (n->ndescendants % 2 == 1  &&  n->ndescendants > 1  ) {
-        if (n->cutval < 1.0 - BLOTOLERANCE) {
-            G->magicnum++;
-            markcuttree_cut (n, G->magicnum, names);
-            rval = loadcuttree_blossom (G,  G->magicnum, cuts, cutcount);
-            if (rval) {
-                fprintf (stderr, "loadcuttree_blossom failed\n");
-                goto CLEANUP;
-            }
-        }
+#ifdef CC_POSIXTHREADS
+    S->args      = CC_SAFE_MALLOC (wcount, blosearch_args);
+    S->thread_id = CC_SAFE_MALLOC (wcount, pthread_t);
+    if (!S->args || !S->thread_id) {
+        fprintf (stderr, "out of memory in alloc_blospace\n");
+        rval = 1; goto CLEANUP;
     }
-    for (c = n->child; c; c = c->sibling) {
-        rval = searchtree (G, c, names, cuts, cutcount);
-        if (rval) {
-            goto CLEANUP;
-        }
+#endif
+
+    G->nodelist = CC_SAFE_MALLOC (nspace + 1, node);
+    G->edgelist = CC_SAFE_MALLOC (aspace + 1, edge);
+    G->stack    = CC_SAFE_MALLOC (nspace + 1, node *);
+    G->scan     = CC_SAFE_MALLOC (nspace + 1, edgeptr *);
+    G->tlist    = CC_SAFE_MALLOC (aspace + 1, edge *);
+    G->xtlist   = CC_SAFE_MALLOC (aspace + 1, double);
+    G->tperm    = CC_SAFE_MALLOC (aspace + 1, int);
+    if (!G->nodelist || !G->edgelist || !G->stack || !G->scan ||
+        !G->tlist || !G->xtlist || !G->tperm) {
+        fprintf (stderr, "out of memory in alloc_blospace\n");
+        rval = 1; goto CLEANUP;
     }
+    G->W = &S->W[0];
+
+    rval = alloc_blosweep (&S->P, nspace, aspace);
+    CCcheck_rval (rval, "alloc_blosweep failed");
+
+    S->nspace = nspace;
+    S->aspace = aspace;
 
 CLEANUP:
 
+    if (rval) free_blospace (S);
     return rval;
 }
 
-static void markcuttree_cut (CC_GHnode *n, int v, node **names)
+static void init_blograph (blograph *B)
 {
-    CC_GHnode *c;
-    int i;
+    if (B) {
+        B->ncount   = 0;
+        B->ecount   = 0;
+        B->ends     = (int *) NULL;
+        B->x        = (double *) NULL;
+        B->engine   = CCtsp_BLOSSOM_PADBERG_RAO;
+        B->ghtree   = CCtsp_BLOSSOM_GH_SHRINK;
+        B->flowalg  = CC_FLOW_HIGHEST_LABEL;
+        B->capscale = 0.0;
+        B->trees    = (CC_GHtree *) NULL;
+        B->oldcap   = (double *) NULL;
+        B->chg      = (int *) NULL;
+        B->cur      = (int *) NULL;
+        B->update   = 0;
+        B->adjbeg   = (int *) NULL;
+        B->adjlist  = (int *) NULL;
+        B->splitter = (int *) NULL;
+        B->pcount   = 0;
+        B->pspace   = 0;
+        B->oddnode  = (int *) NULL;
+        B->pends    = (int *) NULL;
+        B->px       = (double *) NULL;
+        B->mark     = (int *) NULL;
+        B->label    = (int *) NULL;
+        B->magicnum = 0;
+        B->ccount   = 0;
+        B->maxcomp  = 0;
+        B->comp     = (int *) NULL;
+        B->compbeg  = (int *) NULL;
+        B->compnode = (int *) NULL;
+        B->ecompbeg = (int *) NULL;
+        B->gelist   = (int *) NULL;
+        B->gecap    = (double *) NULL;
+        B->pos      = (int *) NULL;
+        B->stack    = (int *) NULL;
+    }
+}
 
-    for (i = 0; i < n->listcount; i++) {
-        names[n->nlist[i]]->magiclabel = v;
+static void free_blograph (blograph *B)
+{
+    if (B) {
+        CC_IFFREE (B->adjbeg, int);
+        CC_IFFREE (B->adjlist, int);
+        CC_IFFREE (B->splitter, int);
+        CC_IFFREE (B->oddnode, int);
+        CC_IFFREE (B->pends, int);
+        CC_IFFREE (B->px, double);
+        CC_IFFREE (B->mark, int);
+        CC_IFFREE (B->label, int);
+        CC_IFFREE (B->comp, int);
+        CC_IFFREE (B->compbeg, int);
+        CC_IFFREE (B->compnode, int);
+        CC_IFFREE (B->ecompbeg, int);
+        CC_IFFREE (B->gelist, int);
+        CC_IFFREE (B->gecap, double);
+        CC_IFFREE (B->pos, int);
+        CC_IFFREE (B->stack, int);
+        B->ends = (int *) NULL;
+        B->x    = (double *) NULL;
     }
-    for (c = n->child; c; c = c->sibling) markcuttree_cut (c, v, names);
 }
 
-static int loadcuttree_blossom (graph *G, int v, CCtsp_lpcut_in **cuts,
-        int *cutcount)
+/* build_blograph uses elist and x (the support edges from load_support) */
+/* in place; the arrays of B come from alloc_blospace.  The adjacency     */
+/* lists are in decreasing edge order (the order the old linked-list code */
+/* produced).  The 1-edges are only used to find teeth, so splitem sees   */
+/* them as already split (splitter -2).                                   */
+
+static void build_blograph (blograph *B, int ncount, int ecount, int *elist,
+        double *x)
 {
-    int i, rval = 0;
-    edge *e;
-    node *n;
-    nodeptr *handle = (nodeptr *) NULL;
-    edgeptr *teeth  = (edgeptr *) NULL;
-    int tcount = 0;
-    int hcount = 0;
+    int i, e, fcount = 0, nspace;
+
+    B->ncount   = ncount;
+    B->ecount   = ecount;
+    B->ends     = elist;
+    B->x        = x;
+    B->pcount   = 0;
+    B->magicnum = 0;
+    B->ccount   = 0;
+    B->maxcomp  = 0;
+
+    for (e = 0; e < ecount; e++) {
+        if (x[e] <= ONEMINUS) fcount++;
+    }
+    B->pspace = fcount;
+    nspace = ncount + fcount;
+
+    for (i = 0; i <= ncount; i++) B->adjbeg[i] = 0;
+    for (i = 0; i < nspace; i++) {
+        B->mark[i]  = 0;
+        B->label[i] = 0;
+        B->comp[i]  = -1;
+        B->pos[i]   = -1;
+    }
+    for (e = 0; e < ecount; e++) {
+        B->splitter[e] = (x[e] > ONEMINUS ? -2 : -1);
+        B->adjbeg[elist[2*e]]++;
+        B->adjbeg[elist[2*e+1]]++;
+    }
+    for (i = 0; i < ncount; i++) {
+        B->adjbeg[i+1] += B->adjbeg[i];
+    }
+    for (e = 0; e < ecount; e++) {
+        B->adjlist[--B->adjbeg[elist[2*e]]]   = e;
+        B->adjlist[--B->adjbeg[elist[2*e+1]]] = e;
+    }
+}
 
-    for (i = G->ecount, e = G->edgelist; i; i--, e++) {
-        if (oneend (e, v) && cuttree_tooth (e, v)) {
-            rval = edgeptr_listadd (&teeth, e, &G->edgeptr_world);
-            if (rval) goto CLEANUP;
-            tcount++;
+/* splitem is a depth-first search of the 0 < x < 1 edges from n; each   */
+/* node pairs up its unsplit edges once all of its children are done.    */
+/* The search runs on B->stack (node, next adjlist position) rather than */
+/* recursing, so long fractional paths cannot overflow the call stack.   */
+
+static void splitem (blograph *B, int n)
+{
+    int i, e, child = -1, last, top = 0;
+    int *stack = B->stack;
+
+    B->label[n] = B->magicnum;
+    stack[0] = n;
+    stack[1] = B->adjbeg[n];
+
+    while (top >= 0) {
+        n = stack[2*top];
+        for (i = stack[2*top+1]; i < B->adjbeg[n+1]; i++) {
+            e = B->adjlist[i];
+            if (B->splitter[e] == -1) {
+                child = BLO_OTHEREND (B, e, n);
+                if (B->label[child] != B->magicnum) break;
+            }
         }
-    }
-    for (i = G->ncount, n = G->nodelist; i; i--, n++) {
-        if (n->magiclabel == v) {
-            rval = nodeptr_listadd (&handle, n, &G->nodeptr_world);
-            if (rval) goto CLEANUP;
-            hcount++;
+        if (i < B->adjbeg[n+1]) {
+            stack[2*top+1] = i + 1;
+            B->label[child] = B->magicnum;
+            top++;
+            stack[2*top]   = child;
+            stack[2*top+1] = B->adjbeg[child];
+            continue;
         }
-    }
 
-    if (hcount >= 3 && (tcount % 2 == 1)) {
-        rval = work_blossom (G, handle, tcount, teeth, cuts,
-                             cutcount);
-        if (rval) {
-            fprintf (stderr, "work_blossom failed\n"); goto CLEANUP;
+        for (i = B->adjbeg[n], last = -1; i < B->adjbeg[n+1]; i++) {
+            e = B->adjlist[i];
+            if (B->splitter[e] == -1) {
+                if (last != -1)
+                    splitedge (B, last, n);
+                last = e;
+            }
+        }
+
+        if (last != -1) {
+            if (B->mark[n])
+                splitedge (B, last, n);
+            else
+                splitedge (B, last, BLO_OTHEREND (B, last, n));
         }
+        top--;
     }
+}
 
-CLEANUP:
+static void splitedge (blograph *B, int e, int n)
+{
+    int k = B->pcount++;
+    int n1 = B->ncount + k;
 
-    edgeptr_listfree (&G->edgeptr_world, teeth);
-    nodeptr_listfree (&G->nodeptr_world, handle);
+    B->mark[n] = 1 - B->mark[n];
 
-    return rval;
+    B->splitter[e] = n1;
+    B->oddnode[k]  = n;
+    B->mark[n1]    = 1;
+    B->label[n1]   = 0;
+
+    B->pends[4*k]     = n;
+    B->pends[4*k + 1] = n1;
+    B->px[2*k]        = 1.0 - B->x[e];
+
+    B->pends[4*k + 2] = BLO_OTHEREND (B, e, n);
+    B->pends[4*k + 3] = n1;
+    B->px[2*k + 1]    = B->x[e];
 }
 
-static int work_blossom (graph *G, nodeptr *handle, int tcount,
-        edgeptr *teeth, CCtsp_lpcut_in **cuts, int *cutcount)
+/* build_splitgraph numbers the split graph: first the pseudonodes        */
+/* (newest first), then the support nodes that meet a 0<x<1 edge.  The    */
+/* split edges are grouped by their lower-numbered end and listed in      */
+/* creation order within each group.                                      */
+
+static void build_splitgraph (blospace *S)
 {
-    edge *e;
-    edgeptr *ep;
-    nodeptr *np;
-    toothobj *t = (toothobj *) NULL;
-    toothobj *newteeth = (toothobj *) NULL;
-    int i, k, newhcount, newtcount, rval = 0;
-    int *del = (int *) NULL;
-    int *add = (int *) NULL;
-    int *hit = (int *) NULL;
-    int *newhandle = (int *) NULL;
+    blograph *B = &S->B;
+    int i, k, a, b;
+    int pecount = 2 * B->pcount;
+    int *num    = S->num;
+    int *names  = S->names;
+    int *beg    = S->beg;
 
-    /* Clean up intersecting teeth */
+    B->ccount  = 0;
+    B->maxcomp = 0;
+    if (pecount == 0) return;
+
+    for (i = 0; i < B->ncount; i++) num[i] = -1;
+    for (i = 0; i < 2*pecount; i++) num[B->pends[i]] = 0;
 
-    t   = CC_SAFE_MALLOC (tcount, toothobj);
-    hit = CC_SAFE_MALLOC (G->ncount, int);
-    del = CC_SAFE_MALLOC (G->ncount, int);
-    add = CC_SAFE_MALLOC (G->ncount, int);
-    if (!t || !hit || !del || !add) {
-        fprintf (stderr, "out of memory in work_blossom\n");
+    k = 0;
+    for (i = B->pcount - 1; i >= 0; i--) {
+        num[B->ncount + i] = k;
+        names[k++] = B->ncount + i;
+    }
+    for (i = 0; i < B->ncount; i++) {
+        if (num[i] == 0) {
+            num[i] = k;
+            names[k++] = i;
+        }
     }
 
-    G->magicnum++;
-    for (np = handle; np; np = np->next) {
-        np->this->magiclabel = G->magicnum;
+    for (i = 0; i <= k; i++) beg[i] = 0;
+    for (i = 0; i < pecount; i++) {
+        a = num[B->pends[2*i]];
+        b = num[B->pends[2*i+1]];
+        beg[(a < b ? a : b) + 1]++;
     }
-    for (ep = teeth, i = 0; ep; ep = ep->next, i++) {
-        e = ep->this;
-        if (e->ends[0]->magiclabel == e->ends[1]->magiclabel) goto CLEANUP;
-        if (e->ends[0]->magiclabel == G->magicnum) {
-            t[i].in  = e->ends[0]->name;
-            t[i].out = e->ends[1]->name;
+    for (i = 0; i < k; i++) beg[i+1] += beg[i];
+    for (i = 0; i < pecount; i++) {
+        a = num[B->pends[2*i]];
+        b = num[B->pends[2*i+1]];
+        a = beg[a < b ? a : b]++;
+        S->tends[2*a]     = B->pends[2*i];
+        S->tends[2*a + 1] = B->pends[2*i+1];
+        S->tcap[a]        = B->px[i];
+    }
+
+    build_components (S, k, pecount);
+}
+
+/* build_lrtgraph sets up the graph of the Letchford-Reinelt-Theis        */
+/* method: the support nodes that meet a 0<x<1 edge, and the 0<x<1 edges  */
+/* with capacity min(x, 1-x), all in their original order.                */
+
+static void build_lrtgraph (blospace *S)
+{
+    blograph *B = &S->B;
+    int i, e, k = 0, fcount = 0;
+    int *num   = S->num;
+    int *names = S->names;
+
+    B->ccount  = 0;
+    B->maxcomp = 0;
+    if (B->pspace == 0) return;
+
+    for (i = 0; i < B->ncount; i++) num[i] = -1;
+    for (e = 0; e < B->ecount; e++) {
+        if (B->splitter[e] == -1) {
+            num[B->ends[2*e]]   = 0;
+            num[B->ends[2*e+1]] = 0;
+            S->tends[2*fcount]     = B->ends[2*e];
+            S->tends[2*fcount + 1] = B->ends[2*e+1];
+            S->tcap[fcount++] = (B->x[e] < 0.5 ? B->x[e] : 1.0 - B->x[e]);
+        }
+    }
+    for (i = 0; i < B->ncount; i++) {
+        if (num[i] == 0) {
+            num[i] = k;
+            names[k++] = i;
+        }
+    }
+
+    build_components (S, k, fcount);
+}
+
+/* build_components divides the k nodes in S->names (S->num is the       */
+/* inverse) and the gecount edges in S->tends/S->tcap into components     */
+/* (S->beg, S->parent and S->lnum are scratch).  The components are       */
+/* numbered in the order of their first nodes, and the nodes and edges    */
+/* of each component keep their order.                                    */
+
+static void build_components (blospace *S, int k, int gecount)
+{
+    blograph *B = &S->B;
+    int i, a, b, c;
+    int *names  = S->names;
+    int *num    = S->num;
+    int *gends  = S->tends;
+    int *parent = S->parent;
+    int *lnum   = S->lnum;
+    int *beg    = S->beg;
+
+    for (i = 0; i < k; i++) parent[i] = i;
+    for (i = 0; i < gecount; i++) {
+        a = blo_find (parent, num[gends[2*i]]);
+        b = blo_find (parent, num[gends[2*i+1]]);
+        if (a != b) parent[a] = b;
+    }
+
+    for (i = 0; i < k; i++) beg[i] = -1;
+    for (i = 0; i < k; i++) {
+        a = blo_find (parent, i);
+        if (beg[a] == -1) beg[a] = B->ccount++;
+        B->comp[names[i]] = beg[a];
+    }
+
+    for (c = 0; c <= B->ccount; c++) {
+        B->compbeg[c]  = 0;
+        B->ecompbeg[c] = 0;
+    }
+    for (i = 0; i < k; i++) B->compbeg[B->comp[names[i]] + 1]++;
+    for (i = 0; i < gecount; i++) B->ecompbeg[B->comp[gends[2*i]] + 1]++;
+    for (c = 0; c < B->ccount; c++) {
+        if (B->compbeg[c+1] > B->maxcomp) B->maxcomp = B->compbeg[c+1];
+        B->compbeg[c+1]  += B->compbeg[c];
+        B->ecompbeg[c+1] += B->ecompbeg[c];
+    }
+
+    for (c = 0; c < B->ccount; c++) beg[c] = 0;
+    for (i = 0; i < k; i++) {
+        c = B->comp[names[i]];
+        lnum[i] = beg[c]++;
+        B->compnode[B->compbeg[c] + lnum[i]] = names[i];
+    }
+    for (c = 0; c < B->ccount; c++) beg[c] = B->ecompbeg[c];
+    for (i = 0; i < gecount; i++) {
+        c = B->comp[gends[2*i]];
+        b = beg[c]++;
+        B->gelist[2*b]     = lnum[num[gends[2*i]]];
+        B->gelist[2*b + 1] = lnum[num[gends[2*i+1]]];
+        B->gecap[b]        = S->tcap[i];
+    }
+}
+
+static int blo_find (int *parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+static void init_blowork (blowork *W)
+{
+    if (W) {
+        W->comp    = -1;
+        W->gncount = 0;
+        W->marks   = (int *) NULL;
+        W->lnode   = (int *) NULL;
+        W->lo      = (int *) NULL;
+        W->hi      = (int *) NULL;
+        W->origpre = (int *) NULL;
+        W->isopre  = (int *) NULL;
+        W->hlist   = (int *) NULL;
+        W->tedge   = (int *) NULL;
+        W->work    = (int *) NULL;
+        W->hbuf    = (int *) NULL;
+        W->tlist   = (toothobj *) NULL;
+        W->tbuf    = (toothobj *) NULL;
+        W->budget  = (blobudget *) NULL;
+        W->seq     = 0;
+        W->hmark   = (int *) NULL;
+        W->ghthreads = 0;
+    }
+}
+
+static void free_blowork (blowork *W)
+{
+    if (W) {
+        CC_IFFREE (W->marks, int);
+        CC_IFFREE (W->lnode, int);
+        CC_IFFREE (W->lo, int);
+        CC_IFFREE (W->hi, int);
+        CC_IFFREE (W->origpre, int);
+        CC_IFFREE (W->isopre, int);
+        CC_IFFREE (W->hlist, int);
+        CC_IFFREE (W->tedge, int);
+        CC_IFFREE (W->work, int);
+        CC_IFFREE (W->hbuf, int);
+        CC_IFFREE (W->tlist, toothobj);
+        CC_IFFREE (W->tbuf, toothobj);
+        CC_IFFREE (W->hmark, int);
+    }
+}
+
+/* alloc_blowork sizes W for graphs with nspace nodes and aspace edges   */
+/* with x >= ZEROPLUS (so components have at most nspace + aspace nodes). */
+
+static int alloc_blowork (blowork *W, int nspace, int aspace)
+{
+    int i, gspace = nspace + aspace;
+    int rval = 0;
+
+    W->marks   = CC_SAFE_MALLOC (gspace + 1, int);
+    W->lnode   = CC_SAFE_MALLOC (gspace + 1, int);
+    W->lo      = CC_SAFE_MALLOC (gspace + 1, int);
+    W->hi      = CC_SAFE_MALLOC (gspace + 1, int);
+    W->origpre = CC_SAFE_MALLOC (gspace + 1, int);
+    W->isopre  = CC_SAFE_MALLOC (gspace + 1, int);
+    W->hlist   = CC_SAFE_MALLOC (nspace + 1, int);
+    W->tedge   = CC_SAFE_MALLOC (aspace + 1, int);
+    W->work    = CC_SAFE_MALLOC (3*nspace + 1, int);
+    W->hbuf    = CC_SAFE_MALLOC (nspace + 1, int);
+    W->tlist   = CC_SAFE_MALLOC (aspace + 1, toothobj);
+    W->tbuf    = CC_SAFE_MALLOC (aspace + 1, toothobj);
+    W->hmark   = CC_SAFE_MALLOC (nspace + 1, int);
+    if (!W->marks || !W->lnode || !W->lo || !W->hi || !W->origpre ||
+        !W->isopre || !W->hlist || !W->tedge || !W->work || !W->hbuf ||
+        !W->tlist || !W->tbuf || !W->hmark) {
+        fprintf (stderr, "out of memory in alloc_blowork\n");
+        free_blowork (W);
+        rval = 1; goto CLEANUP;
+    }
+    for (i = 0; i < 3*nspace; i++) W->work[i] = 0;
+    for (i = 0; i < nspace; i++) W->hmark[i] = 0;
+
+CLEANUP:
+
+    return rval;
+}
+
+static void free_cutlist (CCtsp_lpcut_in *c)
+{
+    CCtsp_lpcut_in *next;
+
+    while (c) {
+        next = c->next;
+        CCtsp_free_lpcut_in (c);
+        CC_FREE (c, CCtsp_lpcut_in);
+        c = next;
+    }
+}
+
+static int search_components (blospace *S, int nthreads)
+{
+    blograph *B = &S->B;
+    int c, k, first = 0, sorted = 0, rval = 0;
+
+    if (B->ghtree == CCtsp_BLOSSOM_GH_THREADED ||
+        (nthreads > 1 && B->ccount > 1)) {
+        sort_components (S);
+        sorted = 1;
+    }
+
+    /* with threaded trees, the large components go first, one at a time */
+
+    if (B->ghtree == CCtsp_BLOSSOM_GH_THREADED) {
+        for (; first < B->ccount && !BLO_STOPPED (&S->W[0]); first++) {
+            c = S->order[first];
+            if (B->compbeg[c+1] - B->compbeg[c] < BLO_GHTASKMIN) break;
+            S->W[0].ghthreads = nthreads;
+            rval = search_component (B, &S->W[0], c, &S->crstate[c],
+                                     &S->compcuts[c], &S->compcount[c]);
+            S->W[0].ghthreads = 0;
+            if (rval) {
+                fprintf (stderr, "search_component failed\n"); goto CLEANUP;
+            }
+        }
+    }
+
+#ifdef CC_POSIXTHREADS
+    if (nthreads > 1 && B->ccount - first > 1) {
+        return search_components_threaded (S, nthreads, first);
+    }
+#endif
+
+    for (k = first; k < B->ccount && !BLO_STOPPED (&S->W[0]); k++) {
+        c = (sorted ? S->order[k] : k);
+        rval = search_component (B, &S->W[0], c, &S->crstate[c],
+                                 &S->compcuts[c], &S->compcount[c]);
+        if (rval) {
+            fprintf (stderr, "search_component failed\n"); goto CLEANUP;
+        }
+    }
+
+CLEANUP:
+
+    return rval;
+}
+
+/* sort_components lists the components in S->order, largest first */
+
+static void sort_components (blospace *S)
+{
+    blograph *B = &S->B;
+    int i;
+
+    for (i = 0; i < B->ccount; i++) {
+        S->order[i] = i;
+        S->csize[i] = B->compbeg[i] - B->compbeg[i+1];
+    }
+    CCutil_int_perm_quicksort (S->order, S->csize, B->ccount);
+}
+
+#ifdef CC_POSIXTHREADS
+
+/* Each thread takes the next component in order (largest first) until   */
+/* none are left.  The cuts of component c only go to compcuts[c].        */
+
+static void *search_components_thread (void *args)
+{
+    blosearch_args *a = (blosearch_args *) args;
+    blograph *B = a->B;
+    int c, k;
+
+    a->rval = 0;
+    while (a->rval == 0 && !BLO_STOPPED (a->W)) {
+        pthread_mutex_lock (a->lock);
+        k = (*a->next)++;
+        pthread_mutex_unlock (a->lock);
+        if (k >= B->ccount) break;
+        c = a->order[k];
+        a->rval = search_component (B, a->W, c, &a->crstate[c],
+                                    &a->compcuts[c], &a->compcount[c]);
+    }
+    if (a->rval) {
+        pthread_mutex_lock (a->lock);
+        *a->next = B->ccount;
+        pthread_mutex_unlock (a->lock);
+    }
+
+    return a;
+}
+
+static int search_components_threaded (blospace *S, int nthreads, int first)
+{
+    blograph *B = &S->B;
+    blosearch_args *args = S->args;
+    blosearch_args *arval;
+    pthread_t *thread_id = S->thread_id;
+    pthread_attr_t attr;
+    pthread_mutex_t lock;
+    void *thr_rval;
+    int *order = S->order;
+    int i, next = first, started = 0, rval = 0;
+
+    if (nthreads > B->ccount - first) nthreads = B->ccount - first;
+    if (nthreads > S->wcount) nthreads = S->wcount;
+
+    rval = pthread_attr_init (&attr);
+    if (rval) {
+        fprintf (stderr, "pthread_attr_init failed, rval %d\n", rval);
+        rval = 1; goto CLEANUP;
+    }
+
+#ifdef PTHREAD_CREATE_JOINABLE
+    rval = pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_JOINABLE);
+    if (rval) {
+        fprintf (stderr, "pthread_attr_setdetachstate failed, rval %d\n",
+                 rval);
+        rval = 1; goto CLEANUP;
+    }
+#else
+#ifdef PTHREAD_CREATE_UNDETACHED
+    rval = pthread_attr_setdetachstate (&attr, PTHREAD_CREATE_UNDETACHED);
+    if (rval) {
+        fprintf (stderr, "pthread_attr_setdetachstate failed, rval %d\n",
+                 rval);
+        rval = 1; goto CLEANUP;
+    }
+#endif
+#endif
+
+    rval = pthread_mutex_init (&lock, (pthread_mutexattr_t *) NULL);
+    if (rval) {
+        fprintf (stderr, "pthread_mutex_init failed, rval %d\n", rval);
+        rval = 1; goto CLEANUP;
+    }
+    if (S->W[0].budget) S->K.lock = &lock;
+
+    for (i = 0; i < nthreads; i++) {
+        args[i].B         = B;
+        args[i].W         = &S->W[i];
+        args[i].crstate   = S->crstate;
+        args[i].compcuts  = S->compcuts;
+        args[i].compcount = S->compcount;
+        args[i].order     = order;
+        args[i].next      = &next;
+        args[i].lock      = &lock;
+        args[i].rval      = 0;
+        rval = pthread_create (&thread_id[i], &attr, search_components_thread,
+                               &args[i]);
+        if (rval) {
+            fprintf (stderr, "pthread_create failed, rval %d\n", rval);
+            break;
+        }
+        started++;
+    }
+    for (i = 0; i < started; i++) {
+        if (pthread_join (thread_id[i], &thr_rval)) {
+            fprintf (stderr, "pthread_join failed\n");
+            rval = 1; continue;
+        }
+        arval = (blosearch_args *) thr_rval;
+        if (arval->rval) {
+            fprintf (stderr, "search_component thread failed\n");
+            rval = arval->rval;
+        }
+    }
+    S->K.lock = (pthread_mutex_t *) NULL;
+    pthread_mutex_destroy (&lock);
+
+CLEANUP:
+
+    return rval;
+}
+
+#endif /* CC_POSIXTHREADS */
+
+static int search_component (blograph *B, blowork *W, int c,
+        CCrandstate *rstate, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    if (B->engine == CCtsp_BLOSSOM_LRT) {
+        return lrt_component (B, W, c, rstate, cuts, cutcount);
+    } else {
+        return padberg_rao_component (B, W, c, rstate, cuts, cutcount);
+    }
+}
+
+/* padberg_rao_component builds the Gomory-Hu tree over the odd nodes of  */
+/* component c and checks its cuts, or, with CCtsp_BLOSSOM_GH_ODDCUT,     */
+/* checks the odd cuts found by CCcut_odd_cuts.  If c has an odd number   */
+/* of odd nodes, c itself is a cut of value 0 and is checked as well, and */
+/* every cut of c is T-odd, so the tree is built even with ODDCUT.        */
+
+static int padberg_rao_component (blograph *B, blowork *W, int c,
+        CCrandstate *rstate, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    int i, markcount = 0;
+    int gncount = B->compbeg[c+1] - B->compbeg[c];
+    int *names  = B->compnode + B->compbeg[c];
+    CC_GHtree T, *tp;
+    int rval = 0;
+
+    CCcut_GHtreeinit (&T);
+    tp = (B->trees ? &B->trees[c] : &T);
+    W->comp    = c;
+    W->gncount = gncount;
+    W->seq     = 0;
+
+    for (i = 0; i < gncount; i++) {
+        if (B->mark[names[i]]) W->marks[markcount++] = i;
+    }
+
+    if (markcount > 1 && markcount % 2 == 0 &&
+        B->ghtree == CCtsp_BLOSSOM_GH_ODDCUT) {
+        rval = search_oddcuts (B, W, c, markcount, names, cuts, cutcount);
+        if (rval) {
+            fprintf (stderr, "search_oddcuts failed\n"); goto CLEANUP;
+        }
+    } else if (markcount > 1) {
+        rval = build_cuttree (B, W, c, tp, markcount, W->marks, rstate);
+        if (rval) {
+            fprintf (stderr, "build_cuttree failed\n"); goto CLEANUP;
+        }
+    }
+
+    label_cuttree (B, W, tp, names);
+
+    if (tp->tcount) {
+        rval = searchtree (B, W, tp, cuts, cutcount);
+        if (rval) {
+            fprintf (stderr, "searchtree failed\n"); goto CLEANUP;
+        }
+    }
+    if (markcount % 2 == 1) {
+        rval = loadcuttree_blossom (B, W, 0, gncount, cuts, cutcount);
+        if (rval) {
+            fprintf (stderr, "loadcuttree_blossom failed\n"); goto CLEANUP;
+        }
+    }
+
+CLEANUP:
+
+    CCcut_GHtreefree (&T);
+    return rval;
+}
+
+/* lrt_component is the Letchford-Reinelt-Theis method on component c.   */
+/* It builds a Gomory-Hu tree over all nodes of the 0<x<1 graph, with     */
+/* capacities min(x, 1-x), and checks the best blossom with each tree cut */
+/* (and c itself) as its handle.  The graph is the support graph, so at   */
+/* most gncount - 1 flows are needed, against one per odd node of the     */
+/* (larger) Padberg-Rao split graph.                                      */
+
+static int lrt_component (blograph *B, blowork *W, int c,
+        CCrandstate *rstate, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    int k, tcount;
+    int gncount = B->compbeg[c+1] - B->compbeg[c];
+    int *names  = B->compnode + B->compbeg[c];
+    CC_GHtree T, *tp;
+    int rval = 0;
+
+    CCcut_GHtreeinit (&T);
+    tp = (B->trees ? &B->trees[c] : &T);
+    W->comp    = c;
+    W->gncount = gncount;
+    W->seq     = 0;
+
+    rval = build_cuttree (B, W, c, tp, 0, (int *) NULL, rstate);
+    if (rval) {
+        fprintf (stderr, "build_cuttree failed\n"); goto CLEANUP;
+    }
+
+    label_cuttree (B, W, tp, names);
+
+    tcount = tp->tcount;
+    for (k = 1; k < tcount && !BLO_STOPPED (W); k++) {
+        if (tp->cutval[k] < 1.0 - BLOTOLERANCE) {
+            rval = lrt_blossom (B, W, W->lo[k], W->hi[k], tp->cutval[k], cuts,
+                                cutcount);
+            if (rval) {
+                fprintf (stderr, "lrt_blossom failed\n"); goto CLEANUP;
+            }
+        }
+    }
+
+    rval = lrt_blossom (B, W, 0, gncount, 0.0, cuts, cutcount);
+    if (rval) {
+        fprintf (stderr, "lrt_blossom failed\n"); goto CLEANUP;
+    }
+
+CLEANUP:
+
+    CCcut_GHtreefree (&T);
+    return rval;
+}
+
+/* search_oddcuts checks the odd cuts of component c of value less than  */
+/* 1 - BLOTOLERANCE that CCcut_odd_cuts finds; each one is laid out as    */
+/* the interval 0 <= pos < count and passed to loadcuttree_blossom.  The  */
+/* cutoff is scaled along with the capacities, so oddcut_blossom has no   */
+/* need to look at the (scaled) cutval it is given.                       */
+
+static int search_oddcuts (blograph *B, blowork *W, int c, int markcount,
+        int *names, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    int gncount = B->compbeg[c+1] - B->compbeg[c];
+    int gecount = B->ecompbeg[c+1] - B->ecompbeg[c];
+    int *gelist = B->gelist + 2*B->ecompbeg[c];
+    double *gecap = B->gecap + B->ecompbeg[c];
+    double cutoff = 1.0 - BLOTOLERANCE;
+    blooddcut P;
+    int rval;
+
+    if (B->capscale > 0.0) cutoff *= B->capscale;
+
+    P.B        = B;
+    P.W        = W;
+    P.names    = names;
+    P.cuts     = cuts;
+    P.cutcount = cutcount;
+
+    rval = CCcut_odd_cuts (gncount, gecount, gelist, gecap, markcount,
+                           W->marks, cutoff, B->flowalg, oddcut_blossom,
+                           (void *) &P, (int *) NULL);
+    if (rval) {
+        fprintf (stderr, "CCcut_odd_cuts failed\n");
+    }
+    return rval;
+}
+
+static int oddcut_blossom (CC_UNUSED double cutval, int count, int *cut,
+        void *pass_param)
+{
+    blooddcut *P = (blooddcut *) pass_param;
+    int rval;
+
+    if (BLO_STOPPED (P->W)) return 0;
+
+    label_oddcut (P->B, P->W, P->names, count, cut);
+    rval = loadcuttree_blossom (P->B, P->W, 0, count, P->cuts, P->cutcount);
+    if (rval) {
+        fprintf (stderr, "loadcuttree_blossom failed\n");
+    }
+    return rval;
+}
+
+/* build_cuttree builds the Gomory-Hu tree of component c with the code  */
+/* chosen in B->ghtree, running the flows with B->flowalg.  All of them   */
+/* give the same tree layout.  If the capacities were scaled to integers, */
+/* the tree values are brought back to the scale of x.  A tree kept from  */
+/* the previous call is updated instead, if B->update allows it.          */
+
+static int build_cuttree (blograph *B, blowork *W, int c, CC_GHtree *T,
+        int markcount, int *marks, CCrandstate *rstate)
+{
+    int gncount = B->compbeg[c+1] - B->compbeg[c];
+    int gecount = B->ecompbeg[c+1] - B->ecompbeg[c];
+    int *gelist = B->gelist + 2*B->ecompbeg[c];
+    double *gecap = B->gecap + B->ecompbeg[c];
+    int rval;
+
+    if (B->update && T->tcount) {
+        rval = update_cuttree (B, c, T, markcount, marks, rstate);
+        if (rval) fprintf (stderr, "update_cuttree failed\n");
+        else      B->cur[c] = 1;
+        return rval;
+    }
+    CCcut_GHtreefree (T);
+    CCcut_GHtreeinit (T);
+
+    if (B->ghtree == CCtsp_BLOSSOM_GH_GUSFIELD) {
+        rval = CCcut_gusfield_gomory_hu (T, gncount, gecount, gelist, gecap,
+                                         markcount, marks, B->flowalg);
+        if (rval) fprintf (stderr, "CCcut_gusfield_gomory_hu failed\n");
+    } else if (B->ghtree == CCtsp_BLOSSOM_GH_THREADED) {
+        rval = CCcut_gomory_hu_threaded (T, gncount, gecount, gelist, gecap,
+                                         markcount, marks, rstate,
+                                         W->ghthreads, B->flowalg);
+        if (rval) fprintf (stderr, "CCcut_gomory_hu_threaded failed\n");
+    } else {
+        rval = CCcut_gomory_hu (T, gncount, gecount, gelist, gecap,
+                                markcount, marks, rstate, B->flowalg);
+        if (rval) fprintf (stderr, "CCcut_gomory_hu failed\n");
+    }
+    if (!rval && B->capscale > 0.0) {
+        CCcut_GHtreeunscale (T, B->capscale);
+    }
+    if (!rval && B->cur) B->cur[c] = 1;
+    return rval;
+}
+
+/* update_cuttree brings the kept tree of component c up to date, with   */
+/* the edges whose capacities differ from the last call.                 */
+
+static int update_cuttree (blograph *B, int c, CC_GHtree *T, int markcount,
+        int *marks, CCrandstate *rstate)
+{
+    int gncount = B->compbeg[c+1] - B->compbeg[c];
+    int gecount = B->ecompbeg[c+1] - B->ecompbeg[c];
+    int *gelist = B->gelist + 2*B->ecompbeg[c];
+    double *gecap  = B->gecap + B->ecompbeg[c];
+    double *oldcap = B->oldcap + B->ecompbeg[c];
+    int *chg = B->chg + B->ecompbeg[c];
+    int e, chcount = 0;
+    int rval = 0;
+
+    for (e = 0; e < gecount; e++) {
+        if (gecap[e] != oldcap[e]) chg[chcount++] = e;
+    }
+    if (chcount > 0) {
+        rval = CCcut_gomory_hu_update (T, gncount, gecount, gelist, gecap,
+                                       markcount, marks, chcount, chg, oldcap,
+                                       rstate, B->flowalg, (int *) NULL);
+        if (rval) fprintf (stderr, "CCcut_gomory_hu_update failed\n");
+    }
+    return rval;
+}
+
+/* lrt_blossom checks the handle S = {lo <= pos < hi}, a cut of capacity  */
+/* cutval.  The teeth are the edges of delta(S) with x > 1/2; if there    */
+/* are an even number of these, the edge of delta(S) with x nearest 1/2   */
+/* is added or dropped, at a cost of |1 - 2x|.  The blossom is violated   */
+/* if cutval plus this cost is less than 1.  The flip is made whenever    */
+/* the count is even, also at cost 0 (an edge with x = 1/2), since the    */
+/* teeth must be odd for work_blossom.  The parity is counted from        */
+/* the smaller side of the cut, as in count_teeth.  As in the Padberg-Rao */
+/* search, handles with fewer than 3 nodes are skipped.                   */
+
+static int lrt_blossom (blograph *B, blowork *W, int lo, int hi,
+        double cutval, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    int i, k, e, n, ins, odd = 0, tcount = 0, hcount = 0;
+    int needflip, flip = -1, segs[4], nsegs, s;
+    double f, fix = 2.0;
+    int rval = 0;
+
+    if (hi - lo < 3) return 0;
+
+    if (hi - lo <= W->gncount - (hi - lo)) {
+        ins = 1;
+        segs[0] = lo; segs[1] = hi;
+        nsegs = 1;
+    } else {
+        ins = 0;
+        segs[0] = 0;  segs[1] = lo;
+        segs[2] = hi; segs[3] = W->gncount;
+        nsegs = 2;
+        odd = W->isopre[hi] - W->isopre[lo];
+        if (odd) fix = 1.0;
+    }
+
+    for (s = 0; s < nsegs; s++) {
+        for (i = segs[2*s]; i < segs[2*s+1]; i++) {
+            n = W->lnode[i];
+            for (k = B->adjbeg[n]; k < B->adjbeg[n+1]; k++) {
+                e = B->adjlist[k];
+                if (BLO_INSIDE (B, W, BLO_OTHEREND (B, e, n), lo, hi) == ins) {
+                    continue;
+                }
+                if (B->x[e] > 0.5) odd++;
+                f = LRT_FLIPCOST (B->x[e]);
+                if (f < fix) fix = f;
+            }
+        }
+    }
+    needflip = (odd % 2 == 0);
+    if (!needflip) fix = 0.0;
+    if (cutval + fix >= 1.0 - BLOTOLERANCE) return 0;
+
+    for (i = lo; i < hi; i++) {
+        n = W->lnode[i];
+        for (k = B->adjbeg[n]; k < B->adjbeg[n+1]; k++) {
+            e = B->adjlist[k];
+            if (BLO_INSIDE (B, W, BLO_OTHEREND (B, e, n), lo, hi)) continue;
+            if (B->x[e] > 0.5) W->tedge[tcount++] = e;
+            if (needflip && flip == -1 && LRT_FLIPCOST (B->x[e]) <= fix) {
+                flip = e;
+            }
+        }
+    }
+    if (needflip) {
+        if (flip == -1) return 0;
+        if (B->x[flip] > 0.5) {
+            for (i = 0; W->tedge[i] != flip; i++);
+            W->tedge[i] = W->tedge[--tcount];
         } else {
-            t[i].in  = e->ends[1]->name;
-            t[i].out = e->ends[0]->name;
+            W->tedge[tcount++] = flip;
         }
     }
 
-    for (i = 0;  i < tcount; i++) {
-        hit[t[i].in] = 0;
-        del[t[i].in] = 0;
-    } 
-    for (i = 0;  i < tcount; i++) {
-        if (hit[t[i].in]) del[t[i].in] = 1;
-        else               hit[t[i].in] = 1;
+    CCutil_int_array_quicksort (W->tedge, tcount);
+    for (i = 0; i < tcount; i++) {
+        e = W->tedge[tcount - 1 - i];
+        if (BLO_INSIDE (B, W, B->ends[2*e], lo, hi)) {
+            W->tlist[i].in  = B->ends[2*e];
+            W->tlist[i].out = B->ends[2*e+1];
+        } else {
+            W->tlist[i].in  = B->ends[2*e+1];
+            W->tlist[i].out = B->ends[2*e];
+        }
     }
+    for (i = lo; i < hi; i++) W->hlist[hcount++] = W->lnode[i];
 
+    rval = work_blossom (B->ncount, hcount, W->hlist, tcount, W->tlist, W,
+                         cuts, cutcount);
+    if (rval) {
+        fprintf (stderr, "work_blossom failed\n");
+    }
+
+    return rval;
+}
+
+/* label_cuttree lays the component out in the order of T->nodes.  The  */
+/* tree nodes are in DFS order, so each subtree is an interval of it.     */
+/* With no tree, the nodes are laid out in the component's own order.     */
+
+static void label_cuttree (blograph *B, blowork *W, CC_GHtree *T, int *names)
+{
+    int i, k;
+
+    for (i = 0; i < W->gncount; i++) {
+        W->lnode[i] = (T->tcount ? names[T->nodes[i]] : names[i]);
+        B->pos[W->lnode[i]] = i;
+    }
+
+    for (k = 0; k < T->tcount; k++) {
+        W->lo[k] = T->nodebeg[k];
+        W->hi[k] = T->nodebeg[k + T->ndescendants[k]];
+    }
+
+    label_prefix (B, W);
+}
+
+/* label_oddcut lays out the component with the nodes of cut (local       */
+/* numbers) first, so the cut is the interval 0 <= pos < count.  A node   */
+/* is in the cut if the place pos gives it holds the node itself.         */
+
+static void label_oddcut (blograph *B, blowork *W, int *names, int count,
+        int *cut)
+{
+    int i, k, n;
+
+    for (i = 0; i < count; i++) {
+        W->lnode[i] = names[cut[i]];
+        B->pos[W->lnode[i]] = i;
+    }
+    for (i = 0, k = count; i < W->gncount; i++) {
+        n = names[i];
+        if (B->pos[n] < count && B->pos[n] >= 0 && W->lnode[B->pos[n]] == n) {
+            continue;
+        }
+        W->lnode[k] = n;
+        B->pos[n] = k++;
+    }
+
+    label_prefix (B, W);
+}
+
+/* label_prefix sets the prefix sums origpre and isopre of the layout.    */
+
+static void label_prefix (blograph *B, blowork *W)
+{
+    int i, k, e, n;
+
+    W->origpre[0] = 0;
+    W->isopre[0]  = 0;
+    for (i = 0; i < W->gncount; i++) {
+        n = W->lnode[i];
+        W->origpre[i+1] = W->origpre[i];
+        W->isopre[i+1]  = W->isopre[i];
+        if (n < B->ncount) {
+            W->origpre[i+1]++;
+            for (k = B->adjbeg[n]; k < B->adjbeg[n+1]; k++) {
+                e = B->adjlist[k];
+                if (B->x[e] > ONEMINUS &&
+                    B->comp[BLO_OTHEREND (B, e, n)] != W->comp) {
+                    W->isopre[i+1]++;
+                }
+            }
+        }
+    }
+}
+
+/* searchtree scans the tree nodes in DFS order, the order of the old    */
+/* recursive search.                                                      */
+
+static int searchtree (blograph *B, blowork *W, CC_GHtree *T,
+        CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    int *nd = T->ndescendants;
+    double *cutval = T->cutval;
+    int k, tcount = T->tcount;
+    int rval = 0;
+
+    for (k = 0; k < tcount && !BLO_STOPPED (W); k++) {
+        if (nd[k] % 2 == 1  &&  nd[k] > 1  ) {
+            if (cutval[k] < 1.0 - BLOTOLERANCE) {
+                rval = loadcuttree_blossom (B, W, W->lo[k], W->hi[k], cuts,
+                                            cutcount);
+                if (rval) {
+                    fprintf (stderr, "loadcuttree_blossom failed\n");
+                    goto CLEANUP;
+                }
+            }
+        }
+    }
+
+CLEANUP:
+
+    return rval;
+}
+
+/* count_teeth counts the teeth of the cut lo <= pos < hi, working from   */
+/* the smaller of its two sides.  If teeth is not NULL, the cut side is   */
+/* used and the tooth edges are returned in teeth.                        */
+
+static int count_teeth (blograph *B, blowork *W, int lo, int hi, int *teeth)
+{
+    int i, k, e, n, ins, tcount = 0;
+    int segs[4], nsegs, s;
+
+    if (teeth || hi - lo <= W->gncount - (hi - lo)) {
+        ins = 1;
+        segs[0] = lo; segs[1] = hi;
+        nsegs = 1;
+    } else {
+        ins = 0;
+        segs[0] = 0;  segs[1] = lo;
+        segs[2] = hi; segs[3] = W->gncount;
+        nsegs = 2;
+        tcount = W->isopre[hi] - W->isopre[lo];
+    }
+
+    for (s = 0; s < nsegs; s++) {
+        for (i = segs[2*s]; i < segs[2*s+1]; i++) {
+            n = W->lnode[i];
+            if (n >= B->ncount) continue;
+            for (k = B->adjbeg[n]; k < B->adjbeg[n+1]; k++) {
+                e = B->adjlist[k];
+                if (BLO_INSIDE (B, W, BLO_OTHEREND (B, e, n), lo, hi) == ins) {
+                    continue;
+                }
+                if (cuttree_tooth (B, W, e, lo, hi)) {
+                    if (teeth) teeth[tcount] = e;
+                    tcount++;
+                }
+            }
+        }
+    }
+    return tcount;
+}
+
+static int loadcuttree_blossom (blograph *B, blowork *W, int lo, int hi,
+        CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    int i, e, n, rval = 0;
+    int tcount = 0;
+    int hcount = W->origpre[hi] - W->origpre[lo];
+
+    if (hcount < 3) return 0;
+    if (count_teeth (B, W, lo, hi, (int *) NULL) % 2 == 0) return 0;
+
+    tcount = count_teeth (B, W, lo, hi, W->tedge);
+
+    /* list the teeth in decreasing edge order, as the old code did */
+    CCutil_int_array_quicksort (W->tedge, tcount);
     for (i = 0; i < tcount; i++) {
-        hit[t[i].out] = 0;
-        add[t[i].out] = 0;
+        e = W->tedge[tcount - 1 - i];
+        if (BLO_INSIDE (B, W, B->ends[2*e], lo, hi)) {
+            W->tlist[i].in  = B->ends[2*e];
+            W->tlist[i].out = B->ends[2*e+1];
+        } else {
+            W->tlist[i].in  = B->ends[2*e+1];
+            W->tlist[i].out = B->ends[2*e];
+        }
+    }
+    for (i = lo, hcount = 0; i < hi; i++) {
+        n = W->lnode[i];
+        if (n < B->ncount) W->hlist[hcount++] = n;
+    }
+
+    rval = work_blossom (B->ncount, hcount, W->hlist, tcount, W->tlist, W,
+                         cuts, cutcount);
+    if (rval) {
+        fprintf (stderr, "work_blossom failed\n");
+    }
+
+    return rval;
+}
+
+/* work_blossom expects the teeth to be oriented, with t[i].in in the     */
+/* handle and t[i].out outside of the handle.  The array W->work holds    */
+/* 3*ncount ints that are zero on entry; they are zero again on return,   */
+/* so the cost is linear in the size of the handle and the teeth.  The    */
+/* cleaned-up blossom is built in W->hbuf and W->tbuf.                    */
+
+static int work_blossom (int ncount, int hcount, int *handle, int tcount,
+        toothobj *t, blowork *W, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    toothobj *newteeth = W->tbuf;
+    int i, k, newhcount, newtcount, rval = 0;
+    int *hit = W->work;
+    int *del = W->work + ncount;
+    int *add = W->work + 2*ncount;
+    int *newhandle = W->hbuf;
+
+    /* Clean up intersecting teeth */
+
+    for (i = 0; i < tcount; i++) {
+        if (hit[t[i].in]) del[t[i].in] = 1;
+        else              hit[t[i].in] = 1;
     }
+    for (i = 0; i < tcount; i++) hit[t[i].in] = 0;
+
     for (i = 0; i < tcount; i++) {
         if (hit[t[i].out]) add[t[i].out] = 1;
-        else              hit[t[i].out] = 1;
+        else               hit[t[i].out] = 1;
     }
+    for (i = 0; i < tcount; i++) hit[t[i].out] = 0;
 
-    for (i = 0; i < G->ncount; i++) hit[i] = 0;
-
-    for (np = handle; np; np = np->next) {
-        hit[np->this->name] = 1;
+    for (i = 0; i < hcount; i++) {
+        hit[handle[i]] = 1;
     }
     for (i = 0; i < tcount; i++) {
         if (del[t[i].in]) hit[t[i].in] = 0;
@@ -648,9 +2408,15 @@ static int work_blossom (graph *G, nodeptr *handle, int tcount,
     for (i = 0; i < tcount; i++) {
         if (add[t[i].out]) hit[t[i].out] = 1;
     }
-  
-    for (i = 0, newhcount = 0; i < G->ncount; i++) {
-        if (hit[i]) newhcount++;
+
+    for (i = 0, newhcount = 0; i < hcount; i++) {
+        if (hit[handle[i]]) newhcount++;
+    }
+    for (i = 0; i < tcount; i++) {
+        if (add[t[i].out] == 1) {
+            add[t[i].out] = 2;
+            newhcount++;
+        }
     }
     for (i = 0, newtcount = 0; i < tcount; i++) {
         if (hit[t[i].in] != hit[t[i].out]) newtcount++;
@@ -661,15 +2427,15 @@ static int work_blossom (graph *G, nodeptr *handle, int tcount,
 #else
     if (newhcount >= 3 && (newtcount % 2 == 1) && newtcount >= 3) {
 #endif
-        newhandle = CC_SAFE_MALLOC (newhcount, int);
-        newteeth  = CC_SAFE_MALLOC (newtcount, toothobj);
-        if (!newhandle || !newteeth) {
-            fprintf (stderr, "out of memory in work_blossom\n");
-            rval = 1; goto CLEANUP;
-        }
         k = 0;
-        for (i = 0; i < G->ncount; i++) {
-            if (hit[i]) newhandle[k++] = i;
+        for (i = 0; i < hcount; i++) {
+            if (hit[handle[i]]) newhandle[k++] = handle[i];
+        }
+        for (i = 0; i < tcount; i++) {
+            if (add[t[i].out] == 2) {
+                add[t[i].out] = 1;
+                newhandle[k++] = t[i].out;
+            }
         }
         k = 0;
         for (i = 0; i < tcount; i++) {
@@ -679,24 +2445,69 @@ static int work_blossom (graph *G, nodeptr *handle, int tcount,
                 k++;
             }
         }
-        rval = add_blossom (G, newhcount, newhandle, newtcount, newteeth, cuts,
-                            cutcount);
-        CCcheck_rval (rval, "add_blossom failed");
+        if (W->budget) {
+            rval = budget_blossom (ncount, newhcount, newhandle, newtcount,
+                                   newteeth, W, cuts, cutcount);
+            CCcheck_rval (rval, "budget_blossom failed");
+        } else {
+            rval = add_blossom (ncount, newhcount, newhandle, newtcount,
+                                newteeth, cuts, cutcount);
+            CCcheck_rval (rval, "add_blossom failed");
+        }
    }
 
 CLEANUP:
 
-    CC_IFFREE (t, toothobj);
-    CC_IFFREE (hit, int);
-    CC_IFFREE (del, int);
-    CC_IFFREE (add, int);
-    CC_IFFREE (newhandle, int);
-    CC_IFFREE (newteeth, toothobj);
+    for (i = 0; i < hcount; i++) hit[handle[i]] = 0;
+    for (i = 0; i < tcount; i++) {
+        hit[t[i].in]  = 0;
+        hit[t[i].out] = 0;
+        del[t[i].in]  = 0;
+        add[t[i].out] = 0;
+    }
 
     return rval;
 }
 
-static int add_blossom (graph *G, int hcount, int *handle, int tcount,
+/* work_blossom_lists is the entry to work_blossom for the heuristics,     */
+/* which keep the handle and teeth in linked lists.                        */
+
+static int work_blossom_lists (graph *G, nodeptr *handle, int tcount,
+        edgeptr *teeth, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    edge *e;
+    edgeptr *ep;
+    nodeptr *np;
+    toothobj *t = G->W->tlist;
+    int *h = G->W->hlist;
+    int i, hcount = 0, rval = 0;
+
+    G->magicnum++;
+    for (np = handle; np; np = np->next) {
+        np->this->magiclabel = G->magicnum;
+        h[hcount++] = np->this->name;
+    }
+    for (ep = teeth, i = 0; ep; ep = ep->next, i++) {
+        e = ep->this;
+        if (e->ends[0]->magiclabel == e->ends[1]->magiclabel) goto CLEANUP;
+        if (e->ends[0]->magiclabel == G->magicnum) {
+            t[i].in  = e->ends[0]->name;
+            t[i].out = e->ends[1]->name;
+        } else {
+            t[i].in  = e->ends[1]->name;
+            t[i].out = e->ends[0]->name;
+        }
+    }
+
+    rval = work_blossom (G->ncount, hcount, h, tcount, t, G->W, cuts,
+                         cutcount);
+
+CLEANUP:
+
+    return rval;
+}
+
+static int add_blossom (int ncount, int hcount, int *handle, int tcount,
         toothobj *teeth, CCtsp_lpcut_in **cuts, int *cutcount)
 {
     int itooth[2];
@@ -724,7 +2535,7 @@ static int add_blossom (graph *G, int hcount, int *handle, int tcount,
     lc->sense       = 'G';
     lc->branch      = 0;
 
-    rval = CCtsp_construct_skeleton (lc, G->ncount);
+    rval = CCtsp_construct_skeleton (lc, ncount);
     if (rval) {
         fprintf (stderr, "CCtsp_construct_skeleton failed\n"); goto CLEANUP;
     }
@@ -745,46 +2556,57 @@ CLEANUP:
     return rval;
 }
 
-static int cuttree_tooth (edge *e, int v)
+
+static int cuttree_tooth (blograph *B, blowork *W, int e, int lo, int hi)
 {
-    if (e->x > ONEMINUS) return 1;
-    if (e->x < ZEROPLUS) return 0;
+    int p;
+
+    if (B->x[e] > ONEMINUS) return 1;
+    if (B->x[e] < ZEROPLUS) return 0;
 
-    if (e->splitter->magiclabel == v) {
-        if (e->splitter->oddnode->magiclabel == v) return 0;
-        else                                       return 1;
+    p = B->splitter[e];
+    if (BLO_INSIDE (B, W, p, lo, hi)) {
+        if (BLO_INSIDE (B, W, B->oddnode[p - B->ncount], lo, hi)) return 0;
+        else                                                     return 1;
     } else {
-        if (e->splitter->oddnode->magiclabel == v) return 1;
-        else                                       return 0;
+        if (BLO_INSIDE (B, W, B->oddnode[p - B->ncount], lo, hi)) return 1;
+        else                                                     return 0;
     }
 }
 
-static int oneend (edge *e, int v)
+static void blolink_init (graph *G)
 {
-    if ((e->ends[0]->magiclabel == v && e->ends[1]->magiclabel != v) ||
-        (e->ends[0]->magiclabel != v && e->ends[1]->magiclabel == v)) {
-        return 1;
-    } else {
-        return 0;
+    CCptrworld_init (&G->edgeptr_world);
+    CCptrworld_init (&G->nodeptr_world);
+}
+
+static void blolink_free (graph *G)
+{
+    int total, onlist;
+
+    if (edgeptr_check_leaks (&G->edgeptr_world, &total, &onlist)) {
+        fprintf (stderr, "WARNING: %d outstanding BLOSSOM-edgeptrs\n",
+                 total - onlist);
     }
+    CCptrworld_delete (&G->edgeptr_world);
+
+    if (nodeptr_check_leaks (&G->nodeptr_world, &total, &onlist)) {
+        fprintf (stderr, "WARNING: %d outstanding BLOSSOM-nodeptrs\n",
+                 total - onlist);
+    }
+    CCptrworld_delete (&G->nodeptr_world);
 }
 
+/* buildgraph fills in G, whose arrays come from alloc_blospace; the      */
+/* adjacency lists are taken from (and returned to by cleargraph) the     */
+/* edgeptr world of G.                                                    */
+
 static int buildgraph (graph *G, int ncount, int ecount, int *elist, double *x)
 {
-    node *n;
     edge *e;
     int i, k, n1, n2;
     int rval = 0;
 
-    initgraph (G);
-
-    G->nodelist = CC_SAFE_MALLOC (ncount, node);
-    G->edgelist = CC_SAFE_MALLOC (ecount, edge);
-
-    if (!G->nodelist || !G->edgelist) {
-        fprintf (stderr, "out of memory in buildgraph\n");
-        rval = 1; goto CLEANUP;
-    }
     G->ncount = ncount;
     G->ecount = ecount;
 
@@ -792,7 +2614,6 @@ static int buildgraph (graph *G, int ncount, int ecount, int *elist, double *x)
         G->nodelist[i].adj = (edgeptr *) NULL;
         G->nodelist[i].magiclabel = 0;
         G->nodelist[i].name = i;
-        G->nodelist[i].pe = (edge *) NULL;
         G->nodelist[i].mark = 0;
     }
     for (i = 0, e = G->edgelist, k = 0; i < ecount; i++, e++) {
@@ -801,7 +2622,6 @@ static int buildgraph (graph *G, int ncount, int ecount, int *elist, double *x)
         e->ends[0] = G->nodelist + n1;
         e->ends[1] = G->nodelist + n2;
         e->x = x[i];
-        e->magiclabel = 0;
     }
 
     for (i = ecount, e = G->edgelist; i; i--, e++) {
@@ -811,108 +2631,270 @@ static int buildgraph (graph *G, int ncount, int ecount, int *elist, double *x)
         if (rval) goto CLEANUP;
     }
 
-    G->pseudonodelist = &G->pseudonodedummy;
-    G->pseudonodedummy.prev = (node *) NULL;
-    G->pseudonodedummy.next = G->nodelist;
-    for (i = 0, n = G->nodelist; i < G->ncount; i++, n++) {
-        n->prev = n - 1;
-        n->next = n + 1;
+CLEANUP:
+
+    if (rval) cleargraph (G);
+    return rval;
+}
+
+static void initgraph (graph *G)
+{
+    if (G) {
+        G->ncount = 0;
+        G->nodelist = (node *) NULL;
+        G->ecount = 0;
+        G->edgelist = (edge *) NULL;
+        G->magicnum = 0;
+        G->stack = (node **) NULL;
+        G->scan = (edgeptr **) NULL;
+        G->tlist = (edge **) NULL;
+        G->xtlist = (double *) NULL;
+        G->tperm = (int *) NULL;
+        G->W = (blowork *) NULL;
+    }
+}
+
+static void cleargraph (graph *G)
+{
+    int i;
+    node *n;
+
+    for (i = G->ncount, n = G->nodelist; i; i--, n++) {
+        edgeptr_listfree (&G->edgeptr_world, n->adj);
+        n->adj = (edgeptr *) NULL;
+    }
+    G->ncount = 0;
+    G->ecount = 0;
+}
+
+#define GH_EPS 0.3
+
+int CCtsp_fastblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
+        int ecount, int *elist, double *x)
+{
+    CCtsp_blossom_workspace w;
+    int rval;
+
+    CCtsp_init_blossom_workspace (&w);
+    rval = CCtsp_fastblossom_work (cuts, cutcount, ncount, ecount, elist, x, &w);
+    CCtsp_free_blossom_workspace (&w);
+    return rval;
+}
+
+int CCtsp_fastblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x,
+        CCtsp_blossom_workspace *w)
+{
+    return CCtsp_heurblossom_work (cuts, cutcount, (CCtsp_lpcut_in **) NULL,
+                                   (int *) NULL, ncount, ecount, elist, x, 0,
+                                   (double *) NULL, w);
+}
+
+int CCtsp_ghfastblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
+        int ecount, int *elist, double *x)
+{
+    CCtsp_blossom_workspace w;
+    int rval;
+
+    CCtsp_init_blossom_workspace (&w);
+    rval = CCtsp_ghfastblossom_work (cuts, cutcount, ncount, ecount, elist, x, &w);
+    CCtsp_free_blossom_workspace (&w);
+    return rval;
+}
+
+int CCtsp_ghfastblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x,
+        CCtsp_blossom_workspace *w)
+{
+    return CCtsp_heurblossom_work ((CCtsp_lpcut_in **) NULL, (int *) NULL,
+                                   cuts, cutcount, ncount, ecount, elist, x,
+                                   0, (double *) NULL, w);
+}
+
+int CCtsp_heurblossom (CCtsp_lpcut_in **fastcuts, int *fastcount,
+        CCtsp_lpcut_in **ghcuts, int *ghcount, int ncount, int ecount,
+        int *elist, double *x, int epscount, double *eps)
+{
+    CCtsp_blossom_workspace w;
+    int rval;
+
+    CCtsp_init_blossom_workspace (&w);
+    rval = CCtsp_heurblossom_work (fastcuts, fastcount, ghcuts, ghcount,
+                                   ncount, ecount, elist, x, epscount, eps, &w);
+    CCtsp_free_blossom_workspace (&w);
+    return rval;
+}
+
+int CCtsp_heurblossom_work (CCtsp_lpcut_in **fastcuts, int *fastcount,
+        CCtsp_lpcut_in **ghcuts, int *ghcount, int ncount, int ecount,
+        int *elist, double *x, int epscount, double *eps,
+        CCtsp_blossom_workspace *w)
+{
+    graph *G = (graph *) NULL;
+    double defeps = GH_EPS;
+    int i, rval = 0;
+
+    /* NOTE: Groetchel and Holland use a lowerbound of GH_EPS for the  */
+    /*       edges allowed in the graph, while we use ZEROPLUS (a much */
+    /*       smaller number).                                          */
+
+    if (fastcount) *fastcount = 0;
+    if (ghcount) *ghcount = 0;
+    if (eps == (double *) NULL) {
+        eps = &defeps;
+        epscount = 1;
+    }
+
+    rval = size_blospace (w, ncount, ecount, x, 1);
+    if (rval) {
+        fprintf (stderr, "size_blospace failed\n"); goto CLEANUP;
+    }
+    load_support (w->space, ecount, elist, x);
+    G = &w->space->G;
+
+    rval = buildgraph (G, ncount, w->space->secount, w->space->selist,
+                       w->space->sx);
+    if (rval) {
+        fprintf (stderr, "buildgraph failed\n"); goto CLEANUP;
+    }
+
+    if (fastcuts) {
+        start_budget (w->space, w);
+        budget_support (w->space, ncount);
+        rval = heur_pass (G, ONEMINUS, 0, fastcuts, fastcount);
+        if (rval) {
+            fprintf (stderr, "heur_pass failed\n"); goto CLEANUP;
+        }
+        finish_budget (w->space, fastcuts, fastcount);
+    }
+
+    if (ghcuts) {
+        start_budget (w->space, w);
+        budget_support (w->space, ncount);
+        for (i = 0; i < epscount && !BLO_STOPPED (G->W); i++) {
+            if (same_ghgraph (G, eps, i)) continue;
+            rval = heur_pass (G, 1.0 - eps[i], 1, ghcuts, ghcount);
+            if (rval) {
+                fprintf (stderr, "heur_pass failed\n"); goto CLEANUP;
+            }
+        }
+        finish_budget (w->space, ghcuts, ghcount);
     }
-    G->nodelist->prev = G->pseudonodelist;
-    G->nodelist[G->ncount - 1].next = (node *) NULL;
 
 CLEANUP:
 
-    if (rval) freegraph (G);
-    return rval;
-}
-
-static void initgraph (graph *G)
-{
     if (G) {
-        G->ncount = 0;
-        G->nodelist = (node *) NULL;
-        G->ecount = 0;
-        G->edgelist = (edge *) NULL;
-        G->pseudonodelist = (node *) NULL;
-        G->pseudoedgelist = (edge *) NULL;
-        G->magicnum = 0;
+        if (rval) {
+            finish_budget (w->space, (CCtsp_lpcut_in **) NULL, (int *) NULL);
+        }
+        cleargraph (G);
     }
+    return rval;
 }
 
-static void freegraph (graph *G)
-{
-    int i;
-    node *n;
+/* budget_support builds the support graph of S->B, which the heuristics */
+/* only need to measure violations for a budget.                          */
 
-    if (G->nodelist) {
-        for (i = G->ncount, n = G->nodelist; i; i--, n++) {
-            edgeptr_listfree (&G->edgeptr_world, n->adj);
-            n->adj = (edgeptr *) NULL;
-        }
-        CC_FREE (G->nodelist, node);
+static void budget_support (blospace *S, int ncount)
+{
+    if (S->W[0].budget) {
+        build_blograph (&S->B, ncount, S->secount, S->selist, S->sx);
     }
-    CC_IFFREE (G->edgelist, edge);
 }
 
-int CCtsp_fastblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
-        int ecount, int *elist, double *x)
+/* heur_pass runs one of the heuristics on G: the handles are the         */
+/* components of the ZEROPLUS < x < ubd graph, and the teeth are grown by */
+/* grow_ghteeth (using the x >= ubd edges) if gh is set, and by           */
+/* grow_teeth otherwise.                                                  */
+
+static int heur_pass (graph *G, double ubd, int gh, CCtsp_lpcut_in **cuts,
+        int *cutcount)
 {
-    graph G;
-    int rval = 0;
     nodeptr *handle;
-    int i, k;
-
-    *cutcount = 0;
-    initgraph (&G);
-    blolink_init (&G);
+    int i, k = 0, count = 0;
+    int rval = 0;
 
-    rval = buildgraph (&G, ncount, ecount, elist, x);
-    if (rval) {
-        fprintf (stderr, "buildgraph failed\n"); goto CLEANUP;
+    for (i = 0; i < G->ncount; i++) {
+        G->nodelist[i].mark = 0;
     }
 
-    k = 0;
-    for (i = 0; i < G.ncount; i++) {
-        if (G.nodelist[i].mark == 0) {
+    for (i = 0; i < G->ncount && !BLO_STOPPED (G->W); i++) {
+        if (G->nodelist[i].mark == 0) {
             handle = (nodeptr *) NULL;
-            rval = grab_component (&G, &(G.nodelist[i]), ++k, &handle,
-                                   ZEROPLUS, ONEMINUS);
+            rval = grab_component (G, &(G->nodelist[i]), ++k, &handle,
+                                   ZEROPLUS, ubd);
             if (rval) {
-                fprintf (stderr, "grab_component failed\n"); goto CLEANUP;
+                fprintf (stderr, "grab_component failed\n");
+                nodeptr_listfree (&G->nodeptr_world, handle);
+                goto CLEANUP;
+            }
+            if (gh) {
+                grow_ghteeth (G, handle, ubd, cuts, &count);
+            } else {
+                grow_teeth (G, handle, cuts, &count);
             }
-            grow_teeth (&G, handle, cuts, cutcount);
-            nodeptr_listfree (&G.nodeptr_world, handle);
+            nodeptr_listfree (&G->nodeptr_world, handle);
         }
     }
 
 CLEANUP:
 
-    freegraph (&G);
-    blolink_free (&G);
-
+    if (cutcount) *cutcount += count;
     return rval;
 }
 
+/* same_ghgraph checks whether eps[i] splits the edges of G (at x < 1-eps) */
+/* in the same way as one of eps[0] to eps[i-1], in which case its GH pass */
+/* would only repeat the cuts of the earlier one.                          */
+
+static int same_ghgraph (graph *G, double *eps, int i)
+{
+    int j, k;
+    double lo, hi;
+
+    for (j = 0; j < i; j++) {
+        lo = 1.0 - (eps[i] > eps[j] ? eps[i] : eps[j]);
+        hi = 1.0 - (eps[i] > eps[j] ? eps[j] : eps[i]);
+        for (k = 0; k < G->ecount; k++) {
+            if (G->edgelist[k].x >= lo && G->edgelist[k].x < hi) break;
+        }
+        if (k == G->ecount) return 1;
+    }
+    return 0;
+}
+
+/* grab_component adds the nodes in the order of a depth-first search,    */
+/* using G->stack and G->scan (the next edge to look at for each node on  */
+/* the stack) in place of recursion.                                      */
+
 static int grab_component (graph *G, node *n, int label, nodeptr **comp,
         double lbd, double ubd)
 {
     node *v;
     edgeptr *ep;
-    int rval;
+    int top = 0;
 
     n->mark = label;
-    rval = nodeptr_listadd (comp, n, &G->nodeptr_world);
-    if (rval) return 1;
-
-    for (ep = n->adj; ep; ep = ep->next) {
+    if (nodeptr_listadd (comp, n, &G->nodeptr_world)) return 1;
+    G->stack[0] = n;
+    G->scan[0]  = n->adj;
+
+    while (top >= 0) {
+        ep = G->scan[top];
+        if (ep == (edgeptr *) NULL) {
+            top--;
+            continue;
+        }
+        G->scan[top] = ep->next;
         if (ep->this->x > lbd && ep->this->x < ubd) {
-             v = OTHEREND (ep->this, n);
-             if (v->mark == 0) {
-                 if (grab_component (G, v, label, comp, lbd, ubd)) {
-                     return 1;
-                 }
-             }
+            v = OTHEREND (ep->this, G->stack[top]);
+            if (v->mark == 0) {
+                v->mark = label;
+                if (nodeptr_listadd (comp, v, &G->nodeptr_world)) return 1;
+                top++;
+                G->stack[top] = v;
+                G->scan[top]  = v->adj;
+            }
         }
     }
     return 0;
@@ -930,7 +2912,7 @@ static int grow_teeth (graph *G, nodeptr *handle, CCtsp_lpcut_in **cuts,
         hcount++;
     }
     if (hcount < 3) goto CLEANUP;
- 
+
     for (np = handle; np; np = np->next) {
         n = np->this;
         for (ep = n->adj; ep; ep = ep->next) {
@@ -945,9 +2927,9 @@ static int grow_teeth (graph *G, nodeptr *handle, CCtsp_lpcut_in **cuts,
     }
 
     if (tcount % 2) {
-        rval = work_blossom (G, handle, tcount, teeth, cuts, cutcount);
+        rval = work_blossom_lists (G, handle, tcount, teeth, cuts, cutcount);
         if (rval) {
-            fprintf (stderr, "work_blossom failed\n"); goto CLEANUP;
+            fprintf (stderr, "work_blossom_lists failed\n"); goto CLEANUP;
         }
     }
 
@@ -957,74 +2939,29 @@ CLEANUP:
     return rval;
 }
 
-#define GH_EPS 0.3
-
-int CCtsp_ghfastblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
-        int ecount, int *elist, double *x)
-{
-    graph G;
-    int rval = 0;
-    nodeptr *handle;
-    int i, k;
-
-    /* NOTE: Groetchel and Holland use a lowerbound of GH_EPS for the  */
-    /*       edges allowed in the graph, while we use ZEROPLUS (a much */
-    /*       smaller number).                                          */
-
-    *cutcount = 0;
-    initgraph (&G);
-    blolink_init (&G);
-
-    rval = buildgraph (&G, ncount, ecount, elist, x);
-    if (rval) {
-        fprintf (stderr, "buildgraph failed\n"); goto CLEANUP;
-    }
-
-    k = 0;
-    for (i = 0; i < G.ncount; i++) {
-        if (G.nodelist[i].mark == 0) {
-            handle = (nodeptr *) NULL;
-            rval = grab_component (&G, &(G.nodelist[i]), ++k, &handle,
-                                   ZEROPLUS, 1.0 - GH_EPS);
-            if (rval) {
-                fprintf (stderr, "grab_component failed\n"); goto CLEANUP;
-            }
-            grow_ghteeth (&G, handle, cuts, cutcount);
-            nodeptr_listfree (&G.nodeptr_world, handle);
-        }
-    }
-
-CLEANUP:
-
-    freegraph (&G);
-    blolink_free (&G);
-
-    return rval;
-}
-
-static int grow_ghteeth (graph *G, nodeptr *handle, CCtsp_lpcut_in **cuts,
-        int *cutcount)
+static int grow_ghteeth (graph *G, nodeptr *handle, double ubd,
+        CCtsp_lpcut_in **cuts, int *cutcount)
 {
     edgeptr *ep, *teeth = (edgeptr *) NULL, *pteeth = (edgeptr *) NULL;
-    edge *emax = (edge *) NULL, **tlist = (edge **) NULL;
+    edge *emax = (edge *) NULL, **tlist = G->tlist;
     nodeptr *np;
     node *n;
     int i, ptcount = 0, hcount = 0, rval = 0;
-    int *tperm = (int *) NULL;
+    int *tperm = G->tperm;
     double z = 0.0, xemax = 0.0;
-    double *xtlist = (double *) NULL;
+    double *xtlist = G->xtlist;
 
     for (np = handle; np; np = np->next) {
         hcount++;
     }
     if (hcount < 3) goto CLEANUP;
- 
+
     for (np = handle; np; np = np->next) {
         n = np->this;
         for (ep = n->adj; ep; ep = ep->next) {
             if (ep->this->x > ZEROPLUS) {
                 if (ep->this->ends[0]->mark != ep->this->ends[1]->mark) {
-                    if (ep->this->x >= 1.0 - GH_EPS) {
+                    if (ep->this->x >= ubd) {
                         rval = edgeptr_listadd (&pteeth, ep->this, &G->edgeptr_world);
                         if (rval) goto CLEANUP;
                         ptcount++;
@@ -1049,15 +2986,7 @@ static int grow_ghteeth (graph *G, nodeptr *handle, CCtsp_lpcut_in **cuts,
             rval = edgeptr_listadd (&pteeth, emax, &G->edgeptr_world);
             if (rval) goto CLEANUP;
             ptcount++;
-        } 
-    }
-
-    tlist  = CC_SAFE_MALLOC (ptcount, edge *);
-    xtlist = CC_SAFE_MALLOC (ptcount, double);
-    tperm  = CC_SAFE_MALLOC (ptcount, int);
-    if (!tlist || !xtlist || !tperm) {
-        fprintf (stderr, "out of memory in grow_ghteeth\n");
-        rval = 1; goto CLEANUP;
+        }
     }
 
     for (i = 0, ep = pteeth; ep; ep = ep->next, i++) {
@@ -1075,9 +3004,9 @@ static int grow_ghteeth (graph *G, nodeptr *handle, CCtsp_lpcut_in **cuts,
     i = 1;
 
     if (z > (double) hcount + (double) ((i - 1)/2) + BLOTOLERANCE) {
-        rval = work_blossom (G, handle, i, teeth, cuts, cutcount);
+        rval = work_blossom_lists (G, handle, i, teeth, cuts, cutcount);
         if (rval) {
-            fprintf (stderr, "work_blossom failed\n"); goto CLEANUP;
+            fprintf (stderr, "work_blossom_lists failed\n"); goto CLEANUP;
         }
     } else {
         while (i < ptcount) {
@@ -1091,9 +3020,9 @@ static int grow_ghteeth (graph *G, nodeptr *handle, CCtsp_lpcut_in **cuts,
             i++;
 
             if (z > (double) hcount + (double) ((i - 1)/2) + BLOTOLERANCE) {
-                rval = work_blossom (G, handle, i, teeth, cuts, cutcount);
+                rval = work_blossom_lists (G, handle, i, teeth, cuts, cutcount);
                 if (rval) {
-                    fprintf (stderr, "work_blossom failed\n"); goto CLEANUP;
+                    fprintf (stderr, "work_blossom_lists failed\n"); goto CLEANUP;
                 }
                 break;
             }
@@ -1104,9 +3033,536 @@ CLEANUP:
 
     edgeptr_listfree (&G->edgeptr_world, pteeth);
     edgeptr_listfree (&G->edgeptr_world, teeth);
-    CC_IFFREE (tlist, edge *);
-    CC_IFFREE (xtlist, double);
-    CC_IFFREE (tperm, int);
     return rval;
 }
 
+
+static void init_blosweep (blosweep *P)
+{
+    P->perm   = (int *) NULL;
+    P->inside = (int *) NULL;
+    P->snext  = (int *) NULL;
+    P->sfirst = (int *) NULL;
+    P->slast  = (int *) NULL;
+    P->slen   = (int *) NULL;
+    P->nfirst = (int *) NULL;
+    P->nnext  = (int *) NULL;
+    P->nlast  = (int *) NULL;
+    P->parent = (int *) NULL;
+    P->size   = (int *) NULL;
+    P->hc     = (int *) NULL;
+    P->hs     = (double *) NULL;
+    P->z      = (double *) NULL;
+}
+
+static void free_blosweep (blosweep *P)
+{
+    CC_IFFREE (P->perm, int);
+    CC_IFFREE (P->inside, int);
+    CC_IFFREE (P->snext, int);
+    CC_IFFREE (P->sfirst, int);
+    CC_IFFREE (P->slast, int);
+    CC_IFFREE (P->slen, int);
+    CC_IFFREE (P->nfirst, int);
+    CC_IFFREE (P->nnext, int);
+    CC_IFFREE (P->nlast, int);
+    CC_IFFREE (P->parent, int);
+    CC_IFFREE (P->size, int);
+    CC_IFFREE (P->hc, int);
+    CC_IFFREE (P->hs, double);
+    CC_IFFREE (P->z, double);
+}
+
+static int alloc_blosweep (blosweep *P, int nspace, int aspace)
+{
+    int rval = 0;
+
+    P->perm   = CC_SAFE_MALLOC (aspace + 1, int);
+    P->inside = CC_SAFE_MALLOC (aspace + 1, int);
+    P->snext  = CC_SAFE_MALLOC (2*aspace + 1, int);
+    P->sfirst = CC_SAFE_MALLOC (nspace + 1, int);
+    P->slast  = CC_SAFE_MALLOC (nspace + 1, int);
+    P->slen   = CC_SAFE_MALLOC (nspace + 1, int);
+    P->nfirst = CC_SAFE_MALLOC (nspace + 1, int);
+    P->nnext  = CC_SAFE_MALLOC (nspace + 1, int);
+    P->nlast  = CC_SAFE_MALLOC (nspace + 1, int);
+    P->parent = CC_SAFE_MALLOC (nspace + 1, int);
+    P->size   = CC_SAFE_MALLOC (nspace + 1, int);
+    P->hc     = CC_SAFE_MALLOC (nspace + 1, int);
+    P->hs     = CC_SAFE_MALLOC (nspace + 1, double);
+    P->z      = CC_SAFE_MALLOC (nspace + 1, double);
+    if (!P->perm || !P->inside || !P->snext || !P->sfirst || !P->slast ||
+        !P->slen || !P->nfirst || !P->nnext || !P->nlast || !P->parent ||
+        !P->size || !P->hc || !P->hs || !P->z) {
+        fprintf (stderr, "out of memory in alloc_blosweep\n");
+        free_blosweep (P);
+        rval = 1;
+    }
+    return rval;
+}
+
+int CCtsp_sweepblossom (CCtsp_lpcut_in **cuts, int *cutcount, int ncount,
+        int ecount, int *elist, double *x)
+{
+    CCtsp_blossom_workspace w;
+    int rval;
+
+    CCtsp_init_blossom_workspace (&w);
+    rval = CCtsp_sweepblossom_work (cuts, cutcount, ncount, ecount, elist, x,
+                                    &w);
+    CCtsp_free_blossom_workspace (&w);
+    return rval;
+}
+
+/* The sweep adds the ZEROPLUS <= x <= ONEMINUS edges in increasing order */
+/* of x, Kruskal style, so the components it passes through are the      */
+/* handles of the Groetschel-Holland heuristic for every value of EPS.    */
+/* Each new component is tested by sweep_test.                            */
+
+int CCtsp_sweepblossom_work (CCtsp_lpcut_in **cuts, int *cutcount,
+        int ncount, int ecount, int *elist, double *x,
+        CCtsp_blossom_workspace *w)
+{
+    blosweep *P;
+    int *selist;
+    double *sx;
+    int i, e, a, b, k, secount, fcount = 0;
+    int rval = 0;
+
+    *cutcount = 0;
+
+    rval = size_blospace (w, ncount, ecount, x, 1);
+    if (rval) {
+        fprintf (stderr, "size_blospace failed\n"); goto CLEANUP;
+    }
+    load_support (w->space, ecount, elist, x);
+    P = &w->space->P;
+    selist  = w->space->selist;
+    sx      = w->space->sx;
+    secount = w->space->secount;
+
+    for (i = 0; i < ncount; i++) {
+        P->sfirst[i] = -1;
+        P->slast[i]  = -1;
+        P->slen[i]   = 0;
+        P->nfirst[i] = i;
+        P->nnext[i]  = -1;
+        P->nlast[i]  = i;
+        P->parent[i] = i;
+        P->size[i]   = 1;
+        P->hc[i]     = 0;
+        P->hs[i]     = 0.0;
+        P->z[i]      = 0.0;
+    }
+    for (e = 0; e < secount; e++) {
+        P->inside[e] = 0;
+        if (sx[e] <= ONEMINUS) P->perm[fcount++] = e;
+        for (k = 2*e; k <= 2*e + 1; k++) {
+            a = selist[k];
+            P->snext[k] = P->sfirst[a];
+            P->sfirst[a] = k;
+            if (P->slast[a] == -1) P->slast[a] = k;
+            P->slen[a]++;
+            if (sx[e] > 0.5) {
+                P->hc[a]++;
+                P->hs[a] += sx[e];
+            }
+        }
+    }
+
+    CCutil_double_perm_quicksort (P->perm, sx, fcount);
+
+    start_budget (w->space, w);
+    budget_support (w->space, ncount);
+
+    for (i = 0; i < fcount && !BLO_STOPPED (&w->space->W[0]); i++) {
+        e = P->perm[i];
+        a = blo_find (P->parent, selist[2*e]);
+        b = blo_find (P->parent, selist[2*e+1]);
+        if (a == b) continue;
+        if (P->slen[a] > P->slen[b]) CC_SWAP (a, b, k);
+        sweep_merge (P, selist, sx, a, b);
+        rval = sweep_test (P, &w->space->W[0], ncount, selist, sx, b, cuts,
+                           cutcount);
+        CCcheck_rval (rval, "sweep_test failed");
+    }
+    finish_budget (w->space, cuts, cutcount);
+
+CLEANUP:
+
+    if (rval && w->space) {
+        finish_budget (w->space, (CCtsp_lpcut_in **) NULL, (int *) NULL);
+    }
+    return rval;
+}
+
+/* sweep_merge joins root a (the one with the shorter slot list) into     */
+/* root b.  Only the slots of a are scanned, so over the sweep each slot  */
+/* is looked at O(log ecount) times.                                      */
+
+static void sweep_merge (blosweep *P, int *elist, double *x, int a, int b)
+{
+    int k, e;
+    double dz = 0.0, ds = 0.0;
+    int dc = 0;
+
+    for (k = P->sfirst[a]; k != -1; k = P->snext[k]) {
+        e = k / 2;
+        if (P->inside[e]) continue;
+        if (blo_find (P->parent, elist[k ^ 1]) == b) {
+            P->inside[e] = 1;
+            dz += x[e];
+            if (x[e] > 0.5) {
+                dc++;
+                ds += x[e];
+            }
+        }
+    }
+
+    P->parent[a] = b;
+    P->size[b] += P->size[a];
+    P->z[b]    += P->z[a] + dz;
+    P->hc[b]   += P->hc[a] - 2*dc;
+    P->hs[b]   += P->hs[a] - 2.0*ds;
+
+    P->snext[P->slast[b]] = P->sfirst[a];
+    P->slast[b] = P->slast[a];
+    P->slen[b] += P->slen[a];
+    P->nnext[P->nlast[b]] = P->nfirst[a];
+    P->nlast[b] = P->nlast[a];
+}
+
+/* sweep_test looks for a violated blossom with handle the component c.   */
+/* The best odd set of teeth is the set of edges leaving c with x > 0.5,  */
+/* less its smallest edge or plus the largest of the other edges if that  */
+/* set is even; hc and hs give a bound on it, and c is only scanned if    */
+/* the bound shows a violation.                                           */
+
+static int sweep_test (blosweep *P, blowork *W, int ncount, int *elist,
+        double *x, int c, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    toothobj *t = W->tlist;
+    int k, e, n, tcount = 0, hcount = P->size[c], hc = P->hc[c];
+    int tmin = -1, kmax = -1;
+    double val, xmin = 0.0, xmax = 0.0, z = P->z[c], hs = P->hs[c];
+    int rval = 0;
+
+    if (hcount < 3) goto CLEANUP;
+
+    if (hc % 2) val = hs - (double) ((hc - 1) / 2);
+    else        val = hs - (double) (hc / 2) + 0.5;
+    if (z + val <= (double) hcount + BLOTOLERANCE) goto CLEANUP;
+
+    hs = 0.0;
+    for (k = P->sfirst[c]; k != -1; k = P->snext[k]) {
+        e = k / 2;
+        if (P->inside[e]) continue;
+        if (x[e] > 0.5) {
+            if (tmin == -1 || x[e] < xmin) {
+                tmin = tcount;
+                xmin = x[e];
+            }
+            t[tcount].in  = elist[k];
+            t[tcount].out = elist[k ^ 1];
+            tcount++;
+            hs += x[e];
+        } else if (kmax == -1 || x[e] > xmax) {
+            kmax = k;
+            xmax = x[e];
+        }
+    }
+
+    if (tcount % 2 == 0) {
+        if (kmax != -1 && (tcount == 0 || xmax > 1.0 - xmin)) {
+            t[tcount].in  = elist[kmax];
+            t[tcount].out = elist[kmax ^ 1];
+            tcount++;
+            hs += xmax;
+        } else if (tcount > 0) {
+            t[tmin] = t[--tcount];
+            hs -= xmin;
+        }
+    }
+    if (tcount == 0) goto CLEANUP;
+    if (z + hs <= (double) hcount + (double) ((tcount - 1) / 2) +
+                  BLOTOLERANCE) {
+        goto CLEANUP;
+    }
+
+    for (n = P->nfirst[c], k = 0; n != -1; n = P->nnext[n]) {
+        W->hlist[k++] = n;
+    }
+    rval = work_blossom (ncount, hcount, W->hlist, tcount, t, W, cuts,
+                         cutcount);
+    CCcheck_rval (rval, "work_blossom failed");
+
+CLEANUP:
+
+    return rval;
+}
+
+static void init_blobudget (blobudget *K)
+{
+    K->maxcuts = 0;
+    K->minviol = 0.0;
+    K->kspace  = 0;
+    K->count   = 0;
+    K->stop    = 0;
+    K->cut     = (CCtsp_lpcut_in **) NULL;
+    K->viol    = (double *) NULL;
+    K->comp    = (int *) NULL;
+    K->seq     = (int *) NULL;
+    K->B       = (blograph *) NULL;
+#ifdef CC_POSIXTHREADS
+    K->lock    = (pthread_mutex_t *) NULL;
+#endif
+}
+
+static void free_blobudget (blobudget *K)
+{
+    int i;
+
+    for (i = 0; i < K->count; i++) free_cutlist (K->cut[i]);
+    K->count  = 0;
+    K->kspace = 0;
+    CC_IFFREE (K->cut, CCtsp_lpcut_in *);
+    CC_IFFREE (K->viol, double);
+    CC_IFFREE (K->comp, int);
+    CC_IFFREE (K->seq, int);
+}
+
+static int size_blobudget (blobudget *K, int maxcuts)
+{
+    int rval = 0;
+
+    if (maxcuts <= K->kspace) goto CLEANUP;
+
+    free_blobudget (K);
+    K->cut  = CC_SAFE_MALLOC (maxcuts, CCtsp_lpcut_in *);
+    K->viol = CC_SAFE_MALLOC (maxcuts, double);
+    K->comp = CC_SAFE_MALLOC (maxcuts, int);
+    K->seq  = CC_SAFE_MALLOC (maxcuts, int);
+    if (!K->cut || !K->viol || !K->comp || !K->seq) {
+        fprintf (stderr, "out of memory in size_blobudget\n");
+        free_blobudget (K);
+        rval = 1; goto CLEANUP;
+    }
+    K->kspace = maxcuts;
+
+CLEANUP:
+
+    return rval;
+}
+
+/* start_budget sets up S->K for a call with the budget of w (the heap is */
+/* sized by size_blospace), and hands it to the blowork of each thread    */
+/* if there is a budget at all.                                           */
+
+static void start_budget (blospace *S, CCtsp_blossom_workspace *w)
+{
+    blobudget *K = &S->K;
+    int i, active;
+
+    K->maxcuts = (w->maxcuts > 0 ? w->maxcuts : 0);
+    K->minviol = w->minviol;
+    K->count   = 0;
+    K->stop    = 0;
+    K->B       = &S->B;
+#ifdef CC_POSIXTHREADS
+    K->lock    = (pthread_mutex_t *) NULL;
+#endif
+    active = (K->maxcuts > 0 || K->minviol > 0.0);
+
+    for (i = 0; i < S->wcount; i++) {
+        S->W[i].budget = (active ? K : (blobudget *) NULL);
+        S->W[i].comp   = 0;
+        S->W[i].seq    = 0;
+    }
+}
+
+/* finish_budget moves the cuts in the heap to the front of cuts, most    */
+/* violated first, and adds their number to cutcount; with cuts NULL the  */
+/* cuts are freed.                                                        */
+
+static void finish_budget (blospace *S, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    blobudget *K = &S->K;
+    CCtsp_lpcut_in *list = (CCtsp_lpcut_in *) NULL, *lc;
+    int i, n = K->count;
+
+    while (K->count > 0) {
+        lc = K->cut[0];
+        K->count--;
+        if (K->count > 0) {
+            K->cut[0]  = K->cut[K->count];
+            K->viol[0] = K->viol[K->count];
+            K->comp[0] = K->comp[K->count];
+            K->seq[0]  = K->seq[K->count];
+            budget_siftdown (K, 0);
+        }
+        lc->next = list;
+        list = lc;
+    }
+
+    if (cuts) {
+        if (list) {
+            for (lc = list; lc->next; lc = lc->next);
+            lc->next = *cuts;
+            *cuts = list;
+        }
+        if (cutcount) *cutcount += n;
+    } else {
+        free_cutlist (list);
+    }
+
+    for (i = 0; i < S->wcount; i++) S->W[i].budget = (blobudget *) NULL;
+}
+
+/* budget_beats checks whether a cut (viol, comp, seq) is better than the */
+/* one at place pos of the heap.                                          */
+
+static int budget_beats (blobudget *K, double viol, int comp, int seq, int pos)
+{
+    if (viol != K->viol[pos]) return viol > K->viol[pos];
+    if (comp != K->comp[pos]) return comp < K->comp[pos];
+    return seq < K->seq[pos];
+}
+
+static void budget_swap (blobudget *K, int i, int j)
+{
+    CCtsp_lpcut_in *lc;
+    double v;
+    int t;
+
+    CC_SWAP (K->cut[i], K->cut[j], lc);
+    CC_SWAP (K->viol[i], K->viol[j], v);
+    CC_SWAP (K->comp[i], K->comp[j], t);
+    CC_SWAP (K->seq[i], K->seq[j], t);
+}
+
+static void budget_siftdown (blobudget *K, int i)
+{
+    int c;
+
+    while ((c = 2*i + 1) < K->count) {
+        if (c + 1 < K->count &&
+            budget_beats (K, K->viol[c], K->comp[c], K->seq[c], c + 1)) {
+            c++;
+        }
+        if (!budget_beats (K, K->viol[i], K->comp[i], K->seq[i], c)) break;
+        budget_swap (K, i, c);
+        i = c;
+    }
+}
+
+/* budget_insert puts lc into the heap, pushing out the worst cut if the  */
+/* heap is full (lc itself is freed if it is the worst).  The budget is   */
+/* met, and the searches stop, once the heap is full of cuts violated by  */
+/* at least minviol > 0.  Called with the lock held.                      */
+
+static void budget_insert (blobudget *K, CCtsp_lpcut_in *lc, double viol,
+        int comp, int seq)
+{
+    int i, p;
+
+    if (K->count < K->maxcuts) {
+        i = K->count++;
+        K->cut[i]  = lc;
+        K->viol[i] = viol;
+        K->comp[i] = comp;
+        K->seq[i]  = seq;
+        while (i > 0) {
+            p = (i - 1) / 2;
+            if (!budget_beats (K, K->viol[p], K->comp[p], K->seq[p], i)) break;
+            budget_swap (K, i, p);
+            i = p;
+        }
+    } else if (budget_beats (K, viol, comp, seq, 0)) {
+        free_cutlist (K->cut[0]);
+        K->cut[0]  = lc;
+        K->viol[0] = viol;
+        K->comp[0] = comp;
+        K->seq[0]  = seq;
+        budget_siftdown (K, 0);
+    } else {
+        free_cutlist (lc);
+    }
+
+    if (K->minviol > 0.0 && K->count == K->maxcuts) K->stop = 1;
+}
+
+/* budget_blossom is add_blossom under a budget: the violation is found   */
+/* first, and the cut is only built if it is large enough and (with       */
+/* maxcuts) beats the worst cut in the heap.                              */
+
+static int budget_blossom (int ncount, int hcount, int *handle, int tcount,
+        toothobj *teeth, blowork *W, CCtsp_lpcut_in **cuts, int *cutcount)
+{
+    blobudget *K = W->budget;
+    CCtsp_lpcut_in *lc = (CCtsp_lpcut_in *) NULL;
+    double viol;
+    int room, lcount = 0, seq = W->seq++;
+    int rval = 0;
+
+    viol = blossom_violation (K->B, W, hcount, handle, tcount, teeth);
+    if (viol <= 0.0 || viol < K->minviol) goto CLEANUP;
+
+    if (K->maxcuts == 0) {
+        rval = add_blossom (ncount, hcount, handle, tcount, teeth, cuts,
+                            cutcount);
+        CCcheck_rval (rval, "add_blossom failed");
+        goto CLEANUP;
+    }
+
+    BUDGET_LOCK (K);
+    room = (K->count < K->maxcuts ||
+            budget_beats (K, viol, W->comp, seq, 0));
+    BUDGET_UNLOCK (K);
+    if (!room) goto CLEANUP;
+
+    rval = add_blossom (ncount, hcount, handle, tcount, teeth, &lc, &lcount);
+    CCcheck_rval (rval, "add_blossom failed");
+
+    BUDGET_LOCK (K);
+    budget_insert (K, lc, viol, W->comp, seq);
+    BUDGET_UNLOCK (K);
+
+CLEANUP:
+
+    return rval;
+}
+
+/* blossom_violation returns 3*tcount + 1 less x(delta(handle)) + the sum */
+/* of x(delta(tooth)), the violation of the comb form of the blossom.     */
+
+static double blossom_violation (blograph *B, blowork *W, int hcount,
+        int *handle, int tcount, toothobj *teeth)
+{
+    int i, k, e, n, o;
+    double lhs = 0.0;
+
+    for (i = 0; i < hcount; i++) W->hmark[handle[i]] = 1;
+    for (i = 0; i < hcount; i++) {
+        n = handle[i];
+        for (k = B->adjbeg[n]; k < B->adjbeg[n+1]; k++) {
+            e = B->adjlist[k];
+            if (!W->hmark[BLO_OTHEREND (B, e, n)]) lhs += B->x[e];
+        }
+    }
+    for (i = 0; i < hcount; i++) W->hmark[handle[i]] = 0;
+
+    for (i = 0; i < tcount; i++) {
+        n = teeth[i].in;
+        o = teeth[i].out;
+        for (k = B->adjbeg[n]; k < B->adjbeg[n+1]; k++) {
+            e = B->adjlist[k];
+            if (BLO_OTHEREND (B, e, n) != o) lhs += B->x[e];
+        }
+        for (k = B->adjbeg[o]; k < B->adjbeg[o+1]; k++) {
+            e = B->adjlist[k];
+            if (BLO_OTHEREND (B, e, o) != n) lhs += B->x[e];
+        }
+    }
+
+    return (double) (3*tcount + 1) - lhs;
+}
@@ -24,10 +24,19 @@
 /*   A. Goldberg and R. Tarjan, "A new approach to the maximum-flow         */
 /*   problem",  Journal of the ACM 35 (1988) 921-940.                       */
 /*                                                                          */
+/*  The same network can also be cut by the pseudoflow algorithm of         */
+/*   D. Hochbaum, "The pseudoflow algorithm: a new algorithm for the        */
+/*   maximum-flow problem", Operations Research 56 (2008) 992-1009,         */
+/*  and by the augmenting path algorithm of                                 */
+/*   Y. Boykov and V. Kolmogorov, "An experimental comparison of            */
+/*   min-cut/max-flow algorithms for energy minimization in vision",        */
+/*   IEEE PAMI 26 (2004) 1124-1137.                                         */
+/*                                                                          */
 /*    EXPORTED FUNCTIONS:                                                   */
 /*                                                                          */
 /*  int CCcut_mincut_st (int ncount, int ecount, int *elist, double *ecap,  */
-/*      int s, int t, double *value, int **cut, int *cutcount)              */
+/*      int s, int t, double *value, int **cut, int *cutcount,              */
+/*      int flowalg)                                                        */
 /*    COMPUTES the min st-cut in a directed or undirected graph.            */
 /*      -ncount is the number of nodes in the graph.                        */
 /*      -ecount is the number of directed (undirected) edges.               */
@@ -42,18 +51,95 @@
 /*       array of the appropriate size.                                     */
 /*      -cutcount returns the number of nodes in the listed cut, if cut     */
 /*       is not NULL (if cut is NULL, then cutcount can be NULL).           */
+/*      -flowalg is the max-flow code: CC_FLOW_HIGHEST_LABEL or             */
+/*       CC_FLOW_FIFO (push-relabel, taking the active node with the        */
+/*       highest label or the oldest one), CC_FLOW_PSEUDOFLOW (Hochbaum,    */
+/*       highest label first) or CC_FLOW_BK (Boykov-Kolmogorov).  The       */
+/*       cut value does not depend on the code.  The push-relabel and BK    */
+/*       codes return the smallest side containing t of a minimum cut;      */
+/*       the pseudoflow code can return another minimum cut.                */
+/*                                                                          */
+/*  int CCcut_flowctx_create (CCcut_flowctx **F, int ncount, int ecount,    */
+/*      int *elist, double *ecap)                                           */
+/*    BUILDS the flow network once, for a sequence of s-t cuts on the       */
+/*     same graph (the arguments are as in CCcut_mincut_st).                */
+/*                                                                          */
+/*    ncount and ecount may be 0, to get an empty context that is filled    */
+/*     in later with CCcut_flowctx_load.                                    */
+/*                                                                          */
+/*  int CCcut_flowctx_load (CCcut_flowctx *F, int ncount, int ecount,       */
+/*      int *elist, double *ecap)                                           */
+/*    REPLACES the network of F by a new graph.  The node and edge arrays   */
+/*     of F are reused, and only grow if the new graph is larger than any   */
+/*     graph F has held so far.                                             */
+/*                                                                          */
+/*  int CCcut_flowctx_solve (CCcut_flowctx *F, int s, int t,                */
+/*      double *value, int *cut, int *cutcount)                             */
+/*    COMPUTES the min st-cut in the network of F.  Only the flows and      */
+/*     labels are reset, nothing is allocated.                              */
+/*      -cut (if not NULL) should have room for ncount nodes; it returns    */
+/*       the side that contains t, as in CCcut_mincut_st.                   */
+/*                                                                          */
+/*  int CCcut_flowctx_algorithm (CCcut_flowctx *F, int flowalg)             */
+/*    SETS the max-flow code used by the solves of F (see flowalg in        */
+/*     CCcut_mincut_st; the default is CC_FLOW_HIGHEST_LABEL).              */
+/*                                                                          */
+/*  int CCcut_flowctx_setcap (CCcut_flowctx *F, int e, double cap)          */
+/*    SETS the capacity of edge e (its index in the elist of the last       */
+/*     create or load) to cap; it is used by the next solve.                */
+/*                                                                          */
+/*  void CCcut_flowctx_warmstart (CCcut_flowctx *F, int on)                 */
+/*    TURNS warm starts on (on = 1) or off (on = 0, the default).  With     */
+/*     warm starts, a solve begins from the flow left by the one before     */
+/*     it, if that flow still fits the new s-t pair: the only node short    */
+/*     of flow is s (after turning the flow around, or exchanging s and t,  */
+/*     in the undirected case).  The distance labels are set by the usual   */
+/*     global relabel.  Otherwise the solve starts from zero.  The cut      */
+/*     value is the same either way, but the cut may be a different         */
+/*     minimum cut.  Each warm solve ends by sending its stuck excess back  */
+/*     to s, so that the next one starts from a flow.  This pays off when   */
+/*     the same pair is solved again after some capacities go up; when the  */
+/*     pair changes, as in a Gomory-Hu tree, the old flow is mostly in the  */
+/*     way and a cold start is faster.  Only the push-relabel codes         */
+/*     start warm; the others always start from zero.                       */
+/*                                                                          */
+/*  void CCcut_flowctx_counts (CCcut_flowctx *F, long *pushes,              */
+/*      long *relabels, int *warm)                                          */
+/*    RETURNS the number of pushes and relabels, and the number of warm     */
+/*     started solves, since F was created (any of the pointers can be      */
+/*     NULL).  The pseudoflow code counts its mergers as pushes, and the    */
+/*     BK code counts augmenting paths as pushes and adopted orphans as     */
+/*     relabels.                                                            */
+/*                                                                          */
+/*  void CCcut_flowctx_destroy (CCcut_flowctx **F)                          */
+/*    FREES the network and sets *F to NULL.                                */
+/*                                                                          */
+/*  int CCcut_scale_capacities (int ecount, double *ecap, double *icap,     */
+/*      int bits, double *scale)                                            */
+/*    ROUNDS the capacities to integers, so the flows are computed exactly. */
+/*      -ecap lists the ecount capacities (none of them negative).          */
+/*      -icap returns each capacity times scale, rounded to the nearest     */
+/*       integer (icap can be ecap).                                        */
+/*      -bits is 32 or 64; scale is the largest power of 2 that keeps the   */
+/*       total of icap below 2^31 (for 32) or 2^53 (for 64, the largest     */
+/*       integer range a double holds exactly).                             */
+/*      -scale returns the factor; cut values divided by it are in the      */
+/*       units of ecap.                                                     */
 /*                                                                          */
 /*    NOTES:                                                                */
 /*      Returns 0 if it worked and 1 otherwise (for example, when one       */
 /*      of the mallocs failed). The nodes in the graph should be named      */
 /*      0 through #nodes - 1.                                               */
 /*                                                                          */
+/*      The residuals are doubles.  When the capacities are integers (as    */
+/*      after CCcut_scale_capacities) every push, merger and augmentation   */
+/*      is exact, so the PRF_EPSILON tests cannot misjudge an arc.          */
+/*                                                                          */
 /*      Define UNDIRECTED_GRAPH to compile the code for undirected          */
 /*      graphs. (This appears to be the way to go for tsp instances.)       */
 /*                                                                          */
-/*      Two node selection rules are implemented: queue and highest         */
-/*      label. One of QUEUE_PRF and HIGHEST_LABEL_PRF must be defined       */
-/*      (but not both).                                                     */
+/*      Two node selection rules are implemented for push-relabel: queue    */
+/*      (CC_FLOW_FIFO) and highest label (CC_FLOW_HIGHEST_LABEL).           */
 /*                                                                          */
 /*      The code can carry out global relabelings via a backwards           */
 /*      breadth-first-search from the sink. The frequency of the            */
@@ -79,108 +165,99 @@
 
 #define UNDIRECTED_GRAPH
 
-#define HIGHEST_LABEL_PRF
-#undef  QUEUE_PRF
-
 #define USE_GAP
 #define GLOBAL_RELABEL_FREQUENCY 1.0
 
 #define INFINITY (1<<30)
 #define PRF_EPSILON 0.000000001
-#define GOING_IN  0
-#define GOING_OUT 1
 
-#ifdef QUEUE_PRF
-#define ADD_TO_ACTIVE(n) {                                                \
-    if (!(n)->active) {                                                   \
-        (n)->qnext = (node *) NULL;                                       \
-        if (qtail) {                                                      \
-            qtail->qnext = (n);                                           \
+#define FLOW_COLD   0      /* start from the zero flow                    */
+#define FLOW_WARM   1      /* start from the flow already on the edges    */
+#define FLOW_RETURN 2      /* send the excess left by a solve back to s   */
+
+#define BK_FREE      0     /* the tree of a node in the BK code           */
+#define BK_SOURCE    1
+#define BK_SINK      2
+#define BK_ORPHAN   -1     /* parc of a node with no parent               */
+#define BK_TERMINAL -2     /* parc of s and t                             */
+
+#define BK_PARENT(n)                                                      \
+    (side[n] == BK_SOURCE ? head[mate[parc[n]]] : head[parc[n]])
+
+#define BK_ACTIVATE(n) {                                                  \
+    if (!active[n]) {                                                     \
+        qnext[n] = -1;                                                    \
+        if (qtail != -1) {                                                \
+            qnext[qtail] = (n);                                           \
         } else {                                                          \
             qhead = (n);                                                  \
         }                                                                 \
         qtail = (n);                                                      \
-        (n)->active = 1;                                                  \
+        active[n] = 1;                                                    \
     }                                                                     \
 }
-#endif
 
-#ifdef HIGHEST_LABEL_PRF
 #define ADD_TO_ACTIVE(n) {                                                \
-    if (!(n)->active) {                                                   \
-        (n)->highnext = high[(n)->flowlabel];                             \
-        high[(n)->flowlabel] = (n);                                       \
-        if (G->highest < (n)->flowlabel)                                  \
-            G->highest = (n)->flowlabel;                                  \
-        (n)->active = 1;                                                  \
+    if (!active[n]) {                                                     \
+        if (fifo) {                                                       \
+            qnext[n] = -1;                                                \
+            if (qtail != -1) {                                            \
+                qnext[qtail] = (n);                                       \
+            } else {                                                      \
+                qhead = (n);                                              \
+            }                                                             \
+            qtail = (n);                                                  \
+        } else {                                                          \
+            highnext[n] = high[label[n]];                                 \
+            high[label[n]] = (n);                                         \
+            if (G->highest < label[n])                                    \
+                G->highest = label[n];                                    \
+        }                                                                 \
+        active[n] = 1;                                                    \
     }                                                                     \
 }
-#endif
 
-#ifdef UNDIRECTED_GRAPH
-#define RELABEL_BODY(n)                                                   \
-    for (rele = (n)->out; rele; rele = rele->outnext) {                   \
-        if (rele->cap - rele->flow > PRF_EPSILON &&                       \
-                (relt = rele->ends[1]->flowlabel) < relm)                 \
-            relm = relt;                                                  \
-    }                                                                     \
-    for (rele = (n)->in; rele; rele = rele->innext) {                     \
-        if (rele->cap + rele->flow > PRF_EPSILON &&                       \
-                 (relt = rele->ends[0]->flowlabel) < relm)                \
-            relm = relt;                                                  \
-    }                                                                     \
-    (n)->flowlabel = ++relm;
-#else
 #define RELABEL_BODY(n)                                                   \
-    for (rele = (n)->out; rele; rele = rele->outnext) {                   \
-        if (rele->cap - rele->flow > PRF_EPSILON &&                       \
-                (relt = rele->ends[1]->flowlabel) < relm)                 \
-            relm = relt;                                                  \
-    }                                                                     \
-    for (rele = (n)->in; rele; rele = rele->innext) {                     \
-        if (rele->flow > PRF_EPSILON &&                                   \
-                 (relt = rele->ends[0]->flowlabel) < relm)                \
+    G->nrelabel++;                                                        \
+    for (rela = first[n]; rela < first[(n)+1]; rela++) {                  \
+        if (res[rela] > PRF_EPSILON &&                                    \
+                (relt = label[head[rela]]) < relm)                        \
             relm = relt;                                                  \
     }                                                                     \
-    (n)->flowlabel = ++relm;
-#endif
+    label[n] = ++relm;
 
 #ifdef USE_GAP
 #define RELABEL(n) {                                                      \
     int relm = INFINITY;                                                  \
-    edge *rele;                                                           \
-    int relt, relold = (n)->flowlabel;                                    \
+    int rela, relt, relold = label[n];                                    \
                                                                           \
     RELABEL_BODY(n)                                                       \
                                                                           \
-    if ((n)->levelprev) {                                                 \
-        (n)->levelprev->levelnext = (n)->levelnext;                       \
-    } else {                                                              \
-        level[relold] = (n)->levelnext;                                   \
+    if (relold < ncount) {                                                \
+        if (levelprev[n] != -1) {                                         \
+            levelnext[levelprev[n]] = levelnext[n];                       \
+        } else {                                                          \
+            level[relold] = levelnext[n];                                 \
+        }                                                                 \
+        if (levelnext[n] != -1)                                           \
+            levelprev[levelnext[n]] = levelprev[n];                       \
     }                                                                     \
-    if ((n)->levelnext)                                                   \
-        (n)->levelnext->levelprev = (n)->levelprev;                       \
                                                                           \
     if (relm < ncount) {                                                  \
-        if (level[relm]) {                                                \
-            level[relm]->levelprev = (n);                                 \
-            (n)->levelnext = level[relm];                                 \
-            (n)->levelprev = (node *) NULL;                               \
-            level[relm] = (n);                                            \
-        } else {                                                          \
-            (n)->levelprev = (node *) NULL;                               \
-            (n)->levelnext = (node *) NULL;                               \
-            level[relm] = (n);                                            \
-        }                                                                 \
-        if (!level[relold]) {                                             \
+        levelprev[n] = -1;                                                \
+        levelnext[n] = level[relm];                                       \
+        if (level[relm] != -1)                                            \
+            levelprev[level[relm]] = (n);                                 \
+        level[relm] = (n);                                                \
+        if (level[relold] == -1) {                                        \
             relold++;                                                     \
-            while (level[relold]) {                                       \
-                node *relno;                                              \
-                for (relno = level[relold]; relno;                        \
-                                            relno = relno->levelnext) {   \
-                    relno->flowlabel = ncount;                            \
+            while (level[relold] != -1) {                                 \
+                int relno;                                                \
+                for (relno = level[relold]; relno != -1;                  \
+                                            relno = levelnext[relno]) {   \
+                    label[relno] = ncount;                                \
                 }                                                         \
-                level[relold] = (node *) NULL;                            \
+                level[relold] = -1;                                       \
                 relold++;                                                 \
             }                                                             \
         }                                                                 \
@@ -189,79 +266,124 @@
 #else
 #define RELABEL(n) {                                                      \
     int relm = INFINITY;                                                  \
-    edge *rele;                                                           \
-    int relt;                                                             \
+    int rela, relt;                                                       \
                                                                           \
     RELABEL_BODY(n)                                                       \
 }
 #endif /* USE_GAP */
 
-typedef struct edge {
-    struct node     *ends[2];
-    struct edge     *innext;
-    struct edge     *outnext;
-    double          cap;
-    double          flow;
-} edge;
-
-typedef struct node {
-    struct  node    *qnext;
-    struct  node    *tnext;
-#ifdef USE_GAP
-    struct  node    *levelnext;
-    struct  node    *levelprev;
-#endif
-#ifdef HIGHEST_LABEL_PRF
-    struct  node    *highnext;
-#endif
-    struct  edge    *in;
-    struct  edge    *out;
-    struct  edge    *incurrent;
-    struct  edge    *outcurrent;
-    double           excess;
-    int              magiclabel;
-    int              flowlabel;
-    char             inout;
-    char             active;
-} node;
+/* The network is stored in forward-star form.  The arcs leaving node v   */
+/* are first[v] through first[v+1]-1 (those of the edges with v as their */
+/* first end, then those with v as their second end, each in decreasing  */
+/* edge order, the order the old edge lists had), arc a runs to head[a]   */
+/* with residual capacity res[a], and mate[a] is the arc running the     */
+/* other way.  fwd[e] is the arc of edge e that leaves its first end.    */
+/* The node fields used in push and relabel are kept in their own dense   */
+/* arrays; current[v] is the next arc of v to try.                        */
+/*                                                                        */
+/* The pseudoflow code keeps its trees in parent (with parc[v] the arc    */
+/* from v to its parent) and in the child, sibling and sibprev lists, and */
+/* scan[v] is the next child of v to visit when the tree is searched; its */
+/* strong roots wait in the high buckets and the nodes of each label are  */
+/* linked in the level lists.  The BK code marks the tree of each node in */
+/* side, with parc[v] the tree arc at v (from the parent in the source    */
+/* tree, to the parent in the sink tree), label as the distance to the    */
+/* root, and stamp as the time that distance was last checked; scan holds */
+/* the orphans.                                                           */
 
 typedef struct graph {
-    struct  node    *nodelist;
-    struct  edge    *edgelist;
-#ifdef USE_GAP
-    struct  node   **level;
-#endif
-#ifdef HIGHEST_LABEL_PRF
-    struct  node   **high;
+    int             *first;
+    int             *head;
+    int             *mate;
+    double          *res;
+    int             *fwd;
+    double          *cap;
+    double          *excess;
+    int             *label;
+    int             *current;
+    int             *magiclabel;
+    int             *tnext;
+    char            *active;
+    int             *level;
+    int             *levelnext;
+    int             *levelprev;
+    int             *high;
+    int             *highnext;
     int              highest;
-#endif
+    int             *qnext;
+    int             *parent;
+    int             *parc;
+    int             *child;
+    int             *sibling;
+    int             *sibprev;
+    int             *scan;
+    int             *stamp;
+    char            *side;
+    int              alg;
     int              nnodes;
     int              nedges;
     int              magicnum;
+    long             npush;
+    long             nrelabel;
 } graph;
 
+/* haveflow is set when the arcs hold the flow of the last solve.         */
+
+struct CCcut_flowctx {
+    graph            G;
+    int              nspace;
+    int              espace;
+    int              warmstart;
+    int              haveflow;
+    int              nwarm;
+};
 
 
 static void
-    setlabels (graph *G, node *s, node *t),
-    backwards_bfs (node *s, int K, graph *G),
+    setlabels (graph *G, int s, int t, int mode),
+    backwards_bfs (int s, int K, graph *G),
+    coldstart (graph *G),
+    pf_relabel (graph *G, int v),
+    pf_addchild (graph *G, int p, int v),
+    pf_cutchild (graph *G, int p, int v),
+    pf_addroot (graph *G, int v),
+    pf_lift (graph *G, int k),
+    pf_merge (graph *G, int r, int v, int a),
     init_graph (graph *G),
     free_graph (graph *G);
 static int
-    grab_the_cut (graph *G, node *n, int **cut, int *cutcount),
-    buildgraph (graph *G, int ncount, int ecount, int *elist, double *gap);
+    bad_alg (int flowalg),
+    grab_the_cut (graph *G, int n, int **cut, int *cutcount),
+    sink_side (graph *G, int n, int *cut),
+    collect_cut (graph *G, int n, int *cut),
+    warm_orient (graph *G, int s, int t),
+    pf_findarc (graph *G, int v),
+    bk_dist (graph *G, int v, int time),
+    buildgraph (graph *G, int ncount, int ecount, int *elist, double *gap),
+    graphspace (graph *G, int ncount, int ecount),
+    linkgraph (graph *G, int ncount, int ecount, int *elist, double *ecap);
 static double
-    flow (graph *G, node *s, node *t);
+    maxflow (graph *G, int s, int t, int mode),
+    flow (graph *G, int s, int t, int mode),
+    pseudoflow (graph *G, int s, int t),
+    bkflow (graph *G, int s, int t);
 
 
 int CCcut_mincut_st (int ncount, int ecount, int *elist, double *ecap,
-            int s, int t, double *value, int **cut, int *cutcount)
+            int s, int t, double *value, int **cut, int *cutcount,
+            int flowalg)
 {
     int rval = 0;
     graph G;
 
     init_graph (&G);
 
+    if (bad_alg (flowalg)) {
+        fprintf (stderr, "unknown flow algorithm %d\n", flowalg);
+        rval = 1; goto CLEANUP;
+    }
+    G.alg = flowalg;
+
     if (cut) {
         *cut = (int *) NULL;
         if (cutcount) {
@@ -276,9 +398,9 @@ int CCcut_mincut_st (int ncount, int ecount, int *elist, double *ecap,
     if (rval) {
         fprintf (stderr, "Buildgraph failed\n"); goto CLEANUP;
     }
-    *value = flow (&G, G.nodelist + s, G.nodelist + t);
+    *value = maxflow (&G, s, t, FLOW_COLD);
     if (cut) {
-        rval = grab_the_cut (&G, G.nodelist + t, cut, cutcount);
+        rval = grab_the_cut (&G, t, cut, cutcount);
         if (rval) {
             fprintf (stderr, "grab_the_cut failed\n"); goto CLEANUP;
         }
@@ -291,340 +413,1038 @@ CLEANUP:
     return rval;
 }
 
-static double flow (graph *G, node *s, node *t)
+int CCcut_flowctx_create (CCcut_flowctx **F, int ncount, int ecount,
+        int *elist, double *ecap)
 {
-#ifdef QUEUE_PRF
-    node *qhead = (node *) NULL;
-    node *qtail = (node *) NULL;
+    int rval = 0;
+
+    *F = CC_SAFE_MALLOC (1, CCcut_flowctx);
+    if (!(*F)) {
+        fprintf (stderr, "out of memory in CCcut_flowctx_create\n");
+        rval = 1; goto CLEANUP;
+    }
+    init_graph (&(*F)->G);
+    (*F)->nspace = 0;
+    (*F)->espace = 0;
+    (*F)->warmstart = 0;
+    (*F)->haveflow = 0;
+    (*F)->nwarm = 0;
+
+    rval = CCcut_flowctx_load (*F, ncount, ecount, elist, ecap);
+    if (rval) {
+        fprintf (stderr, "CCcut_flowctx_load failed\n"); goto CLEANUP;
+    }
+
+CLEANUP:
+
+    if (rval) CCcut_flowctx_destroy (F);
+    return rval;
+}
+
+int CCcut_flowctx_load (CCcut_flowctx *F, int ncount, int ecount,
+        int *elist, double *ecap)
+{
+    graph *G = &F->G;
+    int nspace = F->nspace, espace = F->espace;
+    int rval = 0;
+
+    F->haveflow = 0;
+
+    if (ncount > nspace || ecount > espace) {
+        if (ncount > nspace) nspace = ncount;
+        if (ecount > espace) espace = ecount;
+        free_graph (G);
+        F->nspace = 0;
+        F->espace = 0;
+        rval = graphspace (G, nspace, espace);
+        if (rval) {
+            fprintf (stderr, "graphspace failed\n"); goto CLEANUP;
+        }
+        F->nspace = nspace;
+        F->espace = espace;
+    }
+
+    if (ncount > 0) {
+        rval = linkgraph (G, ncount, ecount, elist, ecap);
+        if (rval) {
+            fprintf (stderr, "linkgraph failed\n"); goto CLEANUP;
+        }
+    } else {
+        G->nnodes = 0;
+        G->nedges = 0;
+    }
+
+CLEANUP:
+
+    if (rval) {
+        G->nnodes = 0;
+        G->nedges = 0;
+    }
+    return rval;
+}
+
+int CCcut_flowctx_setcap (CCcut_flowctx *F, int e, double cap)
+{
+    graph *G = &F->G;
+    int a;
+    double f;
+
+    if (e < 0 || e >= G->nedges) {
+        fprintf (stderr, "bad edge %d in CCcut_flowctx_setcap\n", e);
+        return 1;
+    }
+    a = G->fwd[e];
+    f = G->cap[e] - G->res[a];
+    G->cap[e] = cap;
+    G->res[a] = cap - f;
+#ifdef UNDIRECTED_GRAPH
+    G->res[G->mate[a]] = cap + f;
 #endif
-    node *n;
-    edge *e;
-    int count, round;
-    int i;
-    int ncount = G->nnodes;
-    edge *edgelist = G->edgelist;
-    node *nodelist = G->nodelist;
+    if (f > cap || -f > cap) {
+        F->haveflow = 0;
+    }
+    return 0;
+}
+
+int CCcut_flowctx_algorithm (CCcut_flowctx *F, int flowalg)
+{
+    if (bad_alg (flowalg)) {
+        fprintf (stderr, "unknown flow algorithm %d\n", flowalg);
+        return 1;
+    }
+    F->G.alg = flowalg;
+    return 0;
+}
+
+void CCcut_flowctx_warmstart (CCcut_flowctx *F, int on)
+{
+    F->warmstart = on;
+}
+
+int CCcut_scale_capacities (int ecount, double *ecap, double *icap,
+        int bits, double *scale)
+{
+    double total = 0.0;
+    int i, ex;
+
+    if (bits != 32 && bits != 64) {
+        fprintf (stderr, "bad integer size %d in CCcut_scale_capacities\n",
+                 bits);
+        return 1;
+    }
+    for (i = 0; i < ecount; i++) {
+        if (ecap[i] < 0.0) {
+            fprintf (stderr, "negative capacity in CCcut_scale_capacities\n");
+            return 1;
+        }
+        total += ecap[i];
+    }
+
+    /* total < 2^ex, so scale * total < 2^(limit-1) leaves room for the */
+    /* ecount halves added by the rounding                               */
+    *scale = 1.0;
+    if (total > 0.0) {
+        (void) frexp (total, &ex);
+        *scale = ldexp (1.0, (bits == 32 ? 31 : 53) - 1 - ex);
+    }
+    for (i = 0; i < ecount; i++) {
+        icap[i] = floor (ecap[i] * (*scale) + 0.5);
+    }
+    return 0;
+}
+
+static int bad_alg (int flowalg)
+{
+    return (flowalg != CC_FLOW_HIGHEST_LABEL && flowalg != CC_FLOW_FIFO &&
+            flowalg != CC_FLOW_PSEUDOFLOW && flowalg != CC_FLOW_BK);
+}
+
+void CCcut_flowctx_counts (CCcut_flowctx *F, long *pushes, long *relabels,
+        int *warm)
+{
+    if (pushes)   *pushes   = F->G.npush;
+    if (relabels) *relabels = F->G.nrelabel;
+    if (warm)     *warm     = F->nwarm;
+}
+
+int CCcut_flowctx_solve (CCcut_flowctx *F, int s, int t, double *value,
+        int *cut, int *cutcount)
+{
+    graph *G = &F->G;
+    int pr = (G->alg == CC_FLOW_HIGHEST_LABEL || G->alg == CC_FLOW_FIFO);
+    int i, k, warm = 0;
+
+    if (s < 0 || s >= G->nnodes || t < 0 || t >= G->nnodes || s == t) {
+        fprintf (stderr, "bad s-t pair %d %d in CCcut_flowctx_solve\n", s, t);
+        return 1;
+    }
+
 #ifdef USE_GAP
-    node **level = G->level;
-#endif
-#ifdef HIGHEST_LABEL_PRF
-    node **high = G->high;
+    /* a gap can leave stale buckets above an empty one; clear them all */
+    for (i = 0; i <= G->nnodes; i++) {
+        G->level[i] = -1;
+    }
 #endif
 
-/*
-    printf ("Find cut separating %d and %d ...\n", s - nodelist, t - nodelist);
-    fflush (stdout);
-*/
+    if (F->warmstart && F->haveflow && pr) {
+        warm = warm_orient (G, s, t);
+    }
+    if (warm == 2) {
+        k = s; s = t; t = k;        /* the old flow fits the pair (t, s) */
+    }
 
-    for (i = 0; i < ncount; i++) {
-        nodelist[i].excess = 0.0;
-        nodelist[i].active = 0;
-#ifdef HIGHEST_LABEL_PRF
-        high[i] = (node *) NULL;
-#endif
+    *value = maxflow (G, s, t, warm ? FLOW_WARM : FLOW_COLD);
+    if (warm) F->nwarm++;
+
+    if (cut) {
+        i = sink_side (G, t, cut);
+        if (warm == 2) {
+            /* the side of the original t is the other side */
+            for (i = 0, k = 0; k < G->nnodes; k++) {
+                if (G->magiclabel[k] != G->magicnum) cut[i++] = k;
+            }
+        }
+        if (cutcount) *cutcount = i;
     }
-#ifdef HIGHEST_LABEL_PRF
-    G->highest = 0;
+
+    if (!pr) {
+        F->haveflow = 0;            /* only push-relabel starts warm */
+    } else if (F->warmstart) {
+        /* leave a flow, not a preflow, for the next solve to start from */
+#ifdef USE_GAP
+        for (i = 0; i <= G->nnodes; i++) {
+            G->level[i] = -1;
+        }
 #endif
+        flow (G, t, s, FLOW_RETURN);
+        F->haveflow = 1;
+    }
+    return 0;
+}
 
-    for (i = G->nedges - 1; i >= 0; i--)
-        edgelist[i].flow = 0.0;
+/* warm_orient decides if the flow on the arcs can start the s-t solve.  */
+/* It sets each excess to the net flow into the node, and returns 1 if s */
+/* is the only node short of flow, 2 if t is (so the pair is to be       */
+/* solved as t-s), and 0 if neither is (the solve starts cold).  In the  */
+/* undirected case, the flow is turned around if that makes it fit.      */
 
-    t->active = 1;              /* a lie, which keeps s and t off the */
-    s->active = 1;              /* active int                         */
+static int warm_orient (graph *G, int s, int t)
+{
+    double *excess = G->excess;
+    double f, r;
+    int i, a, lowcount = 0, highcount = 0, low = -1, high = -1;
 
-    for (e = s->out; e; e = e->outnext) {
-        if (e->cap > 0.0) {
-            e->flow = e->cap;
-            e->ends[1]->excess += e->cap;
-#ifdef QUEUE_PRF
-            ADD_TO_ACTIVE(e->ends[1]);
-#endif
-#ifdef HIGHEST_LABEL_PRF
-            e->ends[1]->active = 1;
-#endif
+    for (i = 0; i < G->nnodes; i++) excess[i] = 0.0;
+    for (i = 0; i < G->nedges; i++) {
+        a = G->fwd[i];
+        f = G->cap[i] - G->res[a];
+        excess[G->head[a]] += f;
+        excess[G->head[G->mate[a]]] -= f;
+    }
+    for (i = 0; i < G->nnodes; i++) {
+        if (excess[i] < -PRF_EPSILON) {
+            lowcount++; low = i;
+        } else if (excess[i] > PRF_EPSILON) {
+            highcount++; high = i;
+        } else {
+            excess[i] = 0.0;
         }
     }
+
+    if (highcount > 1) return 0;
+    if (lowcount == 0 || (lowcount == 1 && low == s)) return 1;
+    if (lowcount == 1 && low == t) return 2;
+#ifdef UNDIRECTED_GRAPH
+    if (highcount == 1 && (high == s || high == t)) {
+        /* with residuals cap - f and cap + f, -f just swaps the two */
+        for (i = 0; i < G->nedges; i++) {
+            a = G->fwd[i];
+            r = G->res[a];
+            G->res[a] = G->res[G->mate[a]];
+            G->res[G->mate[a]] = r;
+        }
+        for (i = 0; i < G->nnodes; i++) {
+            excess[i] = -excess[i];
+        }
+        return (high == s ? 1 : 2);
+    }
+#endif
+
+    return 0;
+}
+
+void CCcut_flowctx_destroy (CCcut_flowctx **F)
+{
+    if (*F) {
+        free_graph (&(*F)->G);
+        CC_FREE (*F, CCcut_flowctx);
+    }
+}
+
+/* maxflow runs the code picked by G->alg and returns the value of the  */
+/* s-t cut it finds; mode is only used by the push-relabel codes.        */
+
+static double maxflow (graph *G, int s, int t, int mode)
+{
+    switch (G->alg) {
+    case CC_FLOW_PSEUDOFLOW:
+        return pseudoflow (G, s, t);
+    case CC_FLOW_BK:
+        return bkflow (G, s, t);
+    default:
+        return flow (G, s, t, mode);
+    }
+}
+
+/* coldstart sets the residual capacities to those of the zero flow.     */
+
+static void coldstart (graph *G)
+{
+    int i, a;
+
+    for (i = G->nedges - 1; i >= 0; i--) {
+        a = G->fwd[i];
+        G->res[a] = G->cap[i];
 #ifdef UNDIRECTED_GRAPH
-    for (e = s->in; e; e = e->innext) {
-        if (e->cap > 0.0) {
-            e->flow = -e->cap;
-            e->ends[0]->excess += e->cap;
-#ifdef QUEUE_PRF
-            ADD_TO_ACTIVE(e->ends[0]);
+        G->res[G->mate[a]] = G->cap[i];
+#else
+        G->res[G->mate[a]] = 0.0;
 #endif
-#ifdef HIGHEST_LABEL_PRF
-            e->ends[0]->active = 1;
+    }
+}
+
+/* flow computes a maximum preflow from s to t.  With FLOW_WARM it      */
+/* starts from the flows and excesses already in G (see warm_orient)     */
+/* instead of from zero.  FLOW_RETURN is the second phase of a solve,    */
+/* with the roles of s and t exchanged: the excess stuck at the nodes    */
+/* that cannot reach the sink is pushed back to the source, so that the */
+/* arcs hold a flow.                                                     */
+
+static double flow (graph *G, int s, int t, int mode)
+{
+    int fifo = (G->alg == CC_FLOW_FIFO);
+    int qhead = -1;
+    int qtail = -1;
+    int *qnext = G->qnext;
+    int n, a, w, end, lv;
+    int count, round;
+    int i;
+    long npush = 0;
+    int ncount = G->nnodes;
+    int *first = G->first;
+    int *head = G->head;
+    int *mate = G->mate;
+    int *label = G->label;
+    int *current = G->current;
+    char *active = G->active;
+    double *res = G->res;
+    double *excess = G->excess;
+    double ex, rf;
+#ifdef USE_GAP
+    int *level = G->level;
+    int *levelnext = G->levelnext;
+    int *levelprev = G->levelprev;
 #endif
+    int *high = G->high;
+    int *highnext = G->highnext;
+
+    for (i = 0; i < ncount; i++) {
+        if (mode == FLOW_COLD) excess[i] = 0.0;
+        active[i] = 0;
+        high[i] = -1;
+    }
+    G->highest = 0;
+
+    if (mode == FLOW_COLD) coldstart (G);
+
+    active[t] = 1;              /* a lie, which keeps s and t off the */
+    active[s] = 1;              /* active int                         */
+
+    if (mode != FLOW_COLD) {
+        for (i = 0; i < ncount; i++) {
+            if (excess[i] > 0.0) {
+                if (fifo) {
+                    ADD_TO_ACTIVE(i);
+                } else {
+                    active[i] = 1;
+                }
+            }
         }
     }
-#endif
 
+    if (mode != FLOW_RETURN) {
+        for (a = first[s], end = first[s+1]; a < end; a++) {
+            if (res[a] > 0.0) {
+                w = head[a];
+                excess[w] += res[a];
+                res[mate[a]] += res[a];
+                res[a] = 0.0;
+                if (fifo) {
+                    ADD_TO_ACTIVE(w);
+                } else {
+                    active[w] = 1;
+                }
+            }
+        }
+    }
 
-    setlabels (G, s, t);
+    setlabels (G, s, t, mode);
     count = 0;
     round = (int) (GLOBAL_RELABEL_FREQUENCY * ncount);
 
-#ifdef QUEUE_PRF
-    while (qhead) {
-        n = qhead;
-        qhead = qhead->qnext;
-        if (!qhead)
-            qtail = (node *) NULL;
-        n->active = 0;
-        if (n->flowlabel >= ncount)
-            continue;
-#endif
-
-#ifdef HIGHEST_LABEL_PRF
-    while (G->highest) {
-        n = high[G->highest];
-        n->active = 0;
-        high[G->highest] = high[G->highest]->highnext;
-        if (!high[G->highest]) {
-            G->highest--;
-            while (G->highest && (high[G->highest] == (node *) NULL))
+    for (;;) {
+        if (fifo) {
+            if (qhead == -1)
+                break;
+            n = qhead;
+            qhead = qnext[qhead];
+            if (qhead == -1)
+                qtail = -1;
+            active[n] = 0;
+            if (label[n] >= ncount)
+                continue;
+        } else {
+            if (!G->highest)
+                break;
+            n = high[G->highest];
+            active[n] = 0;
+            high[G->highest] = highnext[n];
+            if (high[G->highest] == -1) {
                 G->highest--;
+                while (G->highest && (high[G->highest] == -1))
+                    G->highest--;
+            }
         }
-#endif
 
         if (count == round) {
-            setlabels (G, s, t);
-            if (n->flowlabel >= ncount)
+            setlabels (G, s, t, mode);
+            if (label[n] >= ncount)
                 continue;
             count = 0;
         } else
             count++;
 
-        if (n->inout == GOING_IN)
-            goto DO_ME_IN;
-
-        if (n->outcurrent) {
-            while (n->excess > 0.0) {
-                e = n->outcurrent;
-                { /* PUSH OUT */
-                    double rf = e->cap - e->flow;
-                    node *n1 = e->ends[1];
-                    if (n->flowlabel == n1->flowlabel + 1 && rf > 0.0) {
-                        if (n->excess <= rf) {
-                            e->flow += n->excess;
-                            n1->excess += n->excess;
-                            n->excess = 0.0;
-                            ADD_TO_ACTIVE(n1);
-                        } else {
-                            e->flow += rf;
-                            n1->excess += rf;
-                            n->excess -= rf;
-                            ADD_TO_ACTIVE(n1);
-                            n->outcurrent = e->outnext;
-                            if (!n->outcurrent) {
-                                n->outcurrent = n->out;
-                                n->inout = GOING_IN;
-                                goto DO_ME_IN;
-                            }
-                        }
-                    } else {
-                        n->outcurrent = e->outnext;
-                        if (!n->outcurrent) {
-                            n->outcurrent = n->out;
-                            n->inout = GOING_IN;
-                            goto DO_ME_IN;
-                        }
-                    }
-                }
+        /* discharge n, scanning its arcs from current[n] */
+
+        ex = excess[n];
+        lv = label[n];
+        end = first[n+1];
+        for (a = current[n]; ex > 0.0; ) {
+            if (a == end) {
+                current[n] = first[n];
+                RELABEL(n);
+                break;
             }
-        }
-DO_ME_IN:
-        if (n->incurrent) {
-            while (n->excess > 0.0) {
-                e = n->incurrent;
-                { /* PUSH IN */
-#ifdef UNDIRECTED_GRAPH
-                    double rf = e->cap + e->flow;
-#else
-                    double rf = e->flow;
-#endif
-                    node *n1 = e->ends[0];
-                    if (n->flowlabel == n1->flowlabel + 1 && rf > 0.0) {
-                        if (n->excess <= rf) {
-                            e->flow -= n->excess;
-                            n1->excess += n->excess;
-                            n->excess = 0.0;
-                            ADD_TO_ACTIVE(n1);
-                        } else {
-                            e->flow -= rf;
-                            n1->excess += rf;
-                            n->excess -= rf;
-                            ADD_TO_ACTIVE(n1);
-                            n->incurrent = e->innext;
-                            if (!n->incurrent) {
-                                n->incurrent = n->in;
-                                n->inout = GOING_OUT;
-                                RELABEL(n);
-                                break;
-                            }
-                        }
-                    } else {
-                        n->incurrent = e->innext;
-                        if (!n->incurrent) {
-                            n->incurrent = n->in;
-                            n->inout = GOING_OUT;
-                            RELABEL(n);
-                            break;
-                        }
-                    }
+            w = head[a];
+            rf = res[a];
+            if (lv == label[w] + 1 && rf > 0.0) {
+                npush++;
+                if (ex <= rf) {
+                    res[a] -= ex;
+                    res[mate[a]] += ex;
+                    excess[w] += ex;
+                    ex = 0.0;
+                    ADD_TO_ACTIVE(w);
+                    current[n] = a;
+                } else {
+                    res[a] = 0.0;
+                    res[mate[a]] += rf;
+                    excess[w] += rf;
+                    ex -= rf;
+                    ADD_TO_ACTIVE(w);
+                    a++;
                 }
+            } else {
+                a++;
             }
-        } else {
-            /* n->in is NULL */
-            n->inout = GOING_OUT;
-            RELABEL(n);
         }
-        if (n->excess > 0.0 && n->flowlabel < ncount) {
+        excess[n] = ex;
+        if (ex > 0.0 && label[n] < ncount) {
             ADD_TO_ACTIVE(n);
         }
     }
 
-    return t->excess;
+    G->npush += npush;
+    return excess[t];
 }
 
-static void setlabels (graph *G, node *s, node *t)
+static void setlabels (graph *G, int s, int t, int mode)
 {
-    node *n;
     int ncount = G->nnodes;
     int num = ++(G->magicnum);
     int i;
-    /* static int duke = 0; */
 
-    t->flowlabel = 0;
+    G->label[t] = 0;
+    if (mode == FLOW_RETURN) {
+        G->magiclabel[s] = num;   /* s is the old sink, which can reach t */
+    }
     backwards_bfs (t, num, G);
-    if (s->magiclabel == num) {
-        printf ("Help - s should not get a label\n");
-        s->flowlabel = ncount;
+    if (G->magiclabel[s] == num) {
+        if (mode != FLOW_RETURN) printf ("Help - s should not get a label\n");
+        G->label[s] = ncount;
     }
 
-    for (i = G->nnodes, n = G->nodelist; i;  i--, n++) {
-        n->outcurrent = n->out;
-        n->incurrent = n->in;
-        n->inout = GOING_OUT;
-        if (n->magiclabel != num) {
-            n->flowlabel = ncount;
+    for (i = 0; i < ncount; i++) {
+        G->current[i] = G->first[i];
+        if (G->magiclabel[i] != num) {
+            G->label[i] = ncount;
         }
     }
 }
 
-static void backwards_bfs (node *s, int K, graph *G)
+/* backwards_bfs labels each node with its distance to s in the residual */
+/* graph, layer by layer; tnext links the nodes of the current layer.    */
+
+static void backwards_bfs (int s, int K, graph *G)
 {
-    node *this, *next, *tail;
-    edge *e;
-    int  dist;
+    int this, next, tail, a, end;
+    int dist;
+    int *first = G->first;
+    int *head = G->head;
+    int *mate = G->mate;
+    int *label = G->label;
+    int *magiclabel = G->magiclabel;
+    int *tnext = G->tnext;
+    double *res = G->res;
 #ifdef USE_GAP
-    node dummy;
-    node **level = G->level;
-#endif
-#ifdef HIGHEST_LABEL_PRF
-    node **high = G->high;
+    int *level = G->level;
+    int *levelnext = G->levelnext;
+    int *levelprev = G->levelprev;
 #endif
+    int *high = G->high;
+    int *highnext = G->highnext;
+    char *active = G->active;
+    int fifo = (G->alg == CC_FLOW_FIFO);
 
-    s->magiclabel = K;
+    magiclabel[s] = K;
     next = s;
-    s->tnext = (node *) NULL;
-    dist = s->flowlabel;
+    tnext[s] = -1;
+    dist = label[s];
 
 #ifdef USE_GAP
     {
         int i;
-        for (i = 0; level[i]; i++)
-            level[i] = (node *) NULL;
+        for (i = 0; level[i] != -1; i++)
+            level[i] = -1;
         level[dist] = s;
-        s->levelnext = (node *) NULL;
+        levelnext[s] = -1;
+        levelprev[s] = -1;
     }
 #endif
-#ifdef HIGHEST_LABEL_PRF
-    {
+    if (!fifo) {
         int i;
         for (i = 0; i <= G->highest; i++)
-            high[i] = (node *) NULL;
+            high[i] = -1;
         G->highest = 0;
     }
-#endif
 
     do {
-#ifdef USE_GAP
-        level[dist]->levelprev = (node *) NULL;
-        level[dist + 1] = &dummy;
-        dummy.levelprev = (node *) NULL;
-#endif
         dist++;
-        for (this = next, next = (node *) NULL; this; this = this->tnext) {
-            for (e = this->out; e; e = e->outnext) {
-                tail = e->ends[1];
-#ifdef UNDIRECTED_GRAPH
-                if (tail->magiclabel != K && e->cap + e->flow > PRF_EPSILON) {
-#else
-                if (tail->magiclabel != K && e->flow > PRF_EPSILON) {
-#endif
-                    tail->flowlabel = dist;
-                    tail->tnext = next;
+        for (this = next, next = -1; this != -1; this = tnext[this]) {
+            for (a = first[this], end = first[this+1]; a < end; a++) {
+                tail = head[a];
+                if (magiclabel[tail] != K && res[mate[a]] > PRF_EPSILON) {
+                    label[tail] = dist;
+                    tnext[tail] = next;
                     next = tail;
-                    tail->magiclabel = K;
+                    magiclabel[tail] = K;
 #ifdef USE_GAP
-                    tail->levelnext = level[dist];
-                    level[dist]->levelprev = tail;
+                    levelprev[tail] = -1;
+                    levelnext[tail] = level[dist];
+                    if (level[dist] != -1)
+                        levelprev[level[dist]] = tail;
                     level[dist] = tail;
 #endif
-#ifdef HIGHEST_LABEL_PRF
-                    if (tail->active) {
-                        tail->highnext = high[dist];
+                    if (!fifo && active[tail]) {
+                        highnext[tail] = high[dist];
                         high[dist] = tail;
                     }
-#endif
                 }
             }
-            for (e = this->in; e; e = e->innext) {
-                tail = e->ends[0];
-                if (tail->magiclabel != K && e->cap - e->flow > PRF_EPSILON) {
-                    tail->flowlabel = dist;
-                    tail->tnext = next;
-                    next = tail;
-                    tail->magiclabel = K;
-#ifdef USE_GAP
-                    tail->levelnext = level[dist];
-                    level[dist]->levelprev = tail;
-                    level[dist] = tail;
+        }
+        if (!fifo && high[dist] != -1)
+            G->highest = dist;
+    } while (next != -1);
+}
+
+/* pseudoflow runs the highest label pseudoflow algorithm.  The arcs out */
+/* of s and into t are saturated, and every other node starts as a tree  */
+/* of its own, strong (label 1) if it is left with excess and weak       */
+/* (label 0) if it is not.  A strong root r of label k looks over the    */
+/* nodes of label k in its tree, children after parents, for a residual  */
+/* arc to a node of label k-1.  If it finds one, the tree of r is hung   */
+/* from that node and the excess of r is pushed up to the new root,      */
+/* splitting off the nodes below each arc that cannot take all of it.    */
+/* If not, those nodes are relabeled, children first.  When no node has  */
+/* label k-1 (a gap), every node of label k or more is lifted to         */
+/* ncount; these nodes, with s, are the source side of the minimum cut   */
+/* whose capacity is returned.                                           */
+
+static double pseudoflow (graph *G, int s, int t)
+{
+    int ncount = G->nnodes;
+    int *first = G->first;
+    int *head = G->head;
+    int *mate = G->mate;
+    int *label = G->label;
+    int *level = G->level;
+    int *high = G->high;
+    int *highnext = G->highnext;
+    int *parent = G->parent;
+    int *child = G->child;
+    int *sibling = G->sibling;
+    int *scan = G->scan;
+    double *res = G->res;
+    double *excess = G->excess;
+    double value = 0.0;
+    int i, a, end, k, r, v, w, found;
+
+    coldstart (G);
+    for (i = 0; i <= ncount; i++) {
+        level[i] = -1;
+    }
+    for (i = 0; i < ncount; i++) {
+        excess[i] = 0.0;
+        high[i] = -1;
+        parent[i] = -1;
+        child[i] = -1;
+        G->current[i] = first[i];
+    }
+    G->highest = 0;
+
+    for (a = first[s], end = first[s+1]; a < end; a++) {
+        excess[head[a]] += res[a];
+        res[mate[a]] += res[a];
+        res[a] = 0.0;
+    }
+    for (a = first[t], end = first[t+1]; a < end; a++) {
+        v = head[a];
+        if (v != s) {
+            excess[v] -= res[mate[a]];
+            res[a] += res[mate[a]];
+            res[mate[a]] = 0.0;
+        }
+    }
+
+    label[s] = ncount;
+    label[t] = 0;
+    for (v = 0; v < ncount; v++) {
+        if (v == s || v == t) continue;
+        k = (excess[v] > 0.0 ? 1 : 0);
+        label[v] = k;
+        G->levelprev[v] = -1;
+        G->levelnext[v] = level[k];
+        if (level[k] != -1)
+            G->levelprev[level[k]] = v;
+        level[k] = v;
+        if (k) pf_addroot (G, v);
+    }
+
+    while (G->highest > 0) {
+        k = G->highest;
+        r = high[k];
+        if (r == -1) {
+            G->highest--;
+            continue;
+        }
+        high[k] = highnext[r];
+        if (label[r] != k)
+            continue;             /* lifted while it waited */
+        if (level[k-1] == -1) {
+            pf_lift (G, k);
+            continue;
+        }
+
+        a = pf_findarc (G, r);
+        if (a != -1) {
+            pf_merge (G, r, r, a);
+            continue;
+        }
+        found = 0;
+        scan[r] = child[r];
+        v = r;
+        for (;;) {
+            while (scan[v] != -1 && label[scan[v]] != k)
+                scan[v] = sibling[scan[v]];
+            if (scan[v] != -1) {
+                w = scan[v];
+                scan[v] = sibling[w];
+                a = pf_findarc (G, w);
+                if (a != -1) {
+                    pf_merge (G, r, w, a);
+                    found = 1;
+                    break;
+                }
+                scan[w] = child[w];
+                v = w;
+            } else {
+                pf_relabel (G, v);
+                if (v == r) break;
+                v = parent[v];
+            }
+        }
+        if (!found) pf_addroot (G, r);
+    }
+
+    for (i = 0; i < G->nedges; i++) {
+        a = G->fwd[i];
+        v = head[mate[a]];
+        w = head[a];
+#ifdef UNDIRECTED_GRAPH
+        if ((label[v] >= ncount) != (label[w] >= ncount))
+            value += G->cap[i];
+#else
+        if (label[v] >= ncount && label[w] < ncount)
+            value += G->cap[i];
 #endif
-#ifdef HIGHEST_LABEL_PRF
-                    if (tail->active) {
-                        tail->highnext = high[dist];
-                        high[dist] = tail;
+    }
+    return value;
+}
+
+/* pf_findarc returns a residual arc from v to a node of label one less  */
+/* (starting at current[v]), or -1 if there is none.                     */
+
+static int pf_findarc (graph *G, int v)
+{
+    int *head = G->head;
+    int *label = G->label;
+    double *res = G->res;
+    int k = G->label[v] - 1;
+    int a, end;
+
+    for (a = G->current[v], end = G->first[v+1]; a < end; a++) {
+        if (res[a] > 0.0 && label[head[a]] == k) {
+            G->current[v] = a;
+            return a;
+        }
+    }
+    G->current[v] = end;
+    return -1;
+}
+
+/* pf_merge hangs the tree of the strong root r from the head of arc a,  */
+/* where a leaves the node v of that tree, and pushes the excess of r   */
+/* to the root of the merged tree.                                       */
+
+static void pf_merge (graph *G, int r, int v, int a)
+{
+    int *parent = G->parent;
+    int *parc = G->parc;
+    int *mate = G->mate;
+    double *res = G->res;
+    double *excess = G->excess;
+    int u, p, pa, np, na;
+    double delta, ex;
+
+    G->npush++;
+
+    np = G->head[a];
+    na = a;
+    for (u = v; u != -1; u = p) {
+        p = parent[u];
+        pa = parc[u];
+        if (p != -1) pf_cutchild (G, p, u);
+        pf_addchild (G, np, u);
+        parc[u] = na;
+        np = u;
+        if (p != -1) na = mate[pa];
+    }
+
+    delta = excess[r];
+    excess[r] = 0.0;
+    for (u = r; parent[u] != -1 && delta > 0.0; u = p) {
+        p = parent[u];
+        pa = parc[u];
+        if (res[pa] < delta) {
+            excess[u] = delta - res[pa];
+            delta = res[pa];
+            pf_cutchild (G, p, u);
+            pf_addroot (G, u);
+        }
+        res[pa] -= delta;
+        res[mate[pa]] += delta;
+    }
+
+    if (parent[u] == -1 && delta > 0.0) {
+        ex = excess[u];
+        excess[u] += delta;
+        if (ex <= 0.0 && excess[u] > 0.0) {
+            /* a weak root (of label 0) turns strong */
+            if (G->label[u] == 0) pf_relabel (G, u);
+            pf_addroot (G, u);
+        }
+    }
+}
+
+static void pf_addchild (graph *G, int p, int v)
+{
+    G->parent[v] = p;
+    G->sibprev[v] = -1;
+    G->sibling[v] = G->child[p];
+    if (G->child[p] != -1)
+        G->sibprev[G->child[p]] = v;
+    G->child[p] = v;
+}
+
+static void pf_cutchild (graph *G, int p, int v)
+{
+    if (G->sibprev[v] != -1) {
+        G->sibling[G->sibprev[v]] = G->sibling[v];
+    } else {
+        G->child[p] = G->sibling[v];
+    }
+    if (G->sibling[v] != -1)
+        G->sibprev[G->sibling[v]] = G->sibprev[v];
+    G->parent[v] = -1;
+}
+
+static void pf_addroot (graph *G, int v)
+{
+    int k = G->label[v];
+
+    G->highnext[v] = G->high[k];
+    G->high[k] = v;
+    if (G->highest < k)
+        G->highest = k;
+}
+
+static void pf_relabel (graph *G, int v)
+{
+    int *level = G->level;
+    int *levelnext = G->levelnext;
+    int *levelprev = G->levelprev;
+    int k = G->label[v];
+
+    G->nrelabel++;
+    if (levelprev[v] != -1) {
+        levelnext[levelprev[v]] = levelnext[v];
+    } else {
+        level[k] = levelnext[v];
+    }
+    if (levelnext[v] != -1)
+        levelprev[levelnext[v]] = levelprev[v];
+
+    k++;
+    G->label[v] = k;
+    levelprev[v] = -1;
+    levelnext[v] = level[k];
+    if (level[k] != -1)
+        levelprev[level[k]] = v;
+    level[k] = v;
+    G->current[v] = G->first[v];
+}
+
+/* pf_lift moves the nodes of label k and up to label ncount.  The labels */
+/* in use have no holes below k, so the first empty level ends them.      */
+
+static void pf_lift (graph *G, int k)
+{
+    int ncount = G->nnodes;
+    int v, j;
+
+    for (j = k; j < ncount && G->level[j] != -1; j++) {
+        for (v = G->level[j]; v != -1; v = G->levelnext[v]) {
+            G->label[v] = ncount;
+        }
+        G->level[j] = -1;
+    }
+    for (j = k; j <= G->highest; j++) {
+        G->high[j] = -1;
+    }
+    G->highest = k - 1;
+}
+
+/* bkflow runs the augmenting path algorithm of Boykov and Kolmogorov.   */
+/* A source tree grows from s and a sink tree from t, from the active    */
+/* nodes in FIFO order; an arc that joins the two trees gives a path,    */
+/* which is augmented.  The nodes cut off from their trees by saturated  */
+/* tree arcs (the orphans) look for a new parent in their tree, one with */
+/* a path to the terminal, taking the one nearest to it; an orphan that  */
+/* finds none is freed and its children become orphans.  The value of   */
+/* the flow is returned.                                                 */
+
+static double bkflow (graph *G, int s, int t)
+{
+    int ncount = G->nnodes;
+    int *first = G->first;
+    int *head = G->head;
+    int *mate = G->mate;
+    int *label = G->label;
+    int *parc = G->parc;
+    int *stamp = G->stamp;
+    int *qnext = G->qnext;
+    int *orphan = G->scan;
+    char *side = G->side;
+    char *active = G->active;
+    double *res = G->res;
+    double value = 0.0, delta;
+    int qhead = -1, qtail = -1, norphan = 0, time = 0;
+    int i, a, b, c, end, v, w, u, p, x, y, d, best, dbest;
+
+    coldstart (G);
+    for (i = 0; i < ncount; i++) {
+        side[i] = BK_FREE;
+        parc[i] = BK_ORPHAN;
+        active[i] = 0;
+        stamp[i] = 0;
+    }
+    side[s] = BK_SOURCE;
+    side[t] = BK_SINK;
+    parc[s] = BK_TERMINAL;
+    parc[t] = BK_TERMINAL;
+    label[s] = 0;
+    label[t] = 0;
+    BK_ACTIVATE (s);
+    BK_ACTIVATE (t);
+
+    while (qhead != -1) {
+        v = qhead;
+        qhead = qnext[qhead];
+        if (qhead == -1)
+            qtail = -1;
+        active[v] = 0;
+
+        for (a = first[v], end = first[v+1]; a < end; a++) {
+            if (side[v] == BK_FREE)
+                break;            /* freed by the last adoption */
+            w = head[a];
+            b = (side[v] == BK_SOURCE ? a : mate[a]);
+            if (res[b] <= PRF_EPSILON)
+                continue;
+            if (side[w] == BK_FREE) {
+                side[w] = side[v];
+                parc[w] = b;
+                label[w] = label[v] + 1;
+                stamp[w] = stamp[v];
+                BK_ACTIVATE (w);
+                continue;
+            }
+            if (side[w] == side[v]) {
+                if (parc[w] != BK_TERMINAL && stamp[w] <= stamp[v] &&
+                    label[w] > label[v]) {
+                    parc[w] = b;
+                    label[w] = label[v] + 1;
+                    stamp[w] = stamp[v];
+                }
+                continue;
+            }
+
+            /* b runs from the source tree to the sink tree */
+            x = head[mate[b]];
+            y = head[b];
+            delta = res[b];
+            for (u = x; parc[u] != BK_TERMINAL; u = head[mate[parc[u]]]) {
+                if (res[parc[u]] < delta) delta = res[parc[u]];
+            }
+            for (u = y; parc[u] != BK_TERMINAL; u = head[parc[u]]) {
+                if (res[parc[u]] < delta) delta = res[parc[u]];
+            }
+            res[b] -= delta;
+            res[mate[b]] += delta;
+            for (u = x; parc[u] != BK_TERMINAL; u = p) {
+                c = parc[u];
+                p = head[mate[c]];
+                res[c] -= delta;
+                res[mate[c]] += delta;
+                if (res[c] <= PRF_EPSILON) {
+                    parc[u] = BK_ORPHAN;
+                    orphan[norphan++] = u;
+                }
+            }
+            for (u = y; parc[u] != BK_TERMINAL; u = p) {
+                c = parc[u];
+                p = head[c];
+                res[c] -= delta;
+                res[mate[c]] += delta;
+                if (res[c] <= PRF_EPSILON) {
+                    parc[u] = BK_ORPHAN;
+                    orphan[norphan++] = u;
+                }
+            }
+            value += delta;
+            G->npush++;
+            time++;
+
+            while (norphan > 0) {
+                u = orphan[--norphan];
+                best = -1;
+                dbest = INFINITY;
+                for (c = first[u]; c < first[u+1]; c++) {
+                    w = head[c];
+                    b = (side[u] == BK_SOURCE ? mate[c] : c);
+                    if (side[w] != side[u] || res[b] <= PRF_EPSILON)
+                        continue;
+                    d = bk_dist (G, w, time);
+                    if (d >= 0 && d < dbest) {
+                        best = b;
+                        dbest = d;
+                    }
+                }
+                if (best != -1) {
+                    parc[u] = best;
+                    label[u] = dbest + 1;
+                    stamp[u] = time;
+                    G->nrelabel++;
+                    continue;
+                }
+                for (c = first[u]; c < first[u+1]; c++) {
+                    w = head[c];
+                    if (side[w] != side[u])
+                        continue;
+                    b = (side[u] == BK_SOURCE ? mate[c] : c);
+                    if (res[b] > PRF_EPSILON)
+                        BK_ACTIVATE (w);
+                    if (parc[w] >= 0 && BK_PARENT (w) == u) {
+                        parc[w] = BK_ORPHAN;
+                        orphan[norphan++] = w;
                     }
-#endif
                 }
+                side[u] = BK_FREE;
             }
+            a--;                  /* the arc may still have room */
         }
-#ifdef USE_GAP
-        if (dummy.levelprev) {
-            dummy.levelprev->levelnext = (node *) NULL;
-            level[dist]->levelprev = (node *) NULL;
-        } else {
-            level[dist] = (node *) NULL;
+    }
+
+    return value;
+}
+
+/* bk_dist returns the distance from v to the root of its tree, or -1 if */
+/* the path to the root meets an orphan.  The nodes on the path are      */
+/* stamped with time and their distances, so later calls stop there.     */
+
+static int bk_dist (graph *G, int v, int time)
+{
+    int *head = G->head;
+    int *mate = G->mate;
+    int *parc = G->parc;
+    int *label = G->label;
+    int *stamp = G->stamp;
+    char *side = G->side;
+    int u, d = 0;
+
+    for (u = v; stamp[u] != time; u = BK_PARENT (u)) {
+        if (parc[u] == BK_TERMINAL) {
+            stamp[u] = time;
+            label[u] = 0;
+            break;
         }
-#endif
-#ifdef HIGHEST_LABEL_PRF
-        if (high[dist])
-            G->highest = dist;
-#endif
-    } while (next);
+        if (parc[u] == BK_ORPHAN)
+            return -1;
+        d++;
+    }
+    d += label[u];
+    for (u = v; stamp[u] != time; u = BK_PARENT (u)) {
+        stamp[u] = time;
+        label[u] = d--;
+    }
+    return label[v];
 }
 
-static int grab_the_cut (graph *G, node *n, int **cut, int *cutcount)
+static int grab_the_cut (graph *G, int n, int **cut, int *cutcount)
 {
     int rval = 0;
-    edge *e;
-    node *q, *top;
     int count = 0;
-    int i, num;
-    node *nodelist = G->nodelist;
+    int i;
     int *tcut = (int *) NULL;
 
     *cut = (int *) NULL;
@@ -636,37 +1456,7 @@ static int grab_the_cut (graph *G, node *n, int **cut, int *cutcount)
         rval = 1; goto CLEANUP;
     }
 
-    G->magicnum++;
-    num = G->magicnum;
-    tcut[count++] = (int) (n - nodelist);
-    q = n;
-    q->magiclabel = num;
-    q->tnext = (node *) NULL;
-
-    while (q) {
-        top = q;
-        q = q->tnext;
-        for (e = top->out; e; e = e->outnext) {
-#ifdef UNDIRECTED_GRAPH
-            if (e->cap + e->flow > 0.0 && e->ends[1]->magiclabel != num) {
-#else
-            if (e->flow > 0.0 && e->ends[1]->magiclabel != num) {
-#endif
-                tcut[count++] = (int) (e->ends[1] - nodelist);
-                e->ends[1]->magiclabel = num;
-                e->ends[1]->tnext = q;
-                q = e->ends[1];
-            }
-        }
-        for (e = top->in; e; e = e->innext) {
-            if (e->cap - e->flow > 0.0 && e->ends[0]->magiclabel != num) {
-                tcut[count++] = (int) (e->ends[0] - nodelist);
-                e->ends[0]->magiclabel = num;
-                e->ends[0]->tnext = q;
-                q = e->ends[0];
-            }
-        }
-    }
+    count = sink_side (G, n, tcut);
 
     *cut = CC_SAFE_MALLOC (count, int);
     if (!(*cut)) {
@@ -687,63 +1477,163 @@ CLEANUP:
     return rval;
 }
 
+/* sink_side lists in cut the side of the cut found by the last solve    */
+/* that contains the sink n, marking its nodes with a new magicnum, and   */
+/* returns their number.                                                  */
+
+static int sink_side (graph *G, int n, int *cut)
+{
+    int i, count = 0;
+    int num;
+
+    if (G->alg != CC_FLOW_PSEUDOFLOW) {
+        return collect_cut (G, n, cut);
+    }
+
+    num = ++(G->magicnum);
+    for (i = 0; i < G->nnodes; i++) {
+        if (G->label[i] < G->nnodes) {
+            cut[count++] = i;
+            G->magiclabel[i] = num;
+        }
+    }
+    return count;
+}
+
+/* collect_cut lists in cut the nodes that can reach n in the residual    */
+/* graph and returns their number.  Arcs with a residual of PRF_EPSILON   */
+/* or less are saturated: the rounding left on them would otherwise give  */
+/* a side heavier than the flow.                                          */
+
+static int collect_cut (graph *G, int n, int *cut)
+{
+    int q, top, a, end, w;
+    int count = 0;
+    int num;
+    int *first = G->first;
+    int *head = G->head;
+    int *mate = G->mate;
+    int *magiclabel = G->magiclabel;
+    int *tnext = G->tnext;
+    double *res = G->res;
+
+    G->magicnum++;
+    num = G->magicnum;
+    cut[count++] = n;
+    q = n;
+    magiclabel[q] = num;
+    tnext[q] = -1;
+
+    while (q != -1) {
+        top = q;
+        q = tnext[q];
+        for (a = first[top], end = first[top+1]; a < end; a++) {
+            w = head[a];
+            if (res[mate[a]] > PRF_EPSILON && magiclabel[w] != num) {
+                cut[count++] = w;
+                magiclabel[w] = num;
+                tnext[w] = q;
+                q = w;
+            }
+        }
+    }
+
+    return count;
+}
+
 static int buildgraph (graph *G, int ncount, int ecount, int *elist,
                        double *ecap)
 {
-    int i;
-    edge *edgelist;
-    node *nodelist;
+    int rval;
 
-    G->nodelist = (node *) NULL;
-    G->edgelist = (edge *) NULL;
-#ifdef USE_GAP
-    G->level = (node **) NULL;
-#endif
-#ifdef HIGHEST_LABEL_PRF
-    G->high = (node **) NULL;
-#endif
+    rval = graphspace (G, ncount, ecount);
+    if (rval) return rval;
+    return linkgraph (G, ncount, ecount, elist, ecap);
+}
 
-    G->magicnum = 0;
-    G->nnodes = ncount;
-    G->nedges = ecount;
-    G->nodelist = CC_SAFE_MALLOC (ncount, node);
-    G->edgelist = CC_SAFE_MALLOC (ecount, edge);
-    if (!G->nodelist || !G->edgelist) {
+/* graphspace allocates the arc and node arrays of G.                     */
+
+static int graphspace (graph *G, int ncount, int ecount)
+{
+    int rval = 0;
+
+    G->first      = CC_SAFE_MALLOC (ncount + 1, int);
+    G->excess     = CC_SAFE_MALLOC (ncount, double);
+    G->label      = CC_SAFE_MALLOC (ncount, int);
+    G->current    = CC_SAFE_MALLOC (ncount, int);
+    G->magiclabel = CC_SAFE_MALLOC (ncount, int);
+    G->tnext      = CC_SAFE_MALLOC (ncount, int);
+    G->active     = CC_SAFE_MALLOC (ncount, char);
+    if (!G->first || !G->excess || !G->label || !G->current ||
+        !G->magiclabel || !G->tnext || !G->active) {
         fprintf (stderr, "Out of memory in buildgraph\n");
-        CC_IFFREE (G->nodelist, node);
-        CC_IFFREE (G->edgelist, edge);
-        return 1;
+        rval = 1; goto CLEANUP;
     }
-#ifdef USE_GAP
-    G->level = CC_SAFE_MALLOC (ncount + 1, node *);
-    if (!G->level) {
+    if (ecount > 0) {
+        G->head = CC_SAFE_MALLOC (2 * ecount, int);
+        G->mate = CC_SAFE_MALLOC (2 * ecount, int);
+        G->res  = CC_SAFE_MALLOC (2 * ecount, double);
+        G->fwd  = CC_SAFE_MALLOC (ecount, int);
+        G->cap  = CC_SAFE_MALLOC (ecount, double);
+        if (!G->head || !G->mate || !G->res || !G->fwd || !G->cap) {
+            fprintf (stderr, "Out of memory in buildgraph\n");
+            rval = 1; goto CLEANUP;
+        }
+    }
+    G->level     = CC_SAFE_MALLOC (ncount + 1, int);
+    G->levelnext = CC_SAFE_MALLOC (ncount, int);
+    G->levelprev = CC_SAFE_MALLOC (ncount, int);
+    G->high      = CC_SAFE_MALLOC (ncount, int);
+    G->highnext  = CC_SAFE_MALLOC (ncount, int);
+    G->qnext     = CC_SAFE_MALLOC (ncount, int);
+    if (!G->level || !G->levelnext || !G->levelprev || !G->high ||
+        !G->highnext || !G->qnext) {
         fprintf (stderr, "Out of memory in buildgraph\n");
-        CC_IFFREE (G->nodelist, node);
-        CC_IFFREE (G->edgelist, edge);
-        return 1;
+        rval = 1; goto CLEANUP;
     }
-    for (i = 0; i < ncount; i++)
-        G->level[i] = (node *) NULL;
-    G->level[ncount] = (node *) NULL;  /* A guard dog for a while loop */
-#endif
-
-#ifdef HIGHEST_LABEL_PRF
-    G->high = CC_SAFE_MALLOC (ncount, node *);
-    if (!G->high) {
+    G->parent    = CC_SAFE_MALLOC (ncount, int);
+    G->parc      = CC_SAFE_MALLOC (ncount, int);
+    G->child     = CC_SAFE_MALLOC (ncount, int);
+    G->sibling   = CC_SAFE_MALLOC (ncount, int);
+    G->sibprev   = CC_SAFE_MALLOC (ncount, int);
+    G->scan      = CC_SAFE_MALLOC (ncount, int);
+    G->stamp     = CC_SAFE_MALLOC (ncount, int);
+    G->side      = CC_SAFE_MALLOC (ncount, char);
+    if (!G->parent || !G->parc || !G->child || !G->sibling ||
+        !G->sibprev || !G->scan || !G->stamp || !G->side) {
         fprintf (stderr, "Out of memory in buildgraph\n");
-        CC_IFFREE (G->nodelist, node);
-        CC_IFFREE (G->edgelist, edge);
-        return 1;
+        rval = 1; goto CLEANUP;
     }
-#endif
 
-    nodelist = G->nodelist;
-    edgelist = G->edgelist;
+CLEANUP:
 
+    if (rval) free_graph (G);
+    return rval;
+}
+
+/* linkgraph fills in the first ncount nodes and 2*ecount arcs of G,      */
+/* which must have room for them.                                         */
+
+static int linkgraph (graph *G, int ncount, int ecount, int *elist,
+                      double *ecap)
+{
+    int i, a, b;
+    int *first = G->first;
+    int *pos = G->current;     /* scratch: the next free arc of a node */
+
+    G->magicnum = 0;
+    G->nnodes = ncount;
+    G->nedges = ecount;
+
+    for (i = 0; i < ncount; i++)
+        G->level[i] = -1;
+    G->level[ncount] = -1;     /* A guard dog for a while loop */
+
+    for (i = 0; i <= ncount; i++) {
+        first[i] = 0;
+    }
     for (i = 0; i < ncount; i++) {
-        nodelist[i].in = (edge *) NULL;
-        nodelist[i].out = (edge *) NULL;
-        nodelist[i].magiclabel = 0;
+        G->magiclabel[i] = 0;
     }
 
     for (i = 0; i < ecount; i++) {
@@ -753,15 +1643,36 @@ static int buildgraph (graph *G, int ncount, int ecount, int *elist,
             head < 0 || head >= ncount) {
             fprintf (stderr, "Edge list in wrong format: Edge %d = [%d, %d]\n",
                          i, tail, head);
+            G->nnodes = 0;
+            G->nedges = 0;
             return 1;
         }
-        edgelist[i].ends[0] = nodelist + tail;
-        edgelist[i].ends[1] = nodelist + head;
-        edgelist[i].cap = ecap[i];
-        edgelist[i].outnext = nodelist[tail].out;
-        nodelist[tail].out = &(edgelist[i]);
-        edgelist[i].innext = nodelist[head].in;
-        nodelist[head].in = &(edgelist[i]);
+        first[tail + 1]++;
+        first[head + 1]++;
+    }
+    for (i = 0; i < ncount; i++) {
+        first[i + 1] += first[i];
+        pos[i] = first[i];
+    }
+
+    for (i = ecount - 1; i >= 0; i--) {
+        a = pos[elist[2 * i]]++;
+        G->head[a] = elist[(2 * i) + 1];
+        G->fwd[i] = a;
+        G->cap[i] = ecap[i];
+    }
+    for (i = ecount - 1; i >= 0; i--) {
+        a = G->fwd[i];
+        b = pos[elist[(2 * i) + 1]]++;
+        G->head[b] = elist[2 * i];
+        G->mate[a] = b;
+        G->mate[b] = a;
+        G->res[a] = ecap[i];
+#ifdef UNDIRECTED_GRAPH
+        G->res[b] = ecap[i];
+#else
+        G->res[b] = 0.0;
+#endif
     }
     return 0;
 }
@@ -769,25 +1680,66 @@ static int buildgraph (graph *G, int ncount, int ecount, int *elist,
 static void init_graph (graph *G)
 {
     if (G) {
-        G->nodelist = (node *) NULL;
-        G->edgelist = (edge *) NULL;
-#ifdef USE_GAP
-        G->level = (node **) NULL;
-#endif
-#ifdef HIGHEST_LABEL_PRF
-        G->high = (node **) NULL;
-#endif
+        G->first = (int *) NULL;
+        G->head = (int *) NULL;
+        G->mate = (int *) NULL;
+        G->res = (double *) NULL;
+        G->fwd = (int *) NULL;
+        G->cap = (double *) NULL;
+        G->excess = (double *) NULL;
+        G->label = (int *) NULL;
+        G->current = (int *) NULL;
+        G->magiclabel = (int *) NULL;
+        G->tnext = (int *) NULL;
+        G->active = (char *) NULL;
+        G->level = (int *) NULL;
+        G->levelnext = (int *) NULL;
+        G->levelprev = (int *) NULL;
+        G->high = (int *) NULL;
+        G->highnext = (int *) NULL;
+        G->qnext = (int *) NULL;
+        G->parent = (int *) NULL;
+        G->parc = (int *) NULL;
+        G->child = (int *) NULL;
+        G->sibling = (int *) NULL;
+        G->sibprev = (int *) NULL;
+        G->scan = (int *) NULL;
+        G->stamp = (int *) NULL;
+        G->side = (char *) NULL;
+        G->alg = CC_FLOW_HIGHEST_LABEL;
+        G->nnodes = 0;
+        G->nedges = 0;
+        G->npush = 0;
+        G->nrelabel = 0;
     }
 }
 
 static void free_graph (graph *G)
 {
-    CC_IFFREE (G->nodelist, node);
-    CC_IFFREE (G->edgelist, edge);
-#ifdef USE_GAP
-    CC_IFFREE (G->level, node *);
-#endif
-#ifdef HIGHEST_LABEL_PRF
-    CC_IFFREE (G->high, node *);
-#endif
+    CC_IFFREE (G->first, int);
+    CC_IFFREE (G->head, int);
+    CC_IFFREE (G->mate, int);
+    CC_IFFREE (G->res, double);
+    CC_IFFREE (G->fwd, int);
+    CC_IFFREE (G->cap, double);
+    CC_IFFREE (G->excess, double);
+    CC_IFFREE (G->label, int);
+    CC_IFFREE (G->current, int);
+    CC_IFFREE (G->magiclabel, int);
+    CC_IFFREE (G->tnext, int);
+    CC_IFFREE (G->active, char);
+    CC_IFFREE (G->level, int);
+    CC_IFFREE (G->levelnext, int);
+    CC_IFFREE (G->levelprev, int);
+    CC_IFFREE (G->high, int);
+    CC_IFFREE (G->highnext, int);
+    CC_IFFREE (G->qnext, int);
+    CC_IFFREE (G->parent, int);
+    CC_IFFREE (G->parc, int);
+    CC_IFFREE (G->child, int);
+    CC_IFFREE (G->sibling, int);
+    CC_IFFREE (G->sibprev, int);
+    CC_IFFREE (G->scan, int);
+    CC_IFFREE (G->stamp, int);
+    CC_IFFREE (G->side, char);
 }
@@ -128,6 +128,47 @@
 /*      as an array of length at least pool->cutcount)                      */
 /*     -nthreads is the number of parallel threads to use.                  */
 /*                                                                          */
+/*  void CCtsp_init_pricegraph (CCtsp_pricegraph *G)                        */
+/*    INITIALIZES an empty pricing graph (nothing is allocated).            */
+/*                                                                          */
+/*  int CCtsp_build_pricegraph (CCtsp_pricegraph *G, int ncount,            */
+/*      int ecount, int *elist, double *x)                                  */
+/*    LOADS the support of x (the edges with x > 0) into G, as adjacency    */
+/*     lists in one array.  The arrays of G only grow, so a G can be        */
+/*     loaded with any number of x-vectors.                                 */
+/*                                                                          */
+/*  void CCtsp_free_pricegraph (CCtsp_pricegraph *G)                        */
+/*    FREES the arrays of G.                                                */
+/*                                                                          */
+/*  double CCtsp_pricegraph_delta (CCtsp_pricegraph *G, CCtsp_lpclique *c)  */
+/*    RETURNS x(delta(c)) for the x-vector loaded in G.                     */
+/*                                                                          */
+/*  double CCtsp_cut_violation (CCtsp_pricegraph *G, CCtsp_lpcut_in *c,     */
+/*      double *lhs)                                                        */
+/*    RETURNS rhs - lhs of the cut c (of sense 'G') for the x-vector        */
+/*     loaded in G, so c is violated if the value is positive.              */
+/*     -lhs returns the sum of x(delta(C)) over the cliques of c (it can    */
+/*      be NULL); for a comb, the rhs is CCtsp_COMBRHS                      */
+/*    NOTES:                                                                */
+/*      Each clique is marked once in G and only the edges at its nodes     */
+/*      are looked at, so the work follows the size of the cliques and      */
+/*      their neighborhoods, not ecount.  As in CCtsp_price_cuts, cuts      */
+/*      with dominos are not priced (-1000.0 is returned).                  */
+/*                                                                          */
+/*  int CCtsp_cut_violations (CCtsp_lpcut_in *cuts, int ncount,             */
+/*      int ecount, int *elist, double *x, int nthreads, int *p_cutcount,   */
+/*      double **p_viol, double **p_lhs)                                    */
+/*    COMPUTES CCtsp_cut_violation for every cut in the linked list cuts    */
+/*     -nthreads is the number of parallel threads to use (0 or 1 runs     */
+/*      the sequential code)                                                */
+/*     -p_cutcount returns the number of cuts in the list                   */
+/*     -p_viol returns an array with rhs - lhs of each cut, in list order   */
+/*     -p_lhs (if not NULL) returns an array with the lhs of each cut       */
+/*    NOTES:                                                                */
+/*      The support graph is built once and shared by the threads, which   */
+/*      only keep their own mark arrays; the cuts are split into blocks of  */
+/*      about the same number of clique nodes.                              */
+/*                                                                          */
 /*  int CCtsp_get_clique_prices (CCtsp_lpcuts *pool, int **p_cliquenums,    */
 /*      double **p_cliquevals, double mindelta, double maxdelta,            */
 /*      int *p_cliquecount, int ncount, int ecount, int *elist,             */
@@ -249,17 +290,6 @@
 
 #define PROB_CUTS_VERSION 2   /* Version 1 is pre-dominos */
 
-typedef struct pooledge {
-    double x;
-    int to;
-} pooledge;
-
-typedef struct poolnode {
-    struct pooledge *adj;
-    int mark;
-    int deg;
-} poolnode;
-
 
 static int
     init_empty_cutpool_hash (int ncount, CCtsp_lpcuts *pool),
@@ -268,8 +298,11 @@ static int
     register_lpcuts (CCtsp_lpcuts *pool),
     price_cliques (CCtsp_lpclique *cliques, int ncount, int ecount, int *elist,
             double *x, double *cval, int cend),
-    make_pricing_graph (int ncount, int ecount, int *elist, double *x,
-            poolnode **p_nlist, pooledge **p_espace);
+#ifdef CC_POSIXTHREADS
+    price_violations_threaded (CCtsp_pricegraph *G, CCtsp_lpcut_in **clist,
+            int cutcount, double *viol, double *lhs, int nthreads),
+#endif
+    violation_size (CCtsp_lpcut_in *c);
 
 static unsigned int
     cut_hash (void *v_cut, void *u_data);
@@ -278,16 +311,16 @@ static void
 #ifdef CC_POSIXTHREADS
    *price_cliques_thread (void *args),
    *price_cuts_thread (void *args),
+   *price_violations_thread (void *args),
     rebalance_load (int nthreads, double *workload, double *worktime,
         double *work),
 #endif
     price_cuts (CCtsp_lpcut *cuts, int cutcount, double *cval,
         double *cutval),
     sort_cliques (CCtsp_lpcut *c),
-    sort_dominos (CCtsp_lpcut *c);
-
-static double
-    price_clique (poolnode *nlist, CCtsp_lpclique *c, int marker);
+    sort_dominos (CCtsp_lpcut *c),
+    price_violations (CCtsp_pricegraph *G, CCtsp_lpcut_in **clist,
+            int cstart, int cend, double *viol, double *lhs);
 
 
 
@@ -2368,21 +2401,19 @@ static void price_cuts (CCtsp_lpcut *cuts, int cutcount, double *cval,
 static int price_cliques (CCtsp_lpclique *cliques, int ncount, int ecount,
         int *elist, double *x, double *cval, int cend)
 {
-    poolnode *nlist = (poolnode *) NULL;
-    pooledge *espace = (pooledge *) NULL;
-    int marker = 0;
+    CCtsp_pricegraph G;
     int i;
     int rval = 0;
 
-    rval = make_pricing_graph (ncount, ecount, elist, x, &nlist, &espace);
+    CCtsp_init_pricegraph (&G);
+    rval = CCtsp_build_pricegraph (&G, ncount, ecount, elist, x);
     if (rval) {
-        fprintf (stderr, "make_pricing_graph failed\n");
+        fprintf (stderr, "CCtsp_build_pricegraph failed\n");
         goto CLEANUP;
     }
     for (i = 0; i < cend; i++) {
         if (cliques[i].segcount > 0) {
-            marker++;
-            cval[i] = price_clique (nlist, &(cliques[i]), marker);
+            cval[i] = CCtsp_pricegraph_delta (&G, &(cliques[i]));
         } else {
             cval[i] = -1.0;
         }
@@ -2390,100 +2421,325 @@ static int price_cliques (CCtsp_lpclique *cliques, int ncount, int ecount,
 
 CLEANUP:
 
-    CC_IFFREE (nlist, poolnode);
-    CC_IFFREE (espace, pooledge);
+    CCtsp_free_pricegraph (&G);
     return rval;
 }
 
-static int make_pricing_graph (int ncount, int ecount, int *elist, double *x,
-    poolnode **p_nlist, pooledge **p_espace)
+void CCtsp_init_pricegraph (CCtsp_pricegraph *G)
 {
-    poolnode *nlist = (poolnode *) NULL;
-    pooledge *espace = (pooledge *) NULL;
-    pooledge *p;
-    int i;
-    int count;
-    int a, b;
-    int rval;
+    G->ncount = 0;
+    G->marker = 0;
+    G->nspace = 0;
+    G->aspace = 0;
+    G->adjbeg = (int *) NULL;
+    G->adjto  = (int *) NULL;
+    G->adjx   = (double *) NULL;
+    G->mark   = (int *) NULL;
+}
 
-    *p_nlist = (poolnode *) NULL;
-    *p_espace = (pooledge *) NULL;
-    
-    nlist =  CC_SAFE_MALLOC (ncount, poolnode);
-    if (nlist == (poolnode *) NULL) {
-        fprintf (stderr, "out of memory in make_pricing_graph\n");
-        rval = 1; goto CLEANUP;
-    }
+void CCtsp_free_pricegraph (CCtsp_pricegraph *G)
+{
+    CC_IFFREE (G->adjbeg, int);
+    CC_IFFREE (G->adjto, int);
+    CC_IFFREE (G->adjx, double);
+    CC_IFFREE (G->mark, int);
+    CCtsp_init_pricegraph (G);
+}
 
-    for (i = 0; i < ncount; i++) {
-        nlist[i].mark = 0;
-        nlist[i].deg = 0;
+int CCtsp_build_pricegraph (CCtsp_pricegraph *G, int ncount, int ecount,
+        int *elist, double *x)
+{
+    int *adjbeg;
+    int i, a, b, count = 0;
+
+    if (ncount > G->nspace) {
+        CC_IFFREE (G->adjbeg, int);
+        CC_IFFREE (G->mark, int);
+        G->nspace = 0;
+        G->adjbeg = CC_SAFE_MALLOC (ncount + 1, int);
+        G->mark   = CC_SAFE_MALLOC (ncount, int);
+        if (!G->adjbeg || !G->mark) {
+            fprintf (stderr, "out of memory in CCtsp_build_pricegraph\n");
+            CCtsp_free_pricegraph (G);
+            return 1;
+        }
+        G->nspace = ncount;
     }
+    adjbeg = G->adjbeg;
 
-    count = 0;
+    for (i = 0; i <= ncount; i++) adjbeg[i] = 0;
     for (i = 0; i < ecount; i++) {
         if (x[i] >= ZERO_EPSILON) {
-            nlist[elist[2*i]].deg++;
-            nlist[elist[2*i+1]].deg++;
+            adjbeg[elist[2*i]+1]++;
+            adjbeg[elist[2*i+1]+1]++;
             count++;
         }
     }
 
-    espace = CC_SAFE_MALLOC (2*count, pooledge);
-    if (espace == (pooledge *) NULL) {
-        fprintf (stderr, "out of memory in price_cliques\n");
-        rval = 1; goto CLEANUP;
+    if (2*count > G->aspace) {
+        CC_IFFREE (G->adjto, int);
+        CC_IFFREE (G->adjx, double);
+        G->aspace = 0;
+        G->adjto = CC_SAFE_MALLOC (2*count, int);
+        G->adjx  = CC_SAFE_MALLOC (2*count, double);
+        if (!G->adjto || !G->adjx) {
+            fprintf (stderr, "out of memory in CCtsp_build_pricegraph\n");
+            CCtsp_free_pricegraph (G);
+            return 1;
+        }
+        G->aspace = 2*count;
     }
 
-    p = espace;
+    /* adjbeg[a] is used as the fill point of a, and is back at the */
+    /* start of a's list once the edges are in                      */
+
     for (i = 0; i < ncount; i++) {
-        nlist[i].adj = p;
-        p += nlist[i].deg;
-        nlist[i].deg = 0;
+        adjbeg[i+1] += adjbeg[i];
+        G->mark[i] = 0;
     }
     for (i = 0; i < ecount; i++) {
         if (x[i] >= ZERO_EPSILON) {
             a = elist[2*i];
             b = elist[2*i+1];
-            nlist[a].adj[nlist[a].deg].x = x[i];
-            nlist[a].adj[nlist[a].deg++].to = b;
-            nlist[b].adj[nlist[b].deg].x = x[i];
-            nlist[b].adj[nlist[b].deg++].to = a;
+            G->adjto[adjbeg[a]] = b;
+            G->adjx[adjbeg[a]++] = x[i];
+            G->adjto[adjbeg[b]] = a;
+            G->adjx[adjbeg[b]++] = x[i];
         }
     }
+    for (i = ncount; i > 0; i--) adjbeg[i] = adjbeg[i-1];
+    adjbeg[0] = 0;
 
-    *p_nlist = nlist;
-    *p_espace = espace;
-    
-    rval = 0;
- CLEANUP:
-    if (rval) {
-        CC_IFFREE (nlist, poolnode);
-        CC_IFFREE (espace, pooledge);
-    }
-    return rval;
+    G->ncount = ncount;
+    G->marker = 0;
+    return 0;
 }
 
-static double price_clique (poolnode *nlist, CCtsp_lpclique *c, int marker)
+double CCtsp_pricegraph_delta (CCtsp_pricegraph *G, CCtsp_lpclique *c)
 {
     double val = 0.0;
-    poolnode *n;
-    int tmp, j, k;
+    int *mark = G->mark;
+    int tmp, j, k, marker;
+
+    if (G->marker == CCutil_MAXINT) {
+        for (j = 0; j < G->ncount; j++) mark[j] = 0;
+        G->marker = 0;
+    }
+    marker = ++G->marker;
 
     CC_FOREACH_NODE_IN_CLIQUE (j, *c, tmp) {
-        nlist[j].mark = marker;
+        mark[j] = marker;
     }
     CC_FOREACH_NODE_IN_CLIQUE (j, *c, tmp) {
-        n = &(nlist[j]);
-        for (k = 0; k < n->deg; k++) {
-            if (nlist[n->adj[k].to].mark != marker) {
-                val += n->adj[k].x;
+        for (k = G->adjbeg[j]; k < G->adjbeg[j+1]; k++) {
+            if (mark[G->adjto[k]] != marker) {
+                val += G->adjx[k];
             }
         }
     }
     return val;
 }
 
+double CCtsp_cut_violation (CCtsp_pricegraph *G, CCtsp_lpcut_in *c,
+        double *lhs)
+{
+    double val = 0.0;
+    int i;
+
+    if (c->dominocount > 0) {
+        if (lhs) *lhs = 0.0;
+        return -1000.0;
+    }
+    for (i = 0; i < c->cliquecount; i++) {
+        val += CCtsp_pricegraph_delta (G, &c->cliques[i]);
+    }
+    if (lhs) *lhs = val;
+    return (double) c->rhs - val;
+}
+
+#ifdef CC_POSIXTHREADS
+
+typedef struct violation_args {
+    CCtsp_pricegraph G;
+    CCtsp_lpcut_in **clist;
+    int cstart;
+    int cend;
+    double *viol;
+    double *lhs;
+} violation_args;
+
+static void *price_violations_thread (void *args)
+{
+    violation_args *vargs = (violation_args *) args;
+
+    price_violations (&vargs->G, vargs->clist, vargs->cstart, vargs->cend,
+                      vargs->viol, vargs->lhs);
+    return vargs;
+}
+
+/* price_violations_threaded gives each thread a copy of G with its own  */
+/* mark array (the adjacency arrays are only read) and a block of the    */
+/* cuts with about 1/nthreads of the clique nodes.                       */
+
+static int price_violations_threaded (CCtsp_pricegraph *G,
+        CCtsp_lpcut_in **clist, int cutcount, double *viol, double *lhs,
+        int nthreads)
+{
+    violation_args *vargs = (violation_args *) NULL;
+    pthread_t *thread_id = (pthread_t *) NULL;
+    void *thr_rval;
+    double totwork = 0.0, work = 0.0;
+    int i, k, started = 0;
+    int rval = 0;
+
+    vargs = CC_SAFE_MALLOC (nthreads, violation_args);
+    CCcheck_NULL (vargs, "out of memory in price_violations_threaded");
+    for (k = 0; k < nthreads; k++) vargs[k].G.mark = (int *) NULL;
+    thread_id = CC_SAFE_MALLOC (nthreads, pthread_t);
+    CCcheck_NULL (thread_id, "out of memory in price_violations_threaded");
+
+    for (k = 0; k < nthreads; k++) {
+        vargs[k].G = *G;
+        vargs[k].G.marker = 0;
+        vargs[k].G.mark = CC_SAFE_MALLOC (G->ncount, int);
+        CCcheck_NULL (vargs[k].G.mark,
+                      "out of memory in price_violations_threaded");
+        for (i = 0; i < G->ncount; i++) vargs[k].G.mark[i] = 0;
+        vargs[k].clist = clist;
+        vargs[k].viol = viol;
+        vargs[k].lhs = lhs;
+        vargs[k].cstart = cutcount;
+        vargs[k].cend = cutcount;
+    }
+
+    for (i = 0; i < cutcount; i++) {
+        totwork += (double) violation_size (clist[i]);
+    }
+    vargs[0].cstart = 0;
+    for (i = 0, k = 0; i < cutcount && k < nthreads - 1; i++) {
+        work += (double) violation_size (clist[i]);
+        if (work >= totwork * (k + 1) / nthreads) {
+            vargs[k].cend = i + 1;
+            vargs[++k].cstart = i + 1;
+        }
+    }
+
+    for (started = 0; started < nthreads; started++) {
+        rval = pthread_create (&thread_id[started], NULL,
+                               price_violations_thread,
+                               (void *) &vargs[started]);
+        if (rval) {
+            fprintf (stderr, "pthread_create failed, rval %d\n", rval);
+            break;
+        }
+    }
+    for (k = 0; k < started; k++) {
+        if (pthread_join (thread_id[k], &thr_rval)) {
+            fprintf (stderr, "pthread_join failed\n");
+            rval = 1;
+        }
+    }
+
+CLEANUP:
+
+    if (vargs) {
+        for (k = 0; k < nthreads; k++) CC_IFFREE (vargs[k].G.mark, int);
+    }
+    CC_IFFREE (vargs, violation_args);
+    CC_IFFREE (thread_id, pthread_t);
+    return rval;
+}
+
+#endif /* CC_POSIXTHREADS */
+
+int CCtsp_cut_violations (CCtsp_lpcut_in *cuts, int ncount, int ecount,
+        int *elist, double *x, CC_UNUSED int nthreads, int *p_cutcount,
+        double **p_viol, double **p_lhs)
+{
+    CCtsp_pricegraph G;
+    CCtsp_lpcut_in **clist = (CCtsp_lpcut_in **) NULL;
+    CCtsp_lpcut_in *c;
+    double *viol = (double *) NULL;
+    double *lhs = (double *) NULL;
+    int i, cutcount = 0;
+    int rval = 0;
+
+    *p_cutcount = 0;
+    *p_viol = (double *) NULL;
+    if (p_lhs) *p_lhs = (double *) NULL;
+    CCtsp_init_pricegraph (&G);
+
+    for (c = cuts; c; c = c->next) cutcount++;
+    if (cutcount == 0) goto CLEANUP;
+
+    clist = CC_SAFE_MALLOC (cutcount, CCtsp_lpcut_in *);
+    CCcheck_NULL (clist, "out of memory in CCtsp_cut_violations");
+    viol = CC_SAFE_MALLOC (cutcount, double);
+    CCcheck_NULL (viol, "out of memory in CCtsp_cut_violations");
+    if (p_lhs) {
+        lhs = CC_SAFE_MALLOC (cutcount, double);
+        CCcheck_NULL (lhs, "out of memory in CCtsp_cut_violations");
+    }
+    for (i = 0, c = cuts; c; c = c->next) clist[i++] = c;
+
+    rval = CCtsp_build_pricegraph (&G, ncount, ecount, elist, x);
+    CCcheck_rval (rval, "CCtsp_build_pricegraph failed");
+
+#ifdef CC_POSIXTHREADS
+    if (nthreads > cutcount) nthreads = cutcount;
+    if (nthreads > 1) {
+        rval = price_violations_threaded (&G, clist, cutcount, viol, lhs,
+                                          nthreads);
+        CCcheck_rval (rval, "price_violations_threaded failed");
+    } else {
+        price_violations (&G, clist, 0, cutcount, viol, lhs);
+    }
+#else
+    price_violations (&G, clist, 0, cutcount, viol, lhs);
+#endif
+
+    *p_cutcount = cutcount;
+    *p_viol = viol;
+    if (p_lhs) *p_lhs = lhs;
+    viol = (double *) NULL;
+    lhs = (double *) NULL;
+
+CLEANUP:
+
+    CCtsp_free_pricegraph (&G);
+    CC_IFFREE (clist, CCtsp_lpcut_in *);
+    CC_IFFREE (viol, double);
+    CC_IFFREE (lhs, double);
+    return rval;
+}
+
+static void price_violations (CCtsp_pricegraph *G, CCtsp_lpcut_in **clist,
+        int cstart, int cend, double *viol, double *lhs)
+{
+    double l;
+    int i;
+
+    for (i = cstart; i < cend; i++) {
+        viol[i] = CCtsp_cut_violation (G, clist[i], &l);
+        if (lhs) lhs[i] = l;
+    }
+}
+
+/* violation_size is the number of clique nodes of c, the part of the    */
+/* work of CCtsp_cut_violation that can be counted up front.             */
+
+static int violation_size (CCtsp_lpcut_in *c)
+{
+    int i, j, size = 1;
+
+    for (i = 0; i < c->cliquecount; i++) {
+        for (j = 0; j < c->cliques[i].segcount; j++) {
+            size += c->cliques[i].nodes[j].hi - c->cliques[i].nodes[j].lo + 1;
+        }
+    }
+    return size;
+}
+
 void CCtsp_free_lpcut_in (CCtsp_lpcut_in *c)
 {
     int i;
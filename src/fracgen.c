@@ -0,0 +1,369 @@
+/****************************************************************************/
+/*                                                                          */
+/*  This file is part of CONCORDE                                           */
+/*                                                                          */
+/*  (c) Copyright 1995--1999 by David Applegate, Robert Bixby,              */
+/*  Vasek Chvatal, and William Cook                                         */
+/*                                                                          */
+/*  Permission is granted for academic research use.  For other uses,       */
+/*  contact the authors for licensing options.                              */
+/*                                                                          */
+/*  Use at your own risk.  We make no guarantees about the                  */
+/*  correctness or usefulness of this code.                                 */
+/*                                                                          */
+/****************************************************************************/
+
+/****************************************************************************/
+/*                                                                          */
+/*                 GENERATE FRACTIONAL SOLUTIONS FOR TESTING                */
+/*                                                                          */
+/*                            TSP CODE                                      */
+/*                                                                          */
+/*                                                                          */
+/*    EXPORTED FUNCTIONS:                                                   */
+/*                                                                          */
+/*  int CCtsp_fractional_solution (int family, int ncount, double rate,     */
+/*      int k, CCrandstate *rstate, int *ecount, int **elist, double **x)   */
+/*    GENERATES an x-vector that looks like the support of an LP solution   */
+/*     (up to 2 times ncount edges, all of them at 1.0 or 0.5)              */
+/*     -family is one of                                                    */
+/*        CCtsp_FRACGEN_GEOMETRIC: the mean of a tour and a copy of it      */
+/*          with random local 2-opt moves (each position starts a move      */
+/*          with probability rate, reversing at most k nodes)               */
+/*        CCtsp_FRACGEN_BLOSSOMS: a tour with planted violated blossoms     */
+/*          (each position starts one with probability rate)                */
+/*        CCtsp_FRACGEN_PATHS: the mean of a tour and a copy of it with     */
+/*          long stretches of neighboring nodes swapped in pairs, which     */
+/*          gives long strips of 0.5 edges (each position starts a stretch  */
+/*          of k to 4k swaps with probability rate)                         */
+/*     -ncount is the number of nodes (at least 3)                          */
+/*     -rstate gives the random numbers, so a seed gives one solution       */
+/*     -ecount, elist, x return the solution (elist and x are allocated)    */
+/*    NOTES:                                                                */
+/*      The nodes are random points in the unit square and the tour         */
+/*      visits them along a snake through a grid of cells, so the edges     */
+/*      join points that are near each other (k-nearest-neighbor style)     */
+/*      and the node numbers are unrelated to the order of the tour.        */
+/*      Every node has x(delta(v)) = 2.  The GEOMETRIC and PATHS solutions  */
+/*      are in the subtour polytope and satisfy every comb.  A planted      */
+/*      blossom is a pair of odd cycles (3 or 5 nodes) of 0.5 edges, whose  */
+/*      nodes are matched by paths of 1.0 edges, one of them the rest of    */
+/*      the tour: it is a 2-matching, it satisfies the subtour              */
+/*      constraints, and it violates the blossom with a cycle as its        */
+/*      handle by 1.0.  The work and memory are linear in ncount.           */
+/*                                                                          */
+/****************************************************************************/
+
+#include "machdefs.h"
+#include "util.h"
+#include "macrorus.h"
+#include "tsp.h"
+
+#define FRACGEN_MAXLEN 2   /* interior nodes on a path of a planted blossom */
+
+
+static int
+    snake_tour (int ncount, int *tour, CCrandstate *rstate),
+    tours_to_x (int ncount, int *t0, int *t1, int *ecount, int *elist,
+        double *x),
+    coin (double p, CCrandstate *rstate);
+
+static void
+    perturb_geometric (int ncount, int *tour, double rate, int k,
+        CCrandstate *rstate),
+    perturb_paths (int ncount, int *tour, double rate, int k,
+        CCrandstate *rstate),
+    plant_blossoms (int ncount, int *tour, double rate, CCrandstate *rstate,
+        int *ecount, int *elist, double *x);
+
+static double
+    rand01 (CCrandstate *rstate);
+
+
+int CCtsp_fractional_solution (int family, int ncount, double rate, int k,
+        CCrandstate *rstate, int *ecount, int **elist, double **x)
+{
+    int *t0 = (int *) NULL;
+    int *t1 = (int *) NULL;
+    int i, rval = 0;
+
+    *ecount = 0;
+    *elist = (int *) NULL;
+    *x = (double *) NULL;
+
+    if (ncount < 3) {
+        fprintf (stderr, "need at least 3 nodes for a fractional solution\n");
+        rval = 1; goto CLEANUP;
+    }
+    if (family != CCtsp_FRACGEN_GEOMETRIC && family != CCtsp_FRACGEN_BLOSSOMS &&
+        family != CCtsp_FRACGEN_PATHS) {
+        fprintf (stderr, "unknown fractional solution family %d\n", family);
+        rval = 1; goto CLEANUP;
+    }
+    if (k < 2) k = 2;
+
+    t0 = CC_SAFE_MALLOC (ncount, int);
+    CCcheck_NULL (t0, "out of memory in CCtsp_fractional_solution");
+    *elist = CC_SAFE_MALLOC (4 * ncount, int);
+    CCcheck_NULL (*elist, "out of memory in CCtsp_fractional_solution");
+    *x = CC_SAFE_MALLOC (2 * ncount, double);
+    CCcheck_NULL (*x, "out of memory in CCtsp_fractional_solution");
+
+    rval = snake_tour (ncount, t0, rstate);
+    CCcheck_rval (rval, "snake_tour failed");
+
+    if (family == CCtsp_FRACGEN_BLOSSOMS) {
+        plant_blossoms (ncount, t0, rate, rstate, ecount, *elist, *x);
+    } else {
+        t1 = CC_SAFE_MALLOC (ncount, int);
+        CCcheck_NULL (t1, "out of memory in CCtsp_fractional_solution");
+        for (i = 0; i < ncount; i++) t1[i] = t0[i];
+        if (family == CCtsp_FRACGEN_GEOMETRIC) {
+            perturb_geometric (ncount, t1, rate, k, rstate);
+        } else {
+            perturb_paths (ncount, t1, rate, k, rstate);
+        }
+        rval = tours_to_x (ncount, t0, t1, ecount, *elist, *x);
+        CCcheck_rval (rval, "tours_to_x failed");
+    }
+
+CLEANUP:
+
+    if (rval) {
+        CC_IFFREE (*elist, int);
+        CC_IFFREE (*x, double);
+        *ecount = 0;
+    }
+    CC_IFFREE (t0, int);
+    CC_IFFREE (t1, int);
+    return rval;
+}
+
+/* snake_tour puts the nodes at random points and orders them by a grid   */
+/* of about ncount/2 cells, row by row, with every other row reversed;    */
+/* inside a cell the points are sorted along the direction of the row.    */
+
+static int snake_tour (int ncount, int *tour, CCrandstate *rstate)
+{
+    double *px = (double *) NULL;
+    double *py = (double *) NULL;
+    int *cell = (int *) NULL;
+    int *start = (int *) NULL;
+    int g, i, j, r, c, n, a, b;
+    double key;
+    int rval = 0;
+
+    g = (int) sqrt (ncount / 2.0);
+    if (g < 1) g = 1;
+
+    px = CC_SAFE_MALLOC (ncount, double);
+    CCcheck_NULL (px, "out of memory in snake_tour");
+    py = CC_SAFE_MALLOC (ncount, double);
+    CCcheck_NULL (py, "out of memory in snake_tour");
+    cell = CC_SAFE_MALLOC (ncount, int);
+    CCcheck_NULL (cell, "out of memory in snake_tour");
+    start = CC_SAFE_MALLOC (g * g + 1, int);
+    CCcheck_NULL (start, "out of memory in snake_tour");
+
+    for (i = 0; i <= g * g; i++) start[i] = 0;
+    for (i = 0; i < ncount; i++) {
+        px[i] = rand01 (rstate);
+        py[i] = rand01 (rstate);
+        r = (int) (py[i] * g);
+        c = (int) (px[i] * g);
+        if (r >= g) r = g - 1;
+        if (c >= g) c = g - 1;
+        if (r % 2) {
+            c = g - 1 - c;
+            px[i] = -px[i];    /* so the sort below runs along the row */
+        }
+        cell[i] = r * g + c;
+        start[cell[i] + 1]++;
+    }
+    for (i = 0; i < g * g; i++) start[i+1] += start[i];
+    for (i = 0; i < ncount; i++) {
+        tour[start[cell[i]]++] = i;
+    }
+
+    /* start[c] is now the end of cell c (and the start of cell c+1) */
+
+    for (c = 0; c < g * g; c++) {
+        a = (c == 0 ? 0 : start[c-1]);
+        b = start[c];
+        for (i = a + 1; i < b; i++) {
+            n = tour[i];
+            key = px[n];
+            for (j = i; j > a && px[tour[j-1]] > key; j--) {
+                tour[j] = tour[j-1];
+            }
+            tour[j] = n;
+        }
+    }
+
+CLEANUP:
+
+    CC_IFFREE (px, double);
+    CC_IFFREE (py, double);
+    CC_IFFREE (cell, int);
+    CC_IFFREE (start, int);
+    return rval;
+}
+
+/* perturb_geometric applies 2-opt moves that reverse tour[i+1..j] for   */
+/* i < j <= i+k; the moves can overlap.                                  */
+
+static void perturb_geometric (int ncount, int *tour, double rate, int k,
+        CCrandstate *rstate)
+{
+    int i, j, a, b, t;
+
+    for (i = 0; i + k + 1 < ncount; i++) {
+        if (coin (rate, rstate)) {
+            j = i + 2 + CCutil_lprand (rstate) % (k - 1);
+            for (a = i + 1, b = j; a < b; a++, b--) {
+                CC_SWAP (tour[a], tour[b], t);
+            }
+        }
+    }
+}
+
+/* perturb_paths swaps tour[i+1] and tour[i+2], tour[i+3] and tour[i+4], */
+/* and so on, along each stretch.                                        */
+
+static void perturb_paths (int ncount, int *tour, double rate, int k,
+        CCrandstate *rstate)
+{
+    int i, p, len, t;
+
+    for (i = 0; i + 3 < ncount; i++) {
+        if (coin (rate, rstate)) {
+            len = k + CCutil_lprand (rstate) % (3 * k + 1);
+            for (p = 0; p < len && i + 3 < ncount; p++, i += 2) {
+                CC_SWAP (tour[i+1], tour[i+2], t);
+            }
+        }
+    }
+}
+
+/* tours_to_x gives 0.5 to each edge of each tour (1.0 if in both).  An  */
+/* edge of one tour is in the other if its ends are neighbors there.     */
+
+static int tours_to_x (int ncount, int *t0, int *t1, int *ecount, int *elist,
+        double *x)
+{
+    int *pos0 = (int *) NULL;
+    int *pos1 = (int *) NULL;
+    int i, u, v, d, m = 0;
+    int rval = 0;
+
+    pos0 = CC_SAFE_MALLOC (ncount, int);
+    CCcheck_NULL (pos0, "out of memory in tours_to_x");
+    pos1 = CC_SAFE_MALLOC (ncount, int);
+    CCcheck_NULL (pos1, "out of memory in tours_to_x");
+
+    for (i = 0; i < ncount; i++) {
+        pos0[t0[i]] = i;
+        pos1[t1[i]] = i;
+    }
+
+    for (i = 0; i < ncount; i++) {
+        u = t0[i];
+        v = t0[(i + 1) % ncount];
+        d = pos1[u] - pos1[v];
+        elist[2*m] = u;
+        elist[2*m+1] = v;
+        if (d == 1 || d == -1 || d == ncount - 1 || d == 1 - ncount) {
+            x[m++] = 1.0;
+        } else {
+            x[m++] = 0.5;
+        }
+    }
+    for (i = 0; i < ncount; i++) {
+        u = t1[i];
+        v = t1[(i + 1) % ncount];
+        d = pos0[u] - pos0[v];
+        if (d != 1 && d != -1 && d != ncount - 1 && d != 1 - ncount) {
+            elist[2*m] = u;
+            elist[2*m+1] = v;
+            x[m++] = 0.5;
+        }
+    }
+    *ecount = m;
+
+CLEANUP:
+
+    CC_IFFREE (pos0, int);
+    CC_IFFREE (pos1, int);
+    return rval;
+}
+
+/* plant_blossoms walks along the tour, giving 1.0 to its edges, and     */
+/* replaces windows tour[i..i+size-1] (i >= 1) by a planted blossom.     */
+/* The first q nodes of the window are one odd cycle, the last q the     */
+/* other (in reverse), and the nodes between them the interiors of the   */
+/* paths from node p of the first cycle to node p of the second, for     */
+/* p = 1, ..., q-1.  Nodes 0 of the cycles keep their tour edges, so     */
+/* the rest of the tour is the path between them.                        */
+
+static void plant_blossoms (int ncount, int *tour, double rate,
+        CCrandstate *rstate, int *ecount, int *elist, double *x)
+{
+    int len[5];
+    int i, p, l, q, size, pos, prev, m = 0;
+    int *w, *c2;
+
+#define ADD_EDGE(a, b, val) {                                            \
+    elist[2*m] = (a); elist[2*m+1] = (b); x[m++] = (val);                \
+}
+
+    i = 0;
+    while (i < ncount) {
+        size = 0;
+        if (i >= 1 && coin (rate, rstate)) {
+            q = (CCutil_lprand (rstate) % 4 == 0 ? 5 : 3);
+            size = 2 * q;
+            for (p = 1; p < q; p++) {
+                len[p] = CCutil_lprand (rstate) % (FRACGEN_MAXLEN + 1);
+                size += len[p];
+            }
+            if (i + size > ncount) size = 0;
+        }
+        if (size == 0) {
+            ADD_EDGE (tour[i], tour[(i + 1) % ncount], 1.0);
+            i++;
+            continue;
+        }
+
+        w = tour + i;
+        c2 = tour + i + size - q;
+        for (p = 0; p < q; p++) {
+            ADD_EDGE (w[p], w[(p + 1) % q], 0.5);
+            ADD_EDGE (c2[p], c2[(p + 1) % q], 0.5);
+        }
+        pos = q;
+        for (p = 1; p < q; p++) {
+            prev = w[p];
+            for (l = 0; l < len[p]; l++) {
+                ADD_EDGE (prev, w[pos], 1.0);
+                prev = w[pos++];
+            }
+            ADD_EDGE (prev, c2[q - 1 - p], 1.0);
+        }
+        ADD_EDGE (w[size - 1], tour[(i + size) % ncount], 1.0);
+        i += size;
+    }
+
+#undef ADD_EDGE
+
+    *ecount = m;
+}
+
+static int coin (double p, CCrandstate *rstate)
+{
+    return (double) CCutil_lprand (rstate) < p * (double) CC_PRANDMAX;
+}
+
+static double rand01 (CCrandstate *rstate)
+{
+    return (double) CCutil_lprand (rstate) / (double) CC_PRANDMAX;
+}
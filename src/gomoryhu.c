@@ -28,14 +28,64 @@
 /*                                                                          */
 /*  int CCcut_gomory_hu (CC_GHtree *T, int ncount, int ecount,              */
 /*      int *elist, double *ecap, int markcount, int *marks,                */
-/*      CCrandstate *rstate)                                                */
+/*      CCrandstate *rstate, int flowalg)                                   */
 /*    COMPUTES the Gomory-Hu tree of the marked nodes in G.                 */
-/*     -T returns the tree (a description is given in the code below)       */
+/*     -T returns the tree (the layout is described in the NOTES below)     */
 /*     -ncount, ecount, elist specify the input graph                       */
 /*     -ecap lists the capacities of the edges                              */
 /*     -markcount is the length of the array marks (if markcount is 0,      */
 /*      then every node is a terminal)                                      */
 /*     -marks lists the special nodes (the terminals)                       */
+/*     -flowalg is the max-flow code (CC_FLOW_HIGHEST_LABEL, CC_FLOW_FIFO,  */
+/*      CC_FLOW_PSEUDOFLOW or CC_FLOW_BK, see CCcut_mincut_st)              */
+/*    Each shrunken graph is loaded into one CCcut_flowctx, so the flow     */
+/*     network is only allocated again when a graph is larger than all      */
+/*     the ones before it.                                                  */
+/*                                                                          */
+/*  int CCcut_gusfield_gomory_hu (CC_GHtree *T, int ncount, int ecount,     */
+/*      int *elist, double *ecap, int markcount, int *marks, int flowalg)   */
+/*    COMPUTES the same tree as CCcut_gomory_hu, by Gusfield's method.      */
+/*     The ncount - 1 flows are all run on the one network (a               */
+/*     CCcut_flowctx), so nothing is shrunk, copied or allocated between    */
+/*     them.  The arguments and the returned layout are as above.           */
+/*                                                                          */
+/*  int CCcut_gomory_hu_threaded (CC_GHtree *T, int ncount, int ecount,     */
+/*      int *elist, double *ecap, int markcount, int *marks,                */
+/*      CCrandstate *rstate, int nthreads, int flowalg)                     */
+/*    COMPUTES the same kind of tree as CCcut_gomory_hu, with the           */
+/*     subproblems left after each split run as tasks by nthreads           */
+/*     threads.  Each task works on its own copy of its contracted graph;   */
+/*     each thread runs its flows in its own CCcut_flowctx.                 */
+/*     -nthreads is the number of threads to use.  0 ==> sequential code    */
+/*      threads are only used if CC_POSIXTHREADS is defined                 */
+/*    NOTES:                                                                */
+/*      The tree depends on rstate, but not on nthreads or on the order in  */
+/*      which the tasks are run: each task draws its s-t pair from its own  */
+/*      seed, and the tree edges are sorted before the layout.  It is not   */
+/*      the tree that CCcut_gomory_hu returns for the same rstate.          */
+/*                                                                          */
+/*  int CCcut_gomory_hu_update (CC_GHtree *T, int ncount, int ecount,      */
+/*      int *elist, double *ecap, int markcount, int *marks, int chcount,   */
+/*      int *chlist, double *oldcap, CCrandstate *rstate, int flowalg,      */
+/*      int *flowcount)                                                     */
+/*    UPDATES the Gomory-Hu tree T of the marked nodes of G after some of   */
+/*     the capacities changed.                                              */
+/*     -T is a tree of the same graph and marks with the capacities in      */
+/*      oldcap, as returned by any of the codes above; it is replaced by a  */
+/*      tree for ecap                                                       */
+/*     -chlist lists the chcount edges whose capacities may have changed    */
+/*      (oldcap is only read on these)                                      */
+/*     -flowcount returns the number of flows (it can be NULL)              */
+/*    NOTES:                                                                */
+/*      The tree edges whose cuts are crossed by an edge that went up are   */
+/*      rebuilt.  Where edges went down, the edges off their paths stay     */
+/*      minimum cuts unless their values are above the smallest new u-v     */
+/*      cut over the decreased edges (u,v); this is bounded from the old    */
+/*      tree when u and v are terminals, and by a flow otherwise.  The      */
+/*      edges to rebuild are contracted and each of the resulting tree      */
+/*      nodes is split again as in CCcut_gomory_hu_threaded, with the       */
+/*      rest of the tree beyond each kept edge shrunk to a node.  The       */
+/*      tree is laid out as by CCcut_gomory_hu_threaded.                    */
 /*                                                                          */
 /*  void CCcut_GHtreefree (CC_GHtree *T)                                    */
 /*    FREES the tree pointed by T.                                          */
@@ -43,14 +93,50 @@
 /*  void CCcut_GHtreeinit (CC_GHtree *T)                                    */
 /*    INITIALIZES the fields of T to NULL.                                  */
 /*                                                                          */
+/*  void CCcut_GHtreeunscale (CC_GHtree *T, double scale)                   */
+/*    DIVIDES the value of each tree edge by scale, to bring a tree built   */
+/*     on capacities from CCcut_scale_capacities back to the original       */
+/*     units (the root keeps its value).                                    */
+/*                                                                          */
 /*  void CCcut_GHtreeprint (CC_GHtree *T)                                   */
 /*       PRINTS the Gomory-Hu tree to stdout.                               */
 /*                                                                          */
+/*  int CCcut_GHtreewrite (CC_SFILE *f, CC_GHtree *T)                       */
+/*    WRITES the tree T to f.                                               */
+/*                                                                          */
+/*  int CCcut_GHtreeread (CC_SFILE *f, CC_GHtree *T)                        */
+/*    READS a tree written by CCcut_GHtreewrite into T (which should be     */
+/*     initialized; it is not freed first).                                 */
 /*    NOTES:                                                                */
+/*      The file holds no description of the graph; a caller caching trees  */
+/*      between runs should store what it needs to recognize the instance  */
+/*      (and check T->ncount against it).                                   */
+/*                                                                          */
+/*    NOTES:                                                                */
+/*                                                                          */
+/*      A tree is a set of arrays over its tcount nodes, numbered in DFS    */
+/*      order from the root 0, so a scan over 0, ..., tcount - 1 meets      */
+/*      each node after its parent, and the subtree of node k is the        */
+/*      interval k, ..., k + ndescendants[k] - 1.  parent[k] < k is the     */
+/*      parent of k (-1 for the root), cutval[k] the value of the edge      */
+/*      from k to its parent (1e30 for the root), and special[k] the        */
+/*      terminal of k.  The ncount graph nodes of tree node k are           */
+/*      nodes[nodebeg[k]], ..., nodes[nodebeg[k+1] - 1], with the nodes of  */
+/*      each subtree in one interval of nodes.  An empty tree has           */
+/*      tcount 0.                                                           */
 /*                                                                          */
 /*      This code has only been tested on the instances that arise in       */
 /*      exact blossom seperation.                                           */
 /*                                                                          */
+/*      Gusfield's method needs no contraction, but it takes every node     */
+/*      (not only the terminals) as a source, so it runs ncount - 1 flows   */
+/*      against markcount - 1.  The cut tree over all nodes is then         */
+/*      reduced to the terminals by merging each node without a terminal    */
+/*      into its neighbor across its heaviest tree edge, which keeps every  */
+/*      remaining tree cut a minimum cut.  See D. Gusfield, "Very simple    */
+/*      methods for all pairs network flow analysis", SIAM J. Computing     */
+/*      19 (1990) 143-155.                                                  */
+/*                                                                          */
 /****************************************************************************/
 
 #include "machdefs.h"
@@ -58,6 +144,7 @@
 #include "cut.h"
 
 #define GH_MAXDOUBLE  (1e30)
+#define GH_TREE_VERSION 1
 #define OTHEREND(e,n) ((e)->ends[0] == (n) ? (e)->ends[1] : (e)->ends[0])
 
 typedef struct edge {
@@ -110,12 +197,73 @@ typedef struct cuttree_node {
     struct cuttree_node *next;
 } cuttree_node;
 
+/* A ghtask is one node of the cut tree still to be split, with its own  */
+/* contracted graph: the first rcount nodes are graph nodes (names gives  */
+/* their numbers) and the others stand for the rest of the tree, one per  */
+/* tree edge at the node (names gives 2*edge + end, the end of the edge   */
+/* that will belong to the tree node the pseudonode ends up in).  terms   */
+/* lists the terminals, all among the first rcount nodes.                 */
+
+typedef struct ghtask {
+    int                  ncount;
+    int                  rcount;
+    int                  ecount;
+    int                  tcount;
+    int                 *names;
+    int                 *elist;
+    double              *ecap;
+    int                 *terms;
+    CCrandstate          rstate;
+    struct ghtask       *prev;
+    struct ghtask       *next;
+} ghtask;
+
+/* Each worker runs the tasks of its own deque from the back and steals  */
+/* from the front of the others.  queued counts the tasks in the deques  */
+/* and pending the tasks not yet finished; both are kept under lock.     */
+
+typedef struct ghdeque {
+    ghtask              *head;
+    ghtask              *tail;
+    int                 *side;
+    int                 *newname;
+    int                 *cut;
+    double              *acc;
+    CCcut_flowctx       *flow;
+#ifdef CC_POSIXTHREADS
+    pthread_mutex_t      lock;
+#endif
+} ghdeque;
+
+typedef struct ghpar {
+    int                  nworkers;
+    ghdeque             *dq;
+    int                 *owner;
+    int                 *tnum;
+    int                 *tends;
+    double              *tval;
+    int                  tecount;
+    int                  queued;
+    int                  pending;
+    int                  rval;
+#ifdef CC_POSIXTHREADS
+    pthread_mutex_t      lock;
+    pthread_cond_t       wake;
+#endif
+} ghpar;
+
+typedef struct ghworker_args {
+    ghpar               *P;
+    int                  id;
+} ghworker_args;
+
 typedef struct graph {
     int                  ncount;
     node                *nodelist;
     int                  ecount;
     edge                *edgelist;
     int                  magicnum;
+    CCcut_flowctx       *flow;
     CCptrworld           edge_world;
     CCptrworld           edgeptr_world;
     CCptrworld           nodeptr_world;
@@ -134,7 +282,18 @@ CC_PTRWORLD_LISTFREE_ROUTINE (nodeptr, nodeptr_listfree, nodeptrfree)
 CC_PTRWORLD_LEAKS_ROUTINE (nodeptr, nodeptr_check_leaks, this, node *)
 
 
+#ifdef CC_POSIXTHREADS
 static void
+   *ghworker_thread (void *args);
+#endif
+
+static void
+    ghpar_init (ghpar *P),
+    ghpar_free (ghpar *P),
+    ghworker (ghpar *P, int id),
+    ghtask_free (ghtask *t),
+    ghtask_push (ghpar *P, int id, ghtask *t),
+    ghtask_leaf (ghpar *P, ghtask *t),
     ghlink_free_world (graph *G),
     cuttree_free_work (cuttree_node *n, CCptrworld *nodeptr_world),
     delfromnodeset (nodeset *s, node *n, CCptrworld *nodeptr_world),
@@ -146,13 +305,25 @@ static void
     freenodeset (nodeset *s, CCptrworld *nodeptr_world),
     initgraph (graph *G),
     freegraph (graph *G),
-    treefree_work (CC_GHnode *p),
     set_parents (cuttree_node *n),
-    copy_dfs (cuttree_node *n, int *k, CC_GHnode *supply, int **listspace),
-    cut_dfs (cuttree_node *n, int *k),
-    print_tree_work (CC_GHnode *n);
+    copy_dfs (cuttree_node *n, int *k, CC_GHtree *T, int *pos),
+    cut_dfs (cuttree_node *n, int *k);
 
 static int
+    ghpar_alloc (ghpar *P, int nworkers, int ncount, int markcount,
+        int *marks, int *tnode, int flowalg),
+    ghpar_layout (ghpar *P, CC_GHtree *T, int ncount, int tcount,
+        int *tnode),
+    ghtask_split (ghpar *P, int id, ghtask *t),
+    ghtask_shrink (ghtask *t, int *side, int keep, int pend, int *newname,
+        double *acc, ghtask **pnew),
+    ghtask_alloc (int ncount, int ecount, int tcount, ghtask **pnew),
+    gusfield_find (int *uf, int i),
+    gusfield_tree (CC_GHtree *T, int ncount, int *p, double *fl,
+        int *isterm),
+    layout_tree (CC_GHtree *T, int ncount, int tcount, int *grp,
+        int *tnode, int tecount, int *tends, double *tval),
+    tree_alloc (CC_GHtree *T, int tcount, int ncount),
     addtonodeset (nodeset *s, node *n, CCptrworld *nodeptr_world),
     shrinkdown (graph *G, nodeset *a, node *pseudo, edgeset *esave, int num),
     gh_work (graph *G, cuttree_node *n, nodeset *nlist, nodeset *special,
@@ -165,7 +336,7 @@ static int
 
 
 /*
- gomory_hu returns a pointer to the root of a rooted cut tree.  The tree is
+ gh_work builds a rooted cut tree of cuttree_nodes.  The tree is
    described by the parent, sibling, and child pointers.
  cutval is the weight on the cut (or, edge) between a node and its parent.
  ndescendants is the total number of nodes in the subtree rooted at that
@@ -175,15 +346,15 @@ static int
  nlist is a nodeset containing all of the nodes of the graph grouped with the
    special node.  nlist contains special.
  pseudonode and next are work area.
- The calling routine should call cuttree_free(root) after it is done with the
-   cuttree.
+ copy_cuttree then lays the tree out in the arrays of a CC_GHtree.
 
  gomory_hu constructs the min-cut tree for the nodes with mark = 1.
 */
 
 
 int CCcut_gomory_hu (CC_GHtree *T, int ncount, int ecount, int *elist,
-        double *ecap, int markcount, int *marks, CCrandstate *rstate)
+        double *ecap, int markcount, int *marks, CCrandstate *rstate,
+        int flowalg)
 {
     nodeset special;
     nodeset nlist;
@@ -203,6 +374,17 @@ int CCcut_gomory_hu (CC_GHtree *T, int ncount, int ecount, int *elist,
     }
     if (markcount == 0) markcount = ncount;   /* all nodes are terminals */
 
+    /* one flow network, reloaded with each shrunken graph in gh_work */
+    rval = CCcut_flowctx_create (&G.flow, 0, 0, (int *) NULL,
+                                 (double *) NULL);
+    if (rval) {
+        fprintf (stderr, "CCcut_flowctx_create failed\n"); goto CLEANUP;
+    }
+    rval = CCcut_flowctx_algorithm (G.flow, flowalg);
+    if (rval) {
+        fprintf (stderr, "CCcut_flowctx_algorithm failed\n"); goto CLEANUP;
+    }
+
     supply = CC_SAFE_MALLOC (markcount + 1, cuttree_node);
     if (!supply) {
         fprintf (stderr, "out of memory in CCcut_gomory_hu\n");
@@ -266,6 +448,1241 @@ CLEANUP:
     return rval;
 }
 
+/* gusfield_gomory_hu keeps the tree as a parent array p (rooted at node  */
+/* 0) with fl[i] the value of the edge from i to p[i].  When s is cut     */
+/* from t = p[s], the nodes hanging off t on the side of s move to s, and */
+/* s takes the place of t if p[t] is on its side.                         */
+
+int CCcut_gusfield_gomory_hu (CC_GHtree *T, int ncount, int ecount,
+        int *elist, double *ecap, int markcount, int *marks, int flowalg)
+{
+    CCcut_flowctx *F = (CCcut_flowctx *) NULL;
+    int    *p      = (int *) NULL;
+    int    *cut    = (int *) NULL;
+    int    *stamp  = (int *) NULL;
+    int    *isterm = (int *) NULL;
+    double *fl     = (double *) NULL;
+    double val;
+    int i, s, t, cutcount;
+    int rval = 0;
+
+    if (ncount < 1) {
+        fprintf (stderr, "no nodes in CCcut_gusfield_gomory_hu\n");
+        rval = 1; goto CLEANUP;
+    }
+
+    p      = CC_SAFE_MALLOC (ncount, int);
+    cut    = CC_SAFE_MALLOC (ncount, int);
+    stamp  = CC_SAFE_MALLOC (ncount, int);
+    isterm = CC_SAFE_MALLOC (ncount, int);
+    fl     = CC_SAFE_MALLOC (ncount, double);
+    if (!p || !cut || !stamp || !isterm || !fl) {
+        fprintf (stderr, "out of memory in CCcut_gusfield_gomory_hu\n");
+        rval = 1; goto CLEANUP;
+    }
+
+    for (i = 0; i < ncount; i++) {
+        p[i]      = 0;
+        fl[i]     = 0.0;
+        stamp[i]  = 0;
+        isterm[i] = (markcount ? 0 : 1);
+    }
+    p[0]  = -1;
+    fl[0] = GH_MAXDOUBLE;
+    for (i = 0; i < markcount; i++) {
+        isterm[marks[i]] = 1;
+    }
+
+    if (ncount > 1) {
+        rval = CCcut_flowctx_create (&F, ncount, ecount, elist, ecap);
+        if (rval) {
+            fprintf (stderr, "CCcut_flowctx_create failed\n"); goto CLEANUP;
+        }
+        rval = CCcut_flowctx_algorithm (F, flowalg);
+        if (rval) {
+            fprintf (stderr, "CCcut_flowctx_algorithm failed\n"); goto CLEANUP;
+        }
+    }
+
+    for (s = 1; s < ncount; s++) {
+        t = p[s];
+        rval = CCcut_flowctx_solve (F, s, t, &val, cut, &cutcount);
+        if (rval) {
+            fprintf (stderr, "CCcut_flowctx_solve failed\n"); goto CLEANUP;
+        }
+        for (i = 0; i < cutcount; i++) {
+            stamp[cut[i]] = s;           /* the side of t */
+        }
+        fl[s] = val;
+        for (i = 0; i < ncount; i++) {
+            if (p[i] == t && stamp[i] != s && i != s) p[i] = s;
+        }
+        if (p[t] != -1 && stamp[p[t]] != s) {
+            p[s]  = p[t];
+            p[t]  = s;
+            fl[s] = fl[t];
+            fl[t] = val;
+        }
+    }
+
+    rval = gusfield_tree (T, ncount, p, fl, isterm);
+    if (rval) {
+        fprintf (stderr, "gusfield_tree failed\n"); goto CLEANUP;
+    }
+
+CLEANUP:
+
+    CCcut_flowctx_destroy (&F);
+    CC_IFFREE (p, int);
+    CC_IFFREE (cut, int);
+    CC_IFFREE (stamp, int);
+    CC_IFFREE (isterm, int);
+    CC_IFFREE (fl, double);
+    return rval;
+}
+
+int CCcut_gomory_hu_threaded (CC_GHtree *T, int ncount, int ecount,
+        int *elist, double *ecap, int markcount, int *marks,
+        CCrandstate *rstate, int nthreads, int flowalg)
+{
+    ghpar P;
+    ghtask *t = (ghtask *) NULL;
+    ghworker_args *args = (ghworker_args *) NULL;
+    int *tnode  = (int *) NULL;
+    int i, tcount, nworkers = 1, started = 0;
+    int rval = 0;
+#ifdef CC_POSIXTHREADS
+    pthread_t *thread_id = (pthread_t *) NULL;
+    void *thr_rval;
+#endif
+
+#ifdef CC_POSIXTHREADS
+    if (nthreads > 1) nworkers = nthreads;
+#else
+    (void) nthreads;
+#endif
+    ghpar_init (&P);
+
+    if (ncount < 1) {
+        fprintf (stderr, "no nodes in CCcut_gomory_hu_threaded\n");
+        rval = 1; goto CLEANUP;
+    }
+    tcount = (markcount ? markcount : ncount);
+
+    tnode = CC_SAFE_MALLOC (tcount, int);
+    if (!tnode) {
+        fprintf (stderr, "out of memory in CCcut_gomory_hu_threaded\n");
+        rval = 1; goto CLEANUP;
+    }
+    rval = ghpar_alloc (&P, nworkers, ncount, markcount, marks, tnode,
+                        flowalg);
+    if (rval) {
+        fprintf (stderr, "ghpar_alloc failed\n"); goto CLEANUP;
+    }
+
+    /* the first task is the whole graph */
+
+    rval = ghtask_alloc (ncount, ecount, tcount, &t);
+    if (rval) {
+        fprintf (stderr, "ghtask_alloc failed\n"); goto CLEANUP;
+    }
+    t->rcount = ncount;
+    for (i = 0; i < ncount; i++) t->names[i] = i;
+    for (i = 0; i < 2 * ecount; i++) t->elist[i] = elist[i];
+    for (i = 0; i < ecount; i++) t->ecap[i] = ecap[i];
+    for (i = 0; i < tcount; i++) t->terms[i] = tnode[i];
+    CCutil_sprand (CCutil_lprand (rstate), &t->rstate);
+
+#ifdef CC_POSIXTHREADS
+    if (P.nworkers > 1) {
+        pthread_mutex_init (&P.lock, (pthread_mutexattr_t *) NULL);
+        pthread_cond_init (&P.wake, (pthread_condattr_t *) NULL);
+        for (i = 0; i < P.nworkers; i++) {
+            pthread_mutex_init (&P.dq[i].lock, (pthread_mutexattr_t *) NULL);
+        }
+    }
+#endif
+
+    P.pending = 1;
+    ghtask_push (&P, 0, t);
+    t = (ghtask *) NULL;
+
+#ifdef CC_POSIXTHREADS
+    if (P.nworkers > 1) {
+        thread_id = CC_SAFE_MALLOC (P.nworkers, pthread_t);
+        args = CC_SAFE_MALLOC (P.nworkers, ghworker_args);
+        if (!thread_id || !args) {
+            fprintf (stderr, "out of memory in CCcut_gomory_hu_threaded\n");
+            P.rval = 1;
+        }
+        for (i = 0; i < P.nworkers && !P.rval; i++) {
+            args[i].P  = &P;
+            args[i].id = i;
+            if (pthread_create (&thread_id[i], (pthread_attr_t *) NULL,
+                                ghworker_thread, &args[i])) {
+                fprintf (stderr, "pthread_create failed\n");
+                pthread_mutex_lock (&P.lock);
+                P.rval = 1;
+                pthread_cond_broadcast (&P.wake);
+                pthread_mutex_unlock (&P.lock);
+                break;
+            }
+            started++;
+        }
+        for (i = 0; i < started; i++) {
+            if (pthread_join (thread_id[i], &thr_rval)) {
+                fprintf (stderr, "pthread_join failed\n");
+                P.rval = 1;
+            }
+        }
+        for (i = 0; i < P.nworkers; i++) {
+            pthread_mutex_destroy (&P.dq[i].lock);
+        }
+        pthread_cond_destroy (&P.wake);
+        pthread_mutex_destroy (&P.lock);
+    } else {
+        ghworker (&P, 0);
+    }
+#else
+    ghworker (&P, 0);
+#endif
+    if (P.rval) {
+        fprintf (stderr, "Gomory-Hu task failed\n");
+        rval = 1; goto CLEANUP;
+    }
+
+    rval = ghpar_layout (&P, T, ncount, tcount, tnode);
+    if (rval) {
+        fprintf (stderr, "ghpar_layout failed\n"); goto CLEANUP;
+    }
+
+CLEANUP:
+
+    if (t) ghtask_free (t);
+    ghpar_free (&P);
+#ifdef CC_POSIXTHREADS
+    CC_IFFREE (thread_id, pthread_t);
+#endif
+    CC_IFFREE (args, ghworker_args);
+    CC_IFFREE (tnode, int);
+    return rval;
+}
+
+/* GH_UPDATE_FLOWDIV bounds the flows CCcut_gomory_hu_update spends on  */
+/* the decreased edges: at most (tcount - 1) / GH_UPDATE_FLOWDIV, beyond  */
+/* which the tree edges they could save are rebuilt instead.              */
+
+#define GH_UPDATE_FLOWDIV 4
+
+int CCcut_gomory_hu_update (CC_GHtree *T, int ncount, int ecount,
+        int *elist, double *ecap, int markcount, int *marks, int chcount,
+        int *chlist, double *oldcap, CCrandstate *rstate, int flowalg,
+        int *flowcount)
+{
+    ghpar P;
+    CC_GHtree N;
+    CCcut_flowctx *F = (CCcut_flowctx *) NULL;
+    ghtask *t = (ghtask *) NULL;
+    int *tnode  = (int *) NULL;
+    int *tk     = (int *) NULL;
+    int *tpar   = (int *) NULL;
+    int *depth  = (int *) NULL;
+    int *bad    = (int *) NULL;
+    int *uf     = (int *) NULL;
+    int *eid    = (int *) NULL;
+    int *tterm  = (int *) NULL;
+    int *lab    = (int *) NULL;
+    int *vis    = (int *) NULL;
+    int *stack  = (int *) NULL;
+    int *adjbeg = (int *) NULL;
+    int *adj    = (int *) NULL;
+    int *loc    = (int *) NULL;
+    int *pname  = (int *) NULL;
+    int *dec    = (int *) NULL;
+    double *lam = (double *) NULL;
+    double d, dtot = 0.0, lbd, hi, lo, val, oldval;
+    int i, j, k, e, a, b, r, w, tcount, ndec = 0, nkept = 0, top;
+    int rcount, q, ecnt, maxflows, flows = 0, cutcount;
+    int rval = 0;
+
+    CCcut_GHtreeinit (&N);
+    ghpar_init (&P);
+    if (flowcount) *flowcount = 0;
+
+    tcount = (markcount ? markcount : ncount);
+    if (T->tcount != tcount || T->ncount != ncount) {
+        fprintf (stderr, "tree does not match the graph\n");
+        rval = 1; goto CLEANUP;
+    }
+
+    tnode  = CC_SAFE_MALLOC (tcount, int);
+    tk     = CC_SAFE_MALLOC (ncount, int);
+    tpar   = CC_SAFE_MALLOC (tcount, int);
+    depth  = CC_SAFE_MALLOC (tcount, int);
+    bad    = CC_SAFE_MALLOC (tcount, int);
+    uf     = CC_SAFE_MALLOC (tcount, int);
+    eid    = CC_SAFE_MALLOC (tcount, int);
+    tterm  = CC_SAFE_MALLOC (tcount, int);
+    lab    = CC_SAFE_MALLOC (tcount, int);
+    vis    = CC_SAFE_MALLOC (tcount, int);
+    stack  = CC_SAFE_MALLOC (tcount, int);
+    adjbeg = CC_SAFE_MALLOC (tcount + 1, int);
+    adj    = CC_SAFE_MALLOC (2 * tcount, int);
+    loc    = CC_SAFE_MALLOC (ncount, int);
+    pname  = CC_SAFE_MALLOC (tcount, int);
+    dec    = CC_SAFE_MALLOC (2 * chcount + 1, int);
+    lam    = CC_SAFE_MALLOC (tcount, double);
+    if (!tnode || !tk || !tpar || !depth || !bad || !uf || !eid ||
+        !tterm || !lab || !vis || !stack || !adjbeg || !adj || !loc ||
+        !pname || !dec || !lam) {
+        fprintf (stderr, "out of memory in CCcut_gomory_hu_update\n");
+        rval = 1; goto CLEANUP;
+    }
+    rval = ghpar_alloc (&P, 1, ncount, markcount, marks, tnode, flowalg);
+    if (rval) {
+        fprintf (stderr, "ghpar_alloc failed\n"); goto CLEANUP;
+    }
+
+    /* the old tree; it is in DFS order, so parents come first */
+
+    for (k = 0; k < tcount; k++) {
+        tpar[k] = T->parent[k];
+        if ((k == 0) != (tpar[k] == -1) || tpar[k] >= k) {
+            fprintf (stderr, "tree is not in DFS order\n");
+            rval = 1; goto CLEANUP;
+        }
+        depth[k] = (k ? depth[tpar[k]] + 1 : 0);
+        lam[k]   = T->cutval[k];
+        bad[k]   = 0;
+        uf[k]    = k;
+        tterm[k] = P.tnum[T->special[k]];
+        for (i = T->nodebeg[k]; i < T->nodebeg[k+1]; i++) {
+            tk[T->nodes[i]] = k;
+        }
+    }
+
+    /* a changed edge changes the cut of each tree edge on its path; an  */
+    /* increase can leave such a cut no longer minimum                   */
+
+    for (i = 0; i < chcount; i++) {
+        e = chlist[i];
+        d = ecap[e] - oldcap[e];
+        if (d == 0.0) continue;
+        a = tk[elist[2*e]];
+        b = tk[elist[2*e+1]];
+        while (a != b) {
+            if (depth[a] < depth[b]) {
+                k = a; a = b; b = k;
+            }
+            lam[a] += d;
+            if (d > 0.0) bad[a] = 1;
+            a = tpar[a];
+        }
+        if (d < 0.0) {
+            dec[2*ndec]   = elist[2*e];
+            dec[2*ndec+1] = elist[2*e+1];
+            ndec++;
+            dtot -= d;
+        }
+    }
+
+    /* a cut that got below the value of a tree edge off those paths     */
+    /* crosses a decreased edge (u,v), so it is at least the new minimum  */
+    /* u-v cut; the edges above the smallest of these are rebuilt.  For   */
+    /* two terminals, the old tree less the total decrease is a bound     */
+    /* that needs no flow.                                                */
+
+    if (ndec > 0) {
+        hi = -GH_MAXDOUBLE;
+        lo =  GH_MAXDOUBLE;
+        for (k = 1; k < tcount; k++) {
+            if (!bad[k]) {
+                if (lam[k] > hi) hi = lam[k];
+                if (lam[k] < lo) lo = lam[k];
+            }
+        }
+        maxflows = (tcount - 1) / GH_UPDATE_FLOWDIV;
+        lbd = GH_MAXDOUBLE;
+        for (i = 0; i < ndec && lbd >= lo; i++) {
+            a = dec[2*i];
+            b = dec[2*i+1];
+            val = -GH_MAXDOUBLE;
+            if (P.tnum[a] != -1 && P.tnum[b] != -1) {
+                a = tk[a];
+                b = tk[b];
+                oldval = GH_MAXDOUBLE;
+                while (a != b) {
+                    if (depth[a] < depth[b]) {
+                        k = a; a = b; b = k;
+                    }
+                    if (T->cutval[a] < oldval) oldval = T->cutval[a];
+                    a = tpar[a];
+                }
+                val = oldval - dtot;
+            }
+            if (val < hi) {
+                if (flows >= maxflows) {
+                    lbd = -GH_MAXDOUBLE;
+                    break;
+                }
+                if (!F) {
+                    rval = CCcut_flowctx_create (&F, ncount, ecount, elist,
+                                                 ecap);
+                    if (rval) {
+                        fprintf (stderr, "CCcut_flowctx_create failed\n");
+                        goto CLEANUP;
+                    }
+                    rval = CCcut_flowctx_algorithm (F, flowalg);
+                    if (rval) {
+                        fprintf (stderr, "CCcut_flowctx_algorithm failed\n");
+                        goto CLEANUP;
+                    }
+                }
+                rval = CCcut_flowctx_solve (F, dec[2*i], dec[2*i+1], &val,
+                                            P.dq[0].cut, &cutcount);
+                if (rval) {
+                    fprintf (stderr, "CCcut_flowctx_solve failed\n");
+                    goto CLEANUP;
+                }
+                flows++;
+            }
+            if (val < lbd) lbd = val;
+        }
+        for (k = 1; k < tcount; k++) {
+            if (!bad[k] && lam[k] > lbd) bad[k] = 1;
+        }
+    }
+
+    /* the bad edges are contracted; each kept edge keeps its value */
+
+    for (k = 1; k < tcount; k++) {
+        if (bad[k]) {
+            a = gusfield_find (uf, k);
+            b = gusfield_find (uf, tpar[k]);
+            uf[a] = b;
+        } else {
+            eid[k] = nkept;
+            P.tval[nkept++] = lam[k];
+        }
+    }
+    P.tecount = nkept;
+
+    for (k = 0; k < tcount; k++) vis[k] = 0;
+    for (k = 0; k < tcount; k++) vis[gusfield_find (uf, k)]++;
+
+    /* a tree node left alone is finished, as in ghtask_leaf */
+
+    for (i = 0; i < ncount; i++) {
+        k = tk[i];
+        if (vis[gusfield_find (uf, k)] == 1) P.owner[i] = tterm[k];
+    }
+    for (k = 1; k < tcount; k++) {
+        if (bad[k]) continue;
+        if (vis[gusfield_find (uf, k)] == 1) {
+            P.tends[2*eid[k]] = tterm[k];
+        }
+        if (vis[gusfield_find (uf, tpar[k])] == 1) {
+            P.tends[2*eid[k]+1] = tterm[tpar[k]];
+        }
+    }
+
+    /* each larger supernode is a task, with one pseudonode for each kept */
+    /* edge at it, standing for the rest of the tree beyond that edge     */
+
+    for (k = 0; k <= tcount; k++) adjbeg[k] = 0;
+    for (k = 1; k < tcount; k++) {
+        adjbeg[k+1]++;
+        adjbeg[tpar[k]+1]++;
+    }
+    for (k = 0; k < tcount; k++) adjbeg[k+1] += adjbeg[k];
+    for (k = 0; k < tcount; k++) lab[k] = adjbeg[k];
+    for (k = 1; k < tcount; k++) {
+        adj[lab[k]++] = tpar[k];
+        adj[lab[tpar[k]]++] = k;
+    }
+
+    for (r = 0; r < tcount; r++) {
+        if (gusfield_find (uf, r) != r || vis[r] < 2) continue;
+
+        for (k = 0; k < tcount; k++) lab[k] = -2;
+        top = 0;
+        q = 0;
+        for (k = 0; k < tcount; k++) {
+            if (gusfield_find (uf, k) == r) {
+                lab[k] = -1;
+                stack[top++] = k;
+            }
+        }
+        while (top > 0) {
+            k = stack[--top];
+            for (j = adjbeg[k]; j < adjbeg[k+1]; j++) {
+                w = adj[j];
+                if (lab[w] != -2) continue;
+                if (lab[k] >= 0) {
+                    lab[w] = lab[k];
+                } else {
+                    pname[q] = (tpar[w] == k ? 2*eid[w] + 1 : 2*eid[k]);
+                    lab[w] = q++;
+                }
+                stack[top++] = w;
+            }
+        }
+
+        for (i = 0, rcount = 0; i < ncount; i++) {
+            if (lab[tk[i]] == -1) loc[i] = rcount++;
+        }
+        for (i = 0; i < ncount; i++) {
+            if (lab[tk[i]] != -1) loc[i] = rcount + lab[tk[i]];
+        }
+        for (e = 0, ecnt = 0; e < ecount; e++) {
+            if (loc[elist[2*e]] != loc[elist[2*e+1]]) ecnt++;
+        }
+
+        rval = ghtask_alloc (rcount + q, ecnt, vis[r], &t);
+        if (rval) {
+            fprintf (stderr, "ghtask_alloc failed\n"); goto CLEANUP;
+        }
+        t->rcount = rcount;
+        for (i = 0; i < ncount; i++) {
+            if (loc[i] < rcount) t->names[loc[i]] = i;
+        }
+        for (j = 0; j < q; j++) t->names[rcount + j] = pname[j];
+        for (e = 0, ecnt = 0; e < ecount; e++) {
+            a = loc[elist[2*e]];
+            b = loc[elist[2*e+1]];
+            if (a != b) {
+                t->elist[2*ecnt]   = a;
+                t->elist[2*ecnt+1] = b;
+                t->ecap[ecnt++]    = ecap[e];
+            }
+        }
+        for (k = 0, j = 0; k < tcount; k++) {
+            if (lab[k] == -1) t->terms[j++] = loc[tnode[tterm[k]]];
+        }
+        CCutil_sprand (CCutil_lprand (rstate), &t->rstate);
+
+        P.pending++;
+        ghtask_push (&P, 0, t);
+        t = (ghtask *) NULL;
+    }
+
+    ghworker (&P, 0);
+    if (P.rval) {
+        fprintf (stderr, "Gomory-Hu task failed\n");
+        rval = 1; goto CLEANUP;
+    }
+    flows += P.tecount - nkept;
+
+    rval = ghpar_layout (&P, &N, ncount, tcount, tnode);
+    if (rval) {
+        fprintf (stderr, "ghpar_layout failed\n"); goto CLEANUP;
+    }
+    CCcut_GHtreefree (T);
+    *T = N;
+    CCcut_GHtreeinit (&N);
+    if (flowcount) *flowcount = flows;
+
+CLEANUP:
+
+    if (t) ghtask_free (t);
+    CCcut_GHtreefree (&N);
+    CCcut_flowctx_destroy (&F);
+    ghpar_free (&P);
+    CC_IFFREE (tnode, int);
+    CC_IFFREE (tk, int);
+    CC_IFFREE (tpar, int);
+    CC_IFFREE (depth, int);
+    CC_IFFREE (bad, int);
+    CC_IFFREE (uf, int);
+    CC_IFFREE (eid, int);
+    CC_IFFREE (tterm, int);
+    CC_IFFREE (lab, int);
+    CC_IFFREE (vis, int);
+    CC_IFFREE (stack, int);
+    CC_IFFREE (adjbeg, int);
+    CC_IFFREE (adj, int);
+    CC_IFFREE (loc, int);
+    CC_IFFREE (pname, int);
+    CC_IFFREE (dec, int);
+    CC_IFFREE (lam, double);
+    return rval;
+}
+
+/* ghpar_init and ghpar_alloc set up the tasks of a tree on the terminals */
+/* given by markcount and marks (as in CCcut_gomory_hu), with nworkers    */
+/* deques.  tnode (tcount long) gets the graph node of each terminal.     */
+
+static void ghpar_init (ghpar *P)
+{
+    P->nworkers = 0;
+    P->dq       = (ghdeque *) NULL;
+    P->owner    = (int *) NULL;
+    P->tnum     = (int *) NULL;
+    P->tends    = (int *) NULL;
+    P->tval     = (double *) NULL;
+    P->tecount  = 0;
+    P->queued   = 0;
+    P->pending  = 0;
+    P->rval     = 0;
+}
+
+static int ghpar_alloc (ghpar *P, int nworkers, int ncount, int markcount,
+        int *marks, int *tnode, int flowalg)
+{
+    int i, tcount = (markcount ? markcount : ncount);
+    int rval;
+
+    P->owner = CC_SAFE_MALLOC (ncount, int);
+    P->tnum  = CC_SAFE_MALLOC (ncount, int);
+    P->tends = CC_SAFE_MALLOC (2 * tcount, int);
+    P->tval  = CC_SAFE_MALLOC (tcount, double);
+    P->dq    = CC_SAFE_MALLOC (nworkers, ghdeque);
+    if (!P->owner || !P->tnum || !P->tends || !P->tval || !P->dq) {
+        fprintf (stderr, "out of memory in ghpar_alloc\n");
+        return 1;
+    }
+    P->nworkers = nworkers;
+    for (i = 0; i < nworkers; i++) {
+        P->dq[i].head = P->dq[i].tail = (ghtask *) NULL;
+        P->dq[i].side    = CC_SAFE_MALLOC (ncount + tcount, int);
+        P->dq[i].newname = CC_SAFE_MALLOC (ncount + tcount, int);
+        P->dq[i].cut     = CC_SAFE_MALLOC (ncount + tcount, int);
+        P->dq[i].acc     = CC_SAFE_MALLOC (ncount + tcount, double);
+        P->dq[i].flow    = (CCcut_flowctx *) NULL;
+    }
+    for (i = 0; i < nworkers; i++) {
+        if (!P->dq[i].side || !P->dq[i].newname || !P->dq[i].cut ||
+            !P->dq[i].acc) {
+            fprintf (stderr, "out of memory in ghpar_alloc\n");
+            return 1;
+        }
+        rval = CCcut_flowctx_create (&P->dq[i].flow, 0, 0, (int *) NULL,
+                                     (double *) NULL);
+        if (rval) {
+            fprintf (stderr, "CCcut_flowctx_create failed\n"); return rval;
+        }
+        rval = CCcut_flowctx_algorithm (P->dq[i].flow, flowalg);
+        if (rval) {
+            fprintf (stderr, "CCcut_flowctx_algorithm failed\n");
+            return rval;
+        }
+    }
+
+    for (i = 0; i < ncount; i++) P->tnum[i] = (markcount ? -1 : i);
+    for (i = 0; i < markcount; i++) P->tnum[marks[i]] = i;
+    for (i = 0; i < ncount; i++) {
+        if (P->tnum[i] != -1) tnode[P->tnum[i]] = i;
+    }
+    return 0;
+}
+
+static void ghpar_free (ghpar *P)
+{
+    ghtask *t;
+    int i;
+
+    if (P->dq) {
+        for (i = 0; i < P->nworkers; i++) {
+            while (P->dq[i].head) {
+                t = P->dq[i].head;
+                P->dq[i].head = t->next;
+                ghtask_free (t);
+            }
+            CC_IFFREE (P->dq[i].side, int);
+            CC_IFFREE (P->dq[i].newname, int);
+            CC_IFFREE (P->dq[i].cut, int);
+            CC_IFFREE (P->dq[i].acc, double);
+            CCcut_flowctx_destroy (&P->dq[i].flow);
+        }
+        CC_FREE (P->dq, ghdeque);
+    }
+    CC_IFFREE (P->owner, int);
+    CC_IFFREE (P->tnum, int);
+    CC_IFFREE (P->tends, int);
+    CC_IFFREE (P->tval, double);
+}
+
+/* ghpar_layout checks that the tasks made a tree and lays it out in T.  */
+/* The edges were numbered in the order the splits ran; they are sorted  */
+/* by their ends (a two-pass counting sort) so the layout is the same    */
+/* for any schedule.                                                      */
+
+static int ghpar_layout (ghpar *P, CC_GHtree *T, int ncount, int tcount,
+        int *tnode)
+{
+    int *cnt    = (int *) NULL;
+    int *sorted = (int *) NULL;
+    double *sval = (double *) NULL;
+    int i, k, u;
+    int rval = 0;
+
+    if (P->tecount != tcount - 1) {
+        fprintf (stderr, "Gomory-Hu tasks made %d edges for %d nodes\n",
+                 P->tecount, tcount);
+        rval = 1; goto CLEANUP;
+    }
+
+    cnt    = CC_SAFE_MALLOC (tcount + 1, int);
+    sorted = CC_SAFE_MALLOC (2 * tcount, int);
+    sval   = CC_SAFE_MALLOC (tcount, double);
+    if (!cnt || !sorted || !sval) {
+        fprintf (stderr, "out of memory in ghpar_layout\n");
+        rval = 1; goto CLEANUP;
+    }
+
+    for (i = 0; i < P->tecount; i++) {
+        if (P->tends[2*i] > P->tends[2*i+1]) {
+            u = P->tends[2*i];
+            P->tends[2*i] = P->tends[2*i+1];
+            P->tends[2*i+1] = u;
+        }
+    }
+    for (k = 1; k >= 0; k--) {
+        for (u = 0; u <= tcount; u++) cnt[u] = 0;
+        for (i = 0; i < P->tecount; i++) cnt[P->tends[2*i+k]+1]++;
+        for (u = 0; u < tcount; u++) cnt[u+1] += cnt[u];
+        for (i = 0; i < P->tecount; i++) {
+            u = cnt[P->tends[2*i+k]]++;
+            sorted[2*u]   = P->tends[2*i];
+            sorted[2*u+1] = P->tends[2*i+1];
+            sval[u]       = P->tval[i];
+        }
+        for (i = 0; i < 2 * P->tecount; i++) P->tends[i] = sorted[i];
+        for (i = 0; i < P->tecount; i++) P->tval[i] = sval[i];
+    }
+
+    rval = layout_tree (T, ncount, tcount, P->owner, tnode, P->tecount,
+                        P->tends, P->tval);
+    if (rval) {
+        fprintf (stderr, "layout_tree failed\n");
+    }
+
+CLEANUP:
+
+    CC_IFFREE (cnt, int);
+    CC_IFFREE (sorted, int);
+    CC_IFFREE (sval, double);
+    return rval;
+}
+
+#ifdef CC_POSIXTHREADS
+static void *ghworker_thread (void *args)
+{
+    ghworker_args *a = (ghworker_args *) args;
+
+    ghworker (a->P, a->id);
+    return args;
+}
+
+#define GH_LOCK(m)   { if (P->nworkers > 1) pthread_mutex_lock (m); }
+#define GH_UNLOCK(m) { if (P->nworkers > 1) pthread_mutex_unlock (m); }
+#else
+#define GH_LOCK(m)
+#define GH_UNLOCK(m)
+#endif
+
+/* ghworker runs tasks until every task is finished (or one has failed). */
+/* It takes the newest task of its own deque, or else the oldest task of */
+/* the first other deque that has one, and sleeps when all are empty.    */
+
+static void ghworker (ghpar *P, int id)
+{
+    ghtask *t;
+    ghdeque *d;
+    int i, rval;
+
+    for (;;) {
+        t = (ghtask *) NULL;
+        d = &P->dq[id];
+        GH_LOCK (&d->lock);
+        if (d->tail) {
+            t = d->tail;
+            d->tail = t->prev;
+            if (d->tail) d->tail->next = (ghtask *) NULL;
+            else         d->head = (ghtask *) NULL;
+        }
+        GH_UNLOCK (&d->lock);
+        for (i = 1; !t && i < P->nworkers; i++) {
+            d = &P->dq[(id + i) % P->nworkers];
+            GH_LOCK (&d->lock);
+            if (d->head) {
+                t = d->head;
+                d->head = t->next;
+                if (d->head) d->head->prev = (ghtask *) NULL;
+                else         d->tail = (ghtask *) NULL;
+            }
+            GH_UNLOCK (&d->lock);
+        }
+
+        if (!t) {
+#ifdef CC_POSIXTHREADS
+            if (P->nworkers > 1) {
+                pthread_mutex_lock (&P->lock);
+                while (P->queued == 0 && P->pending > 0 && !P->rval) {
+                    pthread_cond_wait (&P->wake, &P->lock);
+                }
+                i = (P->pending == 0 || P->rval);
+                pthread_mutex_unlock (&P->lock);
+                if (i) return;
+                continue;
+            }
+#endif
+            return;
+        }
+
+        GH_LOCK (&P->lock);
+        P->queued--;
+        i = P->rval;
+        GH_UNLOCK (&P->lock);
+        if (i) {
+            ghtask_free (t);
+            return;
+        }
+
+        if (t->tcount == 1) {
+            ghtask_leaf (P, t);
+            rval = 0;
+        } else {
+            rval = ghtask_split (P, id, t);
+            if (rval) fprintf (stderr, "ghtask_split failed\n");
+        }
+        ghtask_free (t);
+
+        GH_LOCK (&P->lock);
+        P->pending--;
+        if (rval) P->rval = rval;
+#ifdef CC_POSIXTHREADS
+        if (P->nworkers > 1 && (P->pending == 0 || P->rval)) {
+            pthread_cond_broadcast (&P->wake);
+        }
+#endif
+        GH_UNLOCK (&P->lock);
+    }
+}
+
+static void ghtask_push (ghpar *P, int id, ghtask *t)
+{
+    ghdeque *d = &P->dq[id];
+
+    GH_LOCK (&d->lock);
+    t->next = (ghtask *) NULL;
+    t->prev = d->tail;
+    if (d->tail) d->tail->next = t;
+    else         d->head = t;
+    d->tail = t;
+    GH_UNLOCK (&d->lock);
+
+    GH_LOCK (&P->lock);
+    P->queued++;
+#ifdef CC_POSIXTHREADS
+    if (P->nworkers > 1) pthread_cond_signal (&P->wake);
+#endif
+    GH_UNLOCK (&P->lock);
+}
+
+/* ghtask_leaf finishes a tree node with a single terminal: its graph    */
+/* nodes and its ends of the tree edges get the number of the terminal.  */
+
+static void ghtask_leaf (ghpar *P, ghtask *t)
+{
+    int i, k = P->tnum[t->names[t->terms[0]]];
+
+    for (i = 0; i < t->rcount; i++) {
+        P->owner[t->names[i]] = k;
+    }
+    for (i = t->rcount; i < t->ncount; i++) {
+        P->tends[t->names[i]] = k;
+    }
+}
+
+/* ghtask_split cuts two terminals of t apart (drawn as in gh_work, from */
+/* t's own seed), makes the tree edge, and queues the two sides, each    */
+/* with the other side shrunk to a new pseudonode.                       */
+
+static int ghtask_split (ghpar *P, int id, ghtask *t)
+{
+    ghdeque *d = &P->dq[id];
+    ghtask *a = (ghtask *) NULL;
+    ghtask *b = (ghtask *) NULL;
+    int i, s, tt, e, cutcount;
+    double cutvalue;
+    int rval = 0;
+
+    s = t->terms[myrandnum (t->tcount, &t->rstate)];
+    i = myrandnum (t->tcount - 1, &t->rstate);
+    tt = t->terms[i];
+    if (tt == s) tt = t->terms[t->tcount - 1];
+
+    for (i = 0; i < t->ncount; i++) d->side[i] = 0;
+    if (t->ecount > 0) {
+        rval = CCcut_flowctx_load (d->flow, t->ncount, t->ecount, t->elist,
+                                   t->ecap);
+        if (rval) {
+            fprintf (stderr, "CCcut_flowctx_load failed\n"); goto CLEANUP;
+        }
+        rval = CCcut_flowctx_solve (d->flow, s, tt, &cutvalue, d->cut,
+                                    &cutcount);
+        if (rval) {
+            fprintf (stderr, "CCcut_flowctx_solve failed\n"); goto CLEANUP;
+        }
+        for (i = 0; i < cutcount; i++) d->side[d->cut[i]] = 1;
+    } else {
+        cutvalue = 0.0;
+        d->side[tt] = 1;
+    }
+
+    GH_LOCK (&P->lock);
+    e = P->tecount++;
+    GH_UNLOCK (&P->lock);
+    P->tval[e] = cutvalue;
+
+    rval = ghtask_shrink (t, d->side, 0, 2*e, d->newname, d->acc, &a);
+    if (rval) {
+        fprintf (stderr, "ghtask_shrink failed\n"); goto CLEANUP;
+    }
+    rval = ghtask_shrink (t, d->side, 1, 2*e + 1, d->newname, d->acc, &b);
+    if (rval) {
+        fprintf (stderr, "ghtask_shrink failed\n"); goto CLEANUP;
+    }
+    CCutil_sprand (CCutil_lprand (&t->rstate), &a->rstate);
+    CCutil_sprand (CCutil_lprand (&t->rstate), &b->rstate);
+
+    GH_LOCK (&P->lock);
+    P->pending += 2;
+    GH_UNLOCK (&P->lock);
+    ghtask_push (P, id, b);
+    ghtask_push (P, id, a);
+    a = b = (ghtask *) NULL;
+
+CLEANUP:
+
+    if (a) ghtask_free (a);
+    if (b) ghtask_free (b);
+    return rval;
+}
+
+/* ghtask_shrink copies the nodes of t with side[i] == keep and shrinks  */
+/* the rest to one new pseudonode (named pend), summing the capacities   */
+/* of the edges to it.                                                   */
+
+static int ghtask_shrink (ghtask *t, int *side, int keep, int pend,
+        int *newname, double *acc, ghtask **pnew)
+{
+    ghtask *n;
+    int i, k, u, v, ncount = 0, rcount = 0, ecount = 0, tcount = 0;
+    int rval = 0;
+
+    for (i = 0; i < t->ncount; i++) {
+        if (side[i] == keep) {
+            newname[i] = ncount++;
+            acc[i] = 0.0;
+            if (i < t->rcount) rcount++;
+        }
+    }
+    for (i = 0; i < t->ecount; i++) {
+        u = t->elist[2*i];
+        v = t->elist[2*i+1];
+        if (side[u] == keep && side[v] == keep) {
+            ecount++;
+        } else if (side[u] == keep) {
+            acc[u] += t->ecap[i];
+        } else if (side[v] == keep) {
+            acc[v] += t->ecap[i];
+        }
+    }
+    for (i = 0; i < t->ncount; i++) {
+        if (side[i] == keep && acc[i] > 0.0) ecount++;
+    }
+    for (i = 0; i < t->tcount; i++) {
+        if (side[t->terms[i]] == keep) tcount++;
+    }
+
+    rval = ghtask_alloc (ncount + 1, ecount, tcount, &n);
+    if (rval) {
+        fprintf (stderr, "ghtask_alloc failed\n"); goto CLEANUP;
+    }
+    n->rcount = rcount;
+
+    for (i = 0; i < t->ncount; i++) {
+        if (side[i] == keep) n->names[newname[i]] = t->names[i];
+    }
+    n->names[ncount] = pend;
+
+    for (i = 0, k = 0; i < t->ecount; i++) {
+        u = t->elist[2*i];
+        v = t->elist[2*i+1];
+        if (side[u] == keep && side[v] == keep) {
+            n->elist[2*k]   = newname[u];
+            n->elist[2*k+1] = newname[v];
+            n->ecap[k++]    = t->ecap[i];
+        }
+    }
+    for (i = 0; i < t->ncount; i++) {
+        if (side[i] == keep && acc[i] > 0.0) {
+            n->elist[2*k]   = newname[i];
+            n->elist[2*k+1] = ncount;
+            n->ecap[k++]    = acc[i];
+        }
+    }
+    for (i = 0, k = 0; i < t->tcount; i++) {
+        if (side[t->terms[i]] == keep) {
+            n->terms[k++] = newname[t->terms[i]];
+        }
+    }
+    *pnew = n;
+
+CLEANUP:
+
+    return rval;
+}
+
+/* ghtask_alloc gets a task and its arrays in one block */
+
+static int ghtask_alloc (int ncount, int ecount, int tcount, ghtask **pnew)
+{
+    ghtask *t;
+    size_t sz;
+
+    sz = sizeof (ghtask) + (size_t) ecount * sizeof (double) +
+         (size_t) (ncount + 2 * ecount + tcount) * sizeof (int);
+    t = (ghtask *) CCutil_allocrus (sz);
+    if (!t) {
+        fprintf (stderr, "out of memory in ghtask_alloc\n");
+        *pnew = (ghtask *) NULL;
+        return 1;
+    }
+    t->ncount = ncount;
+    t->rcount = 0;
+    t->ecount = ecount;
+    t->tcount = tcount;
+    t->ecap   = (double *) (t + 1);
+    t->names  = (int *) (t->ecap + ecount);
+    t->elist  = t->names + ncount;
+    t->terms  = t->elist + 2 * ecount;
+    t->prev   = (ghtask *) NULL;
+    t->next   = (ghtask *) NULL;
+    *pnew = t;
+    return 0;
+}
+
+static void ghtask_free (ghtask *t)
+{
+    CCutil_freerus ((void *) t);
+}
+
+static int gusfield_find (int *uf, int i)
+{
+    while (uf[i] != i) {
+        uf[i] = uf[uf[i]];
+        i = uf[i];
+    }
+    return i;
+}
+
+/* gusfield_tree reduces the tree (p, fl) to the terminals.  The edges   */
+/* are taken from heaviest to lightest, and an edge is contracted if one  */
+/* of its sides has no terminal yet; this merges each such side across    */
+/* its heaviest edge.                                                     */
+
+static int gusfield_tree (CC_GHtree *T, int ncount, int *p, double *fl,
+        int *isterm)
+{
+    int *uf      = (int *) NULL;
+    int *hasterm = (int *) NULL;
+    int *perm    = (int *) NULL;
+    int *grp     = (int *) NULL;
+    int *tnode   = (int *) NULL;
+    int *tends   = (int *) NULL;
+    double *tval = (double *) NULL;
+    int i, k, a, b, tcount = 0, tecount = 0;
+    int rval = 0;
+
+    uf      = CC_SAFE_MALLOC (ncount, int);
+    hasterm = CC_SAFE_MALLOC (ncount, int);
+    perm    = CC_SAFE_MALLOC (ncount, int);
+    grp     = CC_SAFE_MALLOC (ncount, int);
+    tnode   = CC_SAFE_MALLOC (ncount, int);
+    tends   = CC_SAFE_MALLOC (2 * ncount, int);
+    tval    = CC_SAFE_MALLOC (ncount, double);
+    if (!uf || !hasterm || !perm || !grp || !tnode || !tends || !tval) {
+        fprintf (stderr, "out of memory in gusfield_tree\n");
+        rval = 1; goto CLEANUP;
+    }
+
+    for (i = 0; i < ncount; i++) {
+        uf[i] = i;
+        hasterm[i] = isterm[i];
+        if (isterm[i]) tcount++;
+    }
+    if (tcount == 0) {
+        fprintf (stderr, "no terminals in gusfield_tree\n");
+        rval = 1; goto CLEANUP;
+    }
+
+    if (tcount < ncount) {
+        for (i = 1; i < ncount; i++) perm[i-1] = i;
+        CCutil_double_perm_quicksort (perm, fl, ncount - 1);
+        for (k = ncount - 2; k >= 0; k--) {
+            a = gusfield_find (uf, perm[k]);
+            b = gusfield_find (uf, p[perm[k]]);
+            if (!hasterm[a] || !hasterm[b]) {
+                uf[a] = b;
+                hasterm[b] |= hasterm[a];
+            }
+        }
+    }
+
+    /* number the tree nodes by their terminals, in node order */
+
+    for (i = 0, k = 0; i < ncount; i++) {
+        if (isterm[i]) {
+            tnode[k] = i;
+            grp[gusfield_find (uf, i)] = k++;
+        }
+    }
+    for (i = 0; i < ncount; i++) {
+        grp[i] = grp[gusfield_find (uf, i)];
+    }
+
+    for (i = 1; i < ncount; i++) {
+        if (grp[i] != grp[p[i]]) {
+            tends[2*tecount]   = grp[i];
+            tends[2*tecount+1] = grp[p[i]];
+            tval[tecount++]    = fl[i];
+        }
+    }
+
+    rval = layout_tree (T, ncount, tcount, grp, tnode, tecount, tends, tval);
+    if (rval) {
+        fprintf (stderr, "layout_tree failed\n"); goto CLEANUP;
+    }
+
+CLEANUP:
+
+    CC_IFFREE (uf, int);
+    CC_IFFREE (hasterm, int);
+    CC_IFFREE (perm, int);
+    CC_IFFREE (grp, int);
+    CC_IFFREE (tnode, int);
+    CC_IFFREE (tends, int);
+    CC_IFFREE (tval, double);
+    return rval;
+}
+
+/* layout_tree lays out a tree on tcount nodes as copy_cuttree does, in   */
+/* DFS order from tree node 0.  grp gives the tree node of each graph     */
+/* node, tnode the special node of each tree node, and tends/tval the     */
+/* tecount = tcount - 1 tree edges.  The children of a node are taken in  */
+/* the order of its edges in tends.                                       */
+
+static int layout_tree (CC_GHtree *T, int ncount, int tcount, int *grp,
+        int *tnode, int tecount, int *tends, double *tval)
+{
+    int *adjbeg = (int *) NULL;
+    int *adj    = (int *) NULL;
+    int *order  = (int *) NULL;
+    int *tpar   = (int *) NULL;
+    int *dnum   = (int *) NULL;
+    int *lpos   = (int *) NULL;
+    double *pval = (double *) NULL;
+    int i, j, k, u, w, top;
+    int rval = 0;
+
+    adjbeg = CC_SAFE_MALLOC (tcount + 1, int);
+    adj    = CC_SAFE_MALLOC (2 * tecount + 1, int);
+    order  = CC_SAFE_MALLOC (tcount, int);
+    tpar   = CC_SAFE_MALLOC (tcount, int);
+    dnum   = CC_SAFE_MALLOC (tcount, int);
+    lpos   = CC_SAFE_MALLOC (tcount, int);
+    pval   = CC_SAFE_MALLOC (tcount, double);
+    if (!adjbeg || !adj || !order || !tpar || !dnum || !lpos || !pval) {
+        fprintf (stderr, "out of memory in layout_tree\n");
+        rval = 1; goto CLEANUP;
+    }
+
+    for (u = 0; u <= tcount; u++) adjbeg[u] = 0;
+    for (i = 0; i < tecount; i++) {
+        adjbeg[tends[2*i]+1]++;
+        adjbeg[tends[2*i+1]+1]++;
+    }
+    for (u = 0; u < tcount; u++) adjbeg[u+1] += adjbeg[u];
+    for (u = 0; u < tcount; u++) lpos[u] = adjbeg[u];
+    for (i = 0; i < tecount; i++) {
+        adj[lpos[tends[2*i]]++] = i;
+        adj[lpos[tends[2*i+1]]++] = i;
+    }
+
+    /* preorder from tree node 0 (order is used as the stack) */
+
+    top = 0;
+    order[top++] = 0;
+    tpar[0] = -1;
+    pval[0] = GH_MAXDOUBLE;
+    for (k = 0; top > 0; k++) {
+        u = order[--top];
+        dnum[u] = k;
+        lpos[k] = u;
+        for (j = adjbeg[u+1] - 1; j >= adjbeg[u]; j--) {
+            i = adj[j];
+            w = (tends[2*i] == u ? tends[2*i+1] : tends[2*i]);
+            if (w != tpar[u]) {
+                tpar[w] = u;
+                pval[w] = tval[i];
+                order[top++] = w;
+            }
+        }
+    }
+    if (k != tcount) {
+        fprintf (stderr, "cut tree is not connected\n");
+        rval = 1; goto CLEANUP;
+    }
+    for (k = 0; k < tcount; k++) order[k] = lpos[k];
+
+    rval = tree_alloc (T, tcount, ncount);
+    if (rval) {
+        fprintf (stderr, "tree_alloc failed\n"); goto CLEANUP;
+    }
+
+    for (k = 0; k < tcount; k++) {
+        u = order[k];
+        T->parent[k]  = (tpar[u] == -1 ? -1 : dnum[tpar[u]]);
+        T->cutval[k]  = pval[u];
+        T->special[k] = tnode[u];
+        T->ndescendants[k] = 1;
+        T->nodebeg[k] = 0;
+    }
+    for (k = tcount - 1; k > 0; k--) {
+        T->ndescendants[T->parent[k]] += T->ndescendants[k];
+    }
+
+    T->nodebeg[tcount] = 0;
+    for (i = 0; i < ncount; i++) {
+        T->nodebeg[dnum[grp[i]] + 1]++;
+    }
+    for (k = 0; k < tcount; k++) {
+        T->nodebeg[k+1] += T->nodebeg[k];
+        lpos[k] = T->nodebeg[k];
+    }
+    for (i = 0; i < ncount; i++) {
+        T->nodes[lpos[dnum[grp[i]]]++] = i;
+    }
+
+CLEANUP:
+
+    if (rval) {
+        CCcut_GHtreefree (T);
+        CCcut_GHtreeinit (T);
+    }
+    CC_IFFREE (adjbeg, int);
+    CC_IFFREE (adj, int);
+    CC_IFFREE (order, int);
+    CC_IFFREE (tpar, int);
+    CC_IFFREE (dnum, int);
+    CC_IFFREE (lpos, int);
+    CC_IFFREE (pval, double);
+    return rval;
+}
+
 static void ghlink_free_world (graph *G)
 {
     int total, onlist;
@@ -350,31 +1767,172 @@ static void delfromedgeset (edgeset *s, edge *e, CCptrworld *edgeptr_world)
 void CCcut_GHtreeinit (CC_GHtree *T)
 {
     if (T) {
-        T->root   = (CC_GHnode *) NULL;
-        T->supply = (CC_GHnode *) NULL;
-        T->listspace = (int *) NULL;
+        T->tcount       = 0;
+        T->ncount       = 0;
+        T->parent       = (int *) NULL;
+        T->ndescendants = (int *) NULL;
+        T->special      = (int *) NULL;
+        T->nodebeg      = (int *) NULL;
+        T->nodes        = (int *) NULL;
+        T->cutval       = (double *) NULL;
+    }
+}
+
+void CCcut_GHtreeunscale (CC_GHtree *T, double scale)
+{
+    int k;
+
+    if (T) {
+        for (k = 1; k < T->tcount; k++) {
+            T->cutval[k] /= scale;
+        }
     }
 }
 
 void CCcut_GHtreefree (CC_GHtree *T)
 {
     if (T) {
-        treefree_work (T->root);
-        CC_IFFREE (T->supply, CC_GHnode);
-        CC_IFFREE (T->listspace, int);
+        CC_IFFREE (T->parent, int);
+        CC_IFFREE (T->ndescendants, int);
+        CC_IFFREE (T->special, int);
+        CC_IFFREE (T->nodebeg, int);
+        CC_IFFREE (T->nodes, int);
+        CC_IFFREE (T->cutval, double);
+        T->tcount = 0;
+        T->ncount = 0;
     }
 }
 
-static void treefree_work (CC_GHnode *n)
+/* tree_alloc gives T (which holds nothing) the arrays of a tree on      */
+/* tcount nodes over ncount graph nodes.                                 */
+
+static int tree_alloc (CC_GHtree *T, int tcount, int ncount)
 {
-    CC_GHnode *p, *pnext;
+    T->parent       = CC_SAFE_MALLOC (tcount, int);
+    T->ndescendants = CC_SAFE_MALLOC (tcount, int);
+    T->special      = CC_SAFE_MALLOC (tcount, int);
+    T->nodebeg      = CC_SAFE_MALLOC (tcount + 1, int);
+    T->nodes        = CC_SAFE_MALLOC (ncount + 1, int);
+    T->cutval       = CC_SAFE_MALLOC (tcount, double);
+    if (!T->parent || !T->ndescendants || !T->special || !T->nodebeg ||
+        !T->nodes || !T->cutval) {
+        fprintf (stderr, "out of memory in tree_alloc\n");
+        CCcut_GHtreefree (T);
+        return 1;
+    }
+    T->tcount = tcount;
+    T->ncount = ncount;
+    return 0;
+}
 
-    if (n) {
-        for (p = n->child; p; p = pnext) {
-            pnext = p->sibling;
-            treefree_work (p);
+int CCcut_GHtreewrite (CC_SFILE *f, CC_GHtree *T)
+{
+    int k, i, tbits, nbits;
+    int rval = 0;
+
+    rval = CCutil_swrite_char (f, GH_TREE_VERSION);
+    CCcheck_rval (rval, "CCutil_swrite_char failed");
+    rval = CCutil_swrite_int (f, T->tcount);
+    CCcheck_rval (rval, "CCutil_swrite_int failed");
+    rval = CCutil_swrite_int (f, T->ncount);
+    CCcheck_rval (rval, "CCutil_swrite_int failed");
+
+    tbits = CCutil_sbits (T->tcount);
+    nbits = CCutil_sbits (T->ncount);
+    for (k = 0; k < T->tcount; k++) {
+        rval = CCutil_swrite_bits (f, T->parent[k] + 1, tbits);
+        CCcheck_rval (rval, "CCutil_swrite_bits failed");
+        rval = CCutil_swrite_bits (f, T->special[k], nbits);
+        CCcheck_rval (rval, "CCutil_swrite_bits failed");
+        rval = CCutil_swrite_bits (f, T->nodebeg[k+1] - T->nodebeg[k], nbits);
+        CCcheck_rval (rval, "CCutil_swrite_bits failed");
+        for (i = T->nodebeg[k]; i < T->nodebeg[k+1]; i++) {
+            rval = CCutil_swrite_bits (f, T->nodes[i], nbits);
+            CCcheck_rval (rval, "CCutil_swrite_bits failed");
+        }
+    }
+    for (k = 1; k < T->tcount; k++) {
+        rval = CCutil_swrite_double (f, T->cutval[k]);
+        CCcheck_rval (rval, "CCutil_swrite_double failed");
+    }
+
+CLEANUP:
+
+    return rval;
+}
+
+int CCcut_GHtreeread (CC_SFILE *f, CC_GHtree *T)
+{
+    int k, i, cnt, tcount, ncount, tbits, nbits;
+    char version;
+    int rval = 0;
+
+    rval = CCutil_sread_char (f, &version);
+    CCcheck_rval (rval, "CCutil_sread_char failed");
+    if (version != GH_TREE_VERSION) {
+        fprintf (stderr, "Unknown cut tree version %d\n", (int) version);
+        rval = 1; goto CLEANUP;
+    }
+    rval = CCutil_sread_int (f, &tcount);
+    CCcheck_rval (rval, "CCutil_sread_int failed");
+    rval = CCutil_sread_int (f, &ncount);
+    CCcheck_rval (rval, "CCutil_sread_int failed");
+    if (tcount < 0 || ncount < tcount) {
+        fprintf (stderr, "bad cut tree size %d %d\n", tcount, ncount);
+        rval = 1; goto CLEANUP;
+    }
+    if (tcount == 0) goto CLEANUP;
+
+    rval = tree_alloc (T, tcount, ncount);
+    CCcheck_rval (rval, "tree_alloc failed");
+
+    tbits = CCutil_sbits (tcount);
+    nbits = CCutil_sbits (ncount);
+    T->nodebeg[0] = 0;
+    for (k = 0; k < tcount; k++) {
+        rval = CCutil_sread_bits (f, &T->parent[k], tbits);
+        CCcheck_rval (rval, "CCutil_sread_bits failed");
+        T->parent[k]--;
+        rval = CCutil_sread_bits (f, &T->special[k], nbits);
+        CCcheck_rval (rval, "CCutil_sread_bits failed");
+        rval = CCutil_sread_bits (f, &cnt, nbits);
+        CCcheck_rval (rval, "CCutil_sread_bits failed");
+        if ((k == 0) != (T->parent[k] == -1) || T->parent[k] >= k ||
+             T->special[k] >= ncount || cnt > ncount - T->nodebeg[k]) {
+            fprintf (stderr, "bad cut tree node %d\n", k);
+            rval = 1; goto CLEANUP;
+        }
+        T->nodebeg[k+1] = T->nodebeg[k] + cnt;
+        for (i = T->nodebeg[k]; i < T->nodebeg[k+1]; i++) {
+            rval = CCutil_sread_bits (f, &T->nodes[i], nbits);
+            CCcheck_rval (rval, "CCutil_sread_bits failed");
+            if (T->nodes[i] >= ncount) {
+                fprintf (stderr, "bad cut tree node %d\n", k);
+                rval = 1; goto CLEANUP;
+            }
         }
+        T->ndescendants[k] = 1;
+    }
+    if (T->nodebeg[tcount] != ncount) {
+        fprintf (stderr, "cut tree does not cover the graph\n");
+        rval = 1; goto CLEANUP;
+    }
+    T->cutval[0] = GH_MAXDOUBLE;
+    for (k = 1; k < tcount; k++) {
+        rval = CCutil_sread_double (f, &T->cutval[k]);
+        CCcheck_rval (rval, "CCutil_sread_double failed");
     }
+    for (k = tcount - 1; k > 0; k--) {
+        T->ndescendants[T->parent[k]] += T->ndescendants[k];
+    }
+
+CLEANUP:
+
+    if (rval) {
+        CCcut_GHtreefree (T);
+        CCcut_GHtreeinit (T);
+    }
+    return rval;
 }
 
 static void cuttree_free_work (cuttree_node *n, CCptrworld *nodeptr_world)
@@ -473,7 +2031,8 @@ static int gh_work (graph *G, cuttree_node *n, nodeset *nlist,
 
     elist = CC_SAFE_MALLOC (2*ecount, int);
     ecap  = CC_SAFE_MALLOC (ecount, double);
-    if (!elist || !ecap) {
+    cut   = CC_SAFE_MALLOC (ncount, int);
+    if (!elist || !ecap || !cut) {
         fprintf (stderr, "out of memory in gh_work\n");
         rval = 1; goto CLEANUP;
     }
@@ -504,10 +2063,14 @@ static int gh_work (graph *G, cuttree_node *n, nodeset *nlist,
         }
     }
 
-    rval = CCcut_mincut_st (ncount, ecount, elist, ecap, anode->num,
-                            bnode->num, &cutvalue, &cut, &cutcount);
+    rval = CCcut_flowctx_load (G->flow, ncount, ecount, elist, ecap);
+    if (rval) {
+        fprintf (stderr, "CCcut_flowctx_load failed\n"); goto CLEANUP;
+    }
+    rval = CCcut_flowctx_solve (G->flow, anode->num, bnode->num, &cutvalue,
+                                cut, &cutcount);
     if (rval) {
-        fprintf (stderr, "CCcut_mincut_st failed\n"); goto CLEANUP;
+        fprintf (stderr, "CCcut_flowctx_solve failed\n"); goto CLEANUP;
     }
     CC_IFFREE (elist, int);
     CC_IFFREE (ecap, double);
@@ -790,29 +2353,23 @@ static int copy_cuttree (cuttree_node *root, int ncount, int markcount,
         CC_GHtree *T)
 {
     int rval = 0;
-    int k;
-    int *listspace;
+    int k, pos;
 
-    T->supply =    CC_SAFE_MALLOC (markcount + 1, CC_GHnode);
-    T->listspace = CC_SAFE_MALLOC (ncount + 1, int);
-    if (!T->supply || !T->listspace) {
-        fprintf (stderr, "out of memory in copy_cuttree\n");
-        rval = 1; goto CLEANUP;
-    }
     k = 0;
     cut_dfs (root, &k);
-    k = 0;
-    listspace = T->listspace;
-    copy_dfs (root, &k, T->supply, &listspace);
-    T->root = &T->supply[0];
-
-CLEANUP:
-
+    if (k != markcount) {
+        fprintf (stderr, "cut tree has %d nodes, not %d\n", k, markcount);
+        return 1;
+    }
+    rval = tree_alloc (T, markcount, ncount);
     if (rval) {
-        CC_IFFREE (T->supply, CC_GHnode);
-        CC_IFFREE (T->listspace, int);
+        fprintf (stderr, "tree_alloc failed\n"); return rval;
     }
-    return rval;
+    k = 0;
+    pos = 0;
+    copy_dfs (root, &k, T, &pos);
+    T->nodebeg[k] = pos;
+    return 0;
 }
 
 static void cut_dfs (cuttree_node *n, int *k)
@@ -823,37 +2380,22 @@ static void cut_dfs (cuttree_node *n, int *k)
     }
 }
 
-static void copy_dfs (cuttree_node *n, int *k, CC_GHnode *supply,
-        int **listspace)
+static void copy_dfs (cuttree_node *n, int *k, CC_GHtree *T, int *pos)
 {
-    CC_GHnode *c = &supply[*k];
     nodeptr *p;
-    int count = 0;
-
-    if (n->parent)  c->parent  = &supply[n->parent->num];
-    else            c->parent  = (CC_GHnode *) NULL;
-    if (n->sibling) c->sibling = &supply[n->sibling->num];
-    else            c->sibling = (CC_GHnode *) NULL;
-    if (n->child)   c->child   = &supply[n->child->num];
-    else            c->child   = (CC_GHnode *) NULL;
-    c->cutval  = n->cutval;
-    c->ndescendants = n->ndescendants;
-    c->special = n->special->number;
-    c->num = *k;
-
-    c->listcount = 0;
-    for (p = n->nlist.head; p; p = p->next) {
-        c->listcount++;
-    }
-    c->nlist = *listspace;
+
+    T->parent[*k]  = (n->parent ? n->parent->num : -1);
+    T->cutval[*k]  = n->cutval;
+    T->ndescendants[*k] = n->ndescendants;
+    T->special[*k] = n->special->number;
+    T->nodebeg[*k] = *pos;
     for (p = n->nlist.head; p; p = p->next) {
-        c->nlist[count++] = p->this->number;
+        T->nodes[(*pos)++] = p->this->number;
     }
-    *listspace = (*listspace) + c->listcount;
 
     (*k)++;
     for (n = n->child; n; n = n->sibling) {
-        copy_dfs (n, k, supply, listspace);
+        copy_dfs (n, k, T, pos);
     }
 }
 
@@ -961,6 +2503,7 @@ static void initgraph (graph *G)
         G->ncount   = 0;
         G->ecount   = 0;
         G->magicnum = 0;
+        G->flow     = (CCcut_flowctx *) NULL;
         CCptrworld_init (&G->edge_world);
         CCptrworld_init (&G->edgeptr_world);
         CCptrworld_init (&G->nodeptr_world);
@@ -982,42 +2525,30 @@ static void freegraph (graph *G)
             CC_FREE (G->nodelist, node);
         }
         CC_IFFREE (G->edgelist, edge);
+        CCcut_flowctx_destroy (&G->flow);
     }
 }
 
 void CCcut_GHtreeprint (CC_GHtree *T)
 {
+    int k, i;
+
     if (T) {
         printf ("GOMORY-HU TREE\n"); fflush (stdout);
-        print_tree_work (T->root);
-    }
-}
-
-static void print_tree_work (CC_GHnode *n)
-{
-    int i;
-
-    printf ("T%d: ", n->num);
-    printf ("Set (");
-    for (i = 0; i < n->listcount; i++) {
-        printf ("%d,", n->nlist[i]);
-    }
-    printf ("[%d]), ", n->special);
-    if (n->parent) printf ("Parent %d, ", n->parent->num);
-    else           printf ("Parent NULL, ");
-    if (n->child)  printf ("Child %d, ", n->child->num);
-    else           printf ("Child NULL, ");
-    if (n->sibling) printf ("Sibling %d, ", n->sibling->num);
-    else            printf ("Sibling NULL, ");
-    if (n->parent) {
-        printf ("Cnt %d, Val %.2f\n", n->ndescendants, n->cutval);
-        fflush (stdout);
-    } else {
-        printf ("Cnt %d, ROOT\n", n->ndescendants); 
-        fflush (stdout);
-    }
-
-    for (n = n->child; n; n = n->sibling) {
-        print_tree_work (n);
+        for (k = 0; k < T->tcount; k++) {
+            printf ("T%d: ", k);
+            printf ("Set (");
+            for (i = T->nodebeg[k]; i < T->nodebeg[k+1]; i++) {
+                printf ("%d,", T->nodes[i]);
+            }
+            printf ("[%d]), ", T->special[k]);
+            if (T->parent[k] != -1) {
+                printf ("Parent %d, Cnt %d, Val %.2f\n", T->parent[k],
+                        T->ndescendants[k], T->cutval[k]);
+            } else {
+                printf ("Parent NULL, Cnt %d, ROOT\n", T->ndescendants[k]);
+            }
+            fflush (stdout);
+        }
     }
 }
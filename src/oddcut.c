@@ -0,0 +1,468 @@
+/****************************************************************************/
+/*                                                                          */
+/*  This file is part of CONCORDE                                           */
+/*                                                                          */
+/*  (c) Copyright 1995--1999 by David Applegate, Robert Bixby,              */
+/*  Vasek Chvatal, and William Cook                                         */
+/*                                                                          */
+/*  Permission is granted for academic research use.  For other uses,       */
+/*  contact the authors for licensing options.                              */
+/*                                                                          */
+/*  Use at your own risk.  We make no guarantees about the                  */
+/*  correctness or usefulness of this code.                                 */
+/*                                                                          */
+/****************************************************************************/
+
+/****************************************************************************/
+/*                                                                          */
+/*                       MINIMUM T-ODD CUTS                                 */
+/*                                                                          */
+/*                            TSP CODE                                      */
+/*                                                                          */
+/*                                                                          */
+/*    EXPORTED FUNCTIONS:                                                   */
+/*                                                                          */
+/*  int CCcut_odd_cuts (int ncount, int ecount, int *elist, double *ecap,   */
+/*      int tcount, int *tlist, double cutoff, int flowalg,                 */
+/*      int (*doit_fn) (double, int, int *, void *), void *pass_param,      */
+/*      int *flowcount)                                                     */
+/*    FINDS T-odd cuts of capacity less than cutoff, among them a minimum   */
+/*     T-odd cut if its capacity is less than cutoff.                       */
+/*     -ncount, ecount, elist, ecap specify the (undirected) graph          */
+/*     -tlist lists the tcount nodes of T; tcount must be even (if it is  */
+/*      odd, every cut is T-odd, and CCcut_odd_cuts returns an error;     */
+/*      a Gomory-Hu tree gives the minimum cut)                           */
+/*     -cutoff is the bound on the capacity of the cuts                     */
+/*     -flowalg is the max-flow code (see CCcut_mincut_st)                  */
+/*     -doit_fn is called with the capacity of each cut found, and the      */
+/*      number and the list of the nodes on one side of it: the side with   */
+/*      an odd number of nodes of T (the smaller side if both are odd).     */
+/*      If it returns nonzero, so does CCcut_odd_cuts.                      */
+/*     -pass_param is passed to doit_fn                                     */
+/*     -flowcount returns the number of max-flows (it can be NULL)          */
+/*    NOTES:                                                                */
+/*      A cut is T-odd if one of its sides holds an odd number of the       */
+/*      nodes of T.  The method is the one of Padberg and Rao, with the     */
+/*      pruning of Rizzi ("Minimum T-cuts and optimal T-pairings",          */
+/*      Discrete Mathematics 271 (2003) 177-200).  A minimum cut between    */
+/*      two nodes s and t of T is computed.  If it is T-odd and below the   */
+/*      cutoff, it is reported; if it is at the cutoff or above, no cut     */
+/*      that is wanted separates s and t.  In both cases s and t are        */
+/*      shrunk into a single node, which is no longer in T, so each of      */
+/*      these flows takes two nodes from T.  A T-even cut below the         */
+/*      cutoff does not cross some minimum T-odd cut, so the graph is       */
+/*      split into two, with one side shrunk in each.  At most tcount - 1   */
+/*      flows are run, and about tcount / 2 when few cuts are T-even.       */
+/*      Cuts at the cutoff or above are never reported, and a T-odd cut     */
+/*      that separates s and t is not reported unless it is the one found   */
+/*      by the flow, so the list is not the list of all the T-odd cuts      */
+/*      below the cutoff that a Gomory-Hu tree would give.                  */
+/*                                                                          */
+/****************************************************************************/
+
+#include "machdefs.h"
+#include "util.h"
+#include "cut.h"
+
+/* A subproblem is the graph with some sets of nodes shrunk.  Node v of   */
+/* the shrunken graph stands for the original nodes mlist[mbeg[v]] to     */
+/* mlist[mbeg[v+1]-1] (the nodes of a subproblem cover the whole graph),  */
+/* and par[v] is the number of nodes of T among them, mod 2.  Parallel    */
+/* edges are merged when a graph is shrunk.                               */
+
+typedef struct oddtask {
+    int             ncount;
+    int             ecount;
+    int            *elist;
+    double         *ecap;
+    int            *par;
+    int            *mbeg;
+    int            *mlist;
+    struct oddtask *next;
+} oddtask;
+
+/* The scratch space of a call: grp maps the nodes of a subproblem to    */
+/* those of the next one; side, where, ebeg and eperm are work arrays     */
+/* for shrink_task; cut receives the side of t and list the original      */
+/* nodes of a reported cut.  All of them have room for ncount entries,   */
+/* except ebeg (ncount + 1) and eperm (ecount).                           */
+
+typedef struct oddwork {
+    int            *grp;
+    int            *side;
+    int            *where;
+    int            *ebeg;
+    int            *eperm;
+    int            *cut;
+    int            *list;
+} oddwork;
+
+
+static void
+    init_oddwork (oddwork *W),
+    free_oddwork (oddwork *W),
+    free_task (oddtask *K);
+static int
+    alloc_oddwork (oddwork *W, int ncount, int ecount),
+    first_task (oddtask **K, int ncount, int ecount, int *elist,
+        double *ecap, int tcount, int *tlist),
+    shrink_task (oddtask *K, oddwork *W, int ngrp, oddtask **N),
+    report_cut (oddtask *K, oddwork *W, int cutside, double val,
+        int (*doit_fn) (double, int, int *, void *), void *pass_param);
+
+
+int CCcut_odd_cuts (int ncount, int ecount, int *elist, double *ecap,
+        int tcount, int *tlist, double cutoff, int flowalg,
+        int (*doit_fn) (double, int, int *, void *), void *pass_param,
+        int *flowcount)
+{
+    oddtask *stack = (oddtask *) NULL;
+    oddtask *K = (oddtask *) NULL;
+    oddtask *N = (oddtask *) NULL;
+    CCcut_flowctx *F = (CCcut_flowctx *) NULL;
+    oddwork W;
+    double val;
+    int i, v, s, t, k, cutcount, tpar, spar, ngrp;
+    int rval = 0;
+
+    init_oddwork (&W);
+    if (flowcount) *flowcount = 0;
+    if (tcount % 2 == 1) {
+        fprintf (stderr, "CCcut_odd_cuts called with odd tcount %d\n",
+                 tcount);
+        rval = 1; goto CLEANUP;
+    }
+    if (ncount < 2 || tcount < 2) goto CLEANUP;
+
+    rval = alloc_oddwork (&W, ncount, ecount);
+    if (rval) {
+        fprintf (stderr, "alloc_oddwork failed\n"); goto CLEANUP;
+    }
+    rval = CCcut_flowctx_create (&F, 0, 0, (int *) NULL, (double *) NULL);
+    if (rval) {
+        fprintf (stderr, "CCcut_flowctx_create failed\n"); goto CLEANUP;
+    }
+    rval = CCcut_flowctx_algorithm (F, flowalg);
+    if (rval) {
+        fprintf (stderr, "CCcut_flowctx_algorithm failed\n"); goto CLEANUP;
+    }
+    rval = first_task (&stack, ncount, ecount, elist, ecap, tcount, tlist);
+    if (rval) {
+        fprintf (stderr, "first_task failed\n"); goto CLEANUP;
+    }
+
+    while (stack) {
+        K = stack;
+        stack = stack->next;
+
+        for (;;) {
+            for (s = -1, t = -1, v = 0; v < K->ncount && t == -1; v++) {
+                if (K->par[v]) {
+                    if (s == -1) s = v;
+                    else         t = v;
+                }
+            }
+            if (t == -1) break;
+
+            rval = CCcut_flowctx_load (F, K->ncount, K->ecount, K->elist,
+                                       K->ecap);
+            if (rval) {
+                fprintf (stderr, "CCcut_flowctx_load failed\n"); goto CLEANUP;
+            }
+            rval = CCcut_flowctx_solve (F, s, t, &val, W.cut, &cutcount);
+            if (rval) {
+                fprintf (stderr, "CCcut_flowctx_solve failed\n"); goto CLEANUP;
+            }
+            if (flowcount) (*flowcount)++;
+
+            for (v = 0; v < K->ncount; v++) W.side[v] = 0;
+            for (i = 0, tpar = 0; i < cutcount; i++) {
+                W.side[W.cut[i]] = 1;
+                tpar ^= K->par[W.cut[i]];
+            }
+            for (v = 0, spar = 0; v < K->ncount; v++) {
+                if (!W.side[v]) spar ^= K->par[v];
+            }
+
+            if (val < cutoff && !tpar && !spar) {
+                /* T-even: go on with the s side, the t side shrunk, and */
+                /* keep the t side, the s side shrunk, for later         */
+                for (k = 0, v = 0; v < K->ncount; v++) {
+                    W.grp[v] = (W.side[v] ? -1 : k++);
+                }
+                for (v = 0; v < K->ncount; v++) {
+                    if (W.grp[v] == -1) W.grp[v] = k;
+                }
+                rval = shrink_task (K, &W, k + 1, &N);
+                if (rval) {
+                    fprintf (stderr, "shrink_task failed\n"); goto CLEANUP;
+                }
+                N->next = stack;
+                stack = N;
+                for (k = 0, v = 0; v < K->ncount; v++) {
+                    W.grp[v] = (W.side[v] ? k++ : -1);
+                }
+                for (v = 0; v < K->ncount; v++) {
+                    if (W.grp[v] == -1) W.grp[v] = k;
+                }
+                ngrp = k + 1;
+            } else {
+                if (val < cutoff) {
+                    rval = report_cut (K, &W, (tpar ? 1 : 0), val, doit_fn,
+                                       pass_param);
+                    if (rval) goto CLEANUP;
+                }
+                /* shrink s and t */
+                for (k = 0, v = 0; v < K->ncount; v++) {
+                    W.grp[v] = (v == t ? W.grp[s] : k++);
+                }
+                ngrp = k;
+            }
+
+            rval = shrink_task (K, &W, ngrp, &N);
+            if (rval) {
+                fprintf (stderr, "shrink_task failed\n"); goto CLEANUP;
+            }
+            free_task (K);
+            K = N;
+            N = (oddtask *) NULL;
+        }
+        free_task (K);
+        K = (oddtask *) NULL;
+    }
+
+CLEANUP:
+
+    free_task (K);
+    while (stack) {
+        K = stack;
+        stack = stack->next;
+        free_task (K);
+    }
+    CCcut_flowctx_destroy (&F);
+    free_oddwork (&W);
+    return rval;
+}
+
+/* report_cut passes the cut of K with the nodes marked in W->side on     */
+/* one side to doit_fn.  If cutside is 1 the marked side is the odd one,  */
+/* if it is 0 the other side is; if both are odd, the smaller is passed.  */
+
+static int report_cut (oddtask *K, oddwork *W, int cutside, double val,
+        int (*doit_fn) (double, int, int *, void *), void *pass_param)
+{
+    int i, v, count = 0, total = K->mbeg[K->ncount];
+    int rval;
+
+    for (v = 0; v < K->ncount; v++) {
+        if (W->side[v] == cutside) count += K->mbeg[v+1] - K->mbeg[v];
+    }
+    if (2 * count > total) {
+        for (v = 0, i = 0; v < K->ncount; v++) i ^= K->par[v];
+        if (i == 0) {
+            cutside = 1 - cutside;   /* both sides are odd */
+        }
+    }
+
+    for (v = 0, count = 0; v < K->ncount; v++) {
+        if (W->side[v] == cutside) {
+            for (i = K->mbeg[v]; i < K->mbeg[v+1]; i++) {
+                W->list[count++] = K->mlist[i];
+            }
+        }
+    }
+
+    rval = doit_fn (val, count, W->list, pass_param);
+    if (rval) {
+        fprintf (stderr, "doit_fn failed\n");
+    }
+    return rval;
+}
+
+/* first_task builds the subproblem of the whole graph.                   */
+
+static int first_task (oddtask **K, int ncount, int ecount, int *elist,
+        double *ecap, int tcount, int *tlist)
+{
+    oddtask *N;
+    int i;
+
+    *K = (oddtask *) NULL;
+    N = CC_SAFE_MALLOC (1, oddtask);
+    if (!N) {
+        fprintf (stderr, "out of memory in first_task\n");
+        return 1;
+    }
+    N->ncount = ncount;
+    N->ecount = ecount;
+    N->elist  = CC_SAFE_MALLOC (2 * ecount + 1, int);
+    N->ecap   = CC_SAFE_MALLOC (ecount + 1, double);
+    N->par    = CC_SAFE_MALLOC (ncount, int);
+    N->mbeg   = CC_SAFE_MALLOC (ncount + 1, int);
+    N->mlist  = CC_SAFE_MALLOC (ncount, int);
+    N->next   = (oddtask *) NULL;
+    if (!N->elist || !N->ecap || !N->par || !N->mbeg || !N->mlist) {
+        fprintf (stderr, "out of memory in first_task\n");
+        free_task (N);
+        return 1;
+    }
+
+    for (i = 0; i < 2 * ecount; i++) N->elist[i] = elist[i];
+    for (i = 0; i < ecount; i++) N->ecap[i] = ecap[i];
+    for (i = 0; i < ncount; i++) {
+        N->par[i]   = 0;
+        N->mbeg[i]  = i;
+        N->mlist[i] = i;
+    }
+    N->mbeg[ncount] = ncount;
+    for (i = 0; i < tcount; i++) {
+        N->par[tlist[i]] ^= 1;
+    }
+
+    *K = N;
+    return 0;
+}
+
+/* shrink_task builds the subproblem N in which each node v of K becomes */
+/* node W->grp[v] (one of 0, ..., ngrp - 1).  Edges inside a group are   */
+/* dropped and edges between the same two groups are merged.  The edges  */
+/* are bucketed by their smaller end, so the cost is linear.              */
+
+static int shrink_task (oddtask *K, oddwork *W, int ngrp, oddtask **N)
+{
+    oddtask *M;
+    int *grp = W->grp;
+    int i, e, a, b, v, k;
+    int rval = 0;
+
+    *N = (oddtask *) NULL;
+    M = CC_SAFE_MALLOC (1, oddtask);
+    if (!M) {
+        fprintf (stderr, "out of memory in shrink_task\n");
+        return 1;
+    }
+    M->ncount = ngrp;
+    M->ecount = 0;
+    M->elist  = CC_SAFE_MALLOC (2 * K->ecount + 1, int);
+    M->ecap   = CC_SAFE_MALLOC (K->ecount + 1, double);
+    M->par    = CC_SAFE_MALLOC (ngrp, int);
+    M->mbeg   = CC_SAFE_MALLOC (ngrp + 1, int);
+    M->mlist  = CC_SAFE_MALLOC (K->mbeg[K->ncount], int);
+    M->next   = (oddtask *) NULL;
+    if (!M->elist || !M->ecap || !M->par || !M->mbeg || !M->mlist) {
+        fprintf (stderr, "out of memory in shrink_task\n");
+        rval = 1; goto CLEANUP;
+    }
+
+    /* the members and the parity of each group */
+    for (k = 0; k <= ngrp; k++) M->mbeg[k] = 0;
+    for (k = 0; k < ngrp; k++) M->par[k] = 0;
+    for (v = 0; v < K->ncount; v++) {
+        M->mbeg[grp[v] + 1] += K->mbeg[v+1] - K->mbeg[v];
+        M->par[grp[v]] ^= K->par[v];
+    }
+    for (k = 0; k < ngrp; k++) {
+        M->mbeg[k+1] += M->mbeg[k];
+        W->where[k] = M->mbeg[k];
+    }
+    for (v = 0; v < K->ncount; v++) {
+        for (i = K->mbeg[v]; i < K->mbeg[v+1]; i++) {
+            M->mlist[W->where[grp[v]]++] = K->mlist[i];
+        }
+    }
+
+    /* bucket the edges by their smaller group */
+    for (k = 0; k <= ngrp; k++) W->ebeg[k] = 0;
+    for (e = 0; e < K->ecount; e++) {
+        a = grp[K->elist[2*e]];
+        b = grp[K->elist[2*e+1]];
+        if (a != b) W->ebeg[(a < b ? a : b) + 1]++;
+    }
+    for (k = 0; k < ngrp; k++) {
+        W->ebeg[k+1] += W->ebeg[k];
+        W->where[k] = W->ebeg[k];
+    }
+    for (e = 0; e < K->ecount; e++) {
+        a = grp[K->elist[2*e]];
+        b = grp[K->elist[2*e+1]];
+        if (a != b) W->eperm[W->where[a < b ? a : b]++] = e;
+    }
+
+    /* where[b] is the new edge from the current group a to b, if any */
+    for (k = 0; k < ngrp; k++) W->where[k] = -1;
+    for (a = 0; a < ngrp; a++) {
+        for (i = W->ebeg[a]; i < W->ebeg[a+1]; i++) {
+            e = W->eperm[i];
+            b = grp[K->elist[2*e]];
+            if (b == a) b = grp[K->elist[2*e+1]];
+            if (W->where[b] != -1 && M->elist[2*W->where[b]] == a) {
+                M->ecap[W->where[b]] += K->ecap[e];
+            } else {
+                W->where[b] = M->ecount;
+                M->elist[2*M->ecount]   = a;
+                M->elist[2*M->ecount+1] = b;
+                M->ecap[M->ecount]      = K->ecap[e];
+                M->ecount++;
+            }
+        }
+    }
+
+    *N = M;
+
+CLEANUP:
+
+    if (rval) free_task (M);
+    return rval;
+}
+
+static void free_task (oddtask *K)
+{
+    if (K) {
+        CC_IFFREE (K->elist, int);
+        CC_IFFREE (K->ecap, double);
+        CC_IFFREE (K->par, int);
+        CC_IFFREE (K->mbeg, int);
+        CC_IFFREE (K->mlist, int);
+        CC_FREE (K, oddtask);
+    }
+}
+
+static void init_oddwork (oddwork *W)
+{
+    W->grp   = (int *) NULL;
+    W->side  = (int *) NULL;
+    W->where = (int *) NULL;
+    W->ebeg  = (int *) NULL;
+    W->eperm = (int *) NULL;
+    W->cut   = (int *) NULL;
+    W->list  = (int *) NULL;
+}
+
+static int alloc_oddwork (oddwork *W, int ncount, int ecount)
+{
+    W->grp   = CC_SAFE_MALLOC (ncount, int);
+    W->side  = CC_SAFE_MALLOC (ncount, int);
+    W->where = CC_SAFE_MALLOC (ncount, int);
+    W->ebeg  = CC_SAFE_MALLOC (ncount + 1, int);
+    W->eperm = CC_SAFE_MALLOC (ecount + 1, int);
+    W->cut   = CC_SAFE_MALLOC (ncount, int);
+    W->list  = CC_SAFE_MALLOC (ncount, int);
+    if (!W->grp || !W->side || !W->where || !W->ebeg || !W->eperm ||
+        !W->cut || !W->list) {
+        fprintf (stderr, "out of memory in alloc_oddwork\n");
+        free_oddwork (W);
+        return 1;
+    }
+    return 0;
+}
+
+static void free_oddwork (oddwork *W)
+{
+    CC_IFFREE (W->grp, int);
+    CC_IFFREE (W->side, int);
+    CC_IFFREE (W->where, int);
+    CC_IFFREE (W->ebeg, int);
+    CC_IFFREE (W->eperm, int);
+    CC_IFFREE (W->cut, int);
+    CC_IFFREE (W->list, int);
+}
@@ -0,0 +1,292 @@
+/****************************************************************************/
+/*                                                                          */
+/*  This file is part of CONCORDE                                           */
+/*                                                                          */
+/*  (c) Copyright 1995--1999 by David Applegate, Robert Bixby,              */
+/*  Vasek Chvatal, and William Cook                                         */
+/*                                                                          */
+/*  Permission is granted for academic research use.  For other uses,       */
+/*  contact the authors for licensing options.                              */
+/*                                                                          */
+/*  Use at your own risk.  We make no guarantees about the                  */
+/*  correctness or usefulness of this code.                                 */
+/*                                                                          */
+/****************************************************************************/
+
+/****************************************************************************/
+/*                                                                          */
+/*                      READING AND WRITING X-VECTORS                       */
+/*                                                                          */
+/*                                                                          */
+/*    EXPORTED FUNCTIONS:                                                   */
+/*                                                                          */
+/*  void CCutil_init_xvector (CCutil_xvector *X)                            */
+/*    INITIALIZES an empty x-vector.                                        */
+/*                                                                          */
+/*  void CCutil_free_xvector (CCutil_xvector *X)                            */
+/*    FREES (or unmaps) the edges and values of X.                          */
+/*                                                                          */
+/*  int CCutil_read_xvector (const char *fname, CCutil_xvector *X)          */
+/*    READS an x-vector from a text or a binary file (the binary files      */
+/*     are recognized by their first four bytes).                           */
+/*     -X returns ncount, ecount, elist and x                               */
+/*    NOTES:                                                                */
+/*      A text file is "ncount ecount" followed by "u v x" for each edge,   */
+/*      as written by concorde.  A binary file is mapped into memory and    */
+/*      elist and x point into the mapping, so nothing is parsed or         */
+/*      copied; the pages are read as they are used.  The mapping is        */
+/*      private, so writing to elist or x does not change the file.  The    */
+/*      ends of the edges are checked in both formats.                      */
+/*                                                                          */
+/*  int CCutil_write_xvector_binary (const char *fname, int ncount,         */
+/*      int ecount, int *elist, double *x)                                  */
+/*    WRITES an x-vector in the binary format:                              */
+/*      "CCxv", the version (1), ncount and ecount as 4-byte ints,          */
+/*      then elist (2*ecount 4-byte ints), then x (ecount 8-byte doubles),  */
+/*      all in the byte order of the machine.  The header is 16 bytes, so   */
+/*      x starts on an 8-byte boundary.                                     */
+/*                                                                          */
+/****************************************************************************/
+
+#include "machdefs.h"
+#include "util.h"
+#include "macrorus.h"
+
+#define XVECTOR_VERSION 1
+#define XVECTOR_HEADER  16
+
+static const char xvector_magic[4] = {'C', 'C', 'x', 'v'};
+
+
+static int
+    read_text (const char *fname, FILE *in, CCutil_xvector *X),
+    read_binary (const char *fname, FILE *in, CCutil_xvector *X),
+    check_edges (const char *fname, CCutil_xvector *X);
+
+
+void CCutil_init_xvector (CCutil_xvector *X)
+{
+    X->ncount = 0;
+    X->ecount = 0;
+    X->elist  = (int *) NULL;
+    X->x      = (double *) NULL;
+    X->map    = (void *) NULL;
+    X->maplen = 0;
+}
+
+void CCutil_free_xvector (CCutil_xvector *X)
+{
+    if (X->map) {
+#ifdef HAVE_SYS_MMAN_H
+        munmap (X->map, X->maplen);
+#else
+        CC_FREE (X->map, char);
+#endif
+    } else {
+        CC_IFFREE (X->elist, int);
+        CC_IFFREE (X->x, double);
+    }
+    CCutil_init_xvector (X);
+}
+
+int CCutil_read_xvector (const char *fname, CCutil_xvector *X)
+{
+    FILE *in = (FILE *) NULL;
+    char magic[4];
+    int rval = 0;
+
+    CCutil_init_xvector (X);
+
+    in = fopen (fname, "rb");
+    if (in == (FILE *) NULL) {
+        perror (fname);
+        fprintf (stderr, "Unable to open %s for input\n", fname);
+        return 1;
+    }
+
+    if (fread (magic, 1, 4, in) == 4 &&
+        memcmp (magic, xvector_magic, 4) == 0) {
+        rval = read_binary (fname, in, X);
+    } else {
+        rewind (in);
+        rval = read_text (fname, in, X);
+    }
+    if (rval) goto CLEANUP;
+
+    rval = check_edges (fname, X);
+
+CLEANUP:
+
+    fclose (in);
+    if (rval) CCutil_free_xvector (X);
+    return rval;
+}
+
+int CCutil_write_xvector_binary (const char *fname, int ncount, int ecount,
+        int *elist, double *x)
+{
+    FILE *out = (FILE *) NULL;
+    int head[3];
+    int rval = 0;
+
+    out = fopen (fname, "wb");
+    if (out == (FILE *) NULL) {
+        perror (fname);
+        fprintf (stderr, "Unable to open %s for output\n", fname);
+        return 1;
+    }
+
+    head[0] = XVECTOR_VERSION;
+    head[1] = ncount;
+    head[2] = ecount;
+    if (fwrite (xvector_magic, 1, 4, out) != 4 ||
+        fwrite (head, sizeof (int), 3, out) != 3 ||
+        fwrite (elist, sizeof (int), (size_t) 2 * ecount, out) !=
+                (size_t) 2 * ecount ||
+        fwrite (x, sizeof (double), (size_t) ecount, out) != (size_t) ecount) {
+        perror (fname);
+        fprintf (stderr, "Write to %s failed\n", fname);
+        rval = 1;
+    }
+
+    if (fclose (out)) {
+        perror (fname);
+        fprintf (stderr, "Write to %s failed\n", fname);
+        rval = 1;
+    }
+    return rval;
+}
+
+/* read_text reads the whole file into one buffer and parses it with     */
+/* strtol and strtod, which is much faster than fscanf on large files.   */
+
+static int read_text (const char *fname, FILE *in, CCutil_xvector *X)
+{
+    char *buf = (char *) NULL;
+    char *p, *q;
+    long len;
+    int i, rval = 0;
+
+    if (fseek (in, 0L, SEEK_END) || (len = ftell (in)) < 0 ||
+        fseek (in, 0L, SEEK_SET)) {
+        perror (fname);
+        fprintf (stderr, "Unable to find the size of %s\n", fname);
+        rval = 1; goto CLEANUP;
+    }
+    buf = CC_SAFE_MALLOC (len + 1, char);
+    CCcheck_NULL (buf, "out of memory in read_text");
+    if (fread (buf, 1, (size_t) len, in) != (size_t) len) {
+        perror (fname);
+        fprintf (stderr, "Read of %s failed\n", fname);
+        rval = 1; goto CLEANUP;
+    }
+    buf[len] = '\0';
+
+    p = buf;
+    X->ncount = (int) strtol (p, &q, 10);
+    if (q == p) goto BAD;
+    p = q;
+    X->ecount = (int) strtol (p, &q, 10);
+    if (q == p || X->ncount < 1 || X->ecount < 1) goto BAD;
+    p = q;
+
+    X->elist = CC_SAFE_MALLOC (2 * X->ecount, int);
+    CCcheck_NULL (X->elist, "out of memory in read_text");
+    X->x = CC_SAFE_MALLOC (X->ecount, double);
+    CCcheck_NULL (X->x, "out of memory in read_text");
+
+    for (i = 0; i < X->ecount; i++) {
+        X->elist[2*i] = (int) strtol (p, &q, 10);
+        if (q == p) goto BAD;
+        p = q;
+        X->elist[2*i+1] = (int) strtol (p, &q, 10);
+        if (q == p) goto BAD;
+        p = q;
+        X->x[i] = strtod (p, &q);
+        if (q == p) goto BAD;
+        p = q;
+    }
+    goto CLEANUP;
+
+BAD:
+
+    fprintf (stderr, "%s is not an x-vector file\n", fname);
+    rval = 1;
+
+CLEANUP:
+
+    CC_IFFREE (buf, char);
+    return rval;
+}
+
+/* read_binary maps the file (or, without mmap, reads it into one        */
+/* buffer) and points elist and x into it.                               */
+
+static int read_binary (const char *fname, FILE *in, CCutil_xvector *X)
+{
+    int head[3];
+    size_t len;
+    char *base;
+
+    if (fread (head, sizeof (int), 3, in) != 3) goto BAD;
+    if (head[0] != XVECTOR_VERSION) {
+        fprintf (stderr, "%s has version %d (or the other byte order)\n",
+                 fname, head[0]);
+        return 1;
+    }
+    if (head[1] < 1 || head[2] < 1) goto BAD;
+
+    len = XVECTOR_HEADER + (size_t) head[2] * (2 * sizeof (int) +
+                                               sizeof (double));
+    if (fseek (in, 0L, SEEK_END) || ftell (in) != (long) len) goto BAD;
+
+#ifdef HAVE_SYS_MMAN_H
+    base = (char *) mmap ((void *) NULL, len, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE, fileno (in), (off_t) 0);
+    if (base == (char *) MAP_FAILED) {
+        perror (fname);
+        fprintf (stderr, "mmap of %s failed\n", fname);
+        return 1;
+    }
+#else
+    base = CC_SAFE_MALLOC (len, char);
+    if (base == (char *) NULL) {
+        fprintf (stderr, "out of memory in read_binary\n");
+        return 1;
+    }
+    if (fseek (in, 0L, SEEK_SET) || fread (base, 1, len, in) != len) {
+        perror (fname);
+        fprintf (stderr, "Read of %s failed\n", fname);
+        CC_FREE (base, char);
+        return 1;
+    }
+#endif
+
+    X->map = (void *) base;
+    X->maplen = len;
+    X->ncount = head[1];
+    X->ecount = head[2];
+    X->elist = (int *) (base + XVECTOR_HEADER);
+    X->x = (double *) (base + XVECTOR_HEADER +
+                       (size_t) head[2] * 2 * sizeof (int));
+    return 0;
+
+BAD:
+
+    fprintf (stderr, "%s is not a binary x-vector file\n", fname);
+    return 1;
+}
+
+static int check_edges (const char *fname, CCutil_xvector *X)
+{
+    int i;
+
+    for (i = 0; i < 2 * X->ecount; i++) {
+        if (X->elist[i] < 0 || X->elist[i] >= X->ncount) {
+            fprintf (stderr, "%s: edge %d has an end %d out of range\n",
+                     fname, i / 2, X->elist[i]);
+            return 1;
+        }
+    }
+    return 0;
+}